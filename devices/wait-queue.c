@@ -9,14 +9,11 @@
 #include <assert.h>
 #include <string.h>
 #include <stdlib.h>
-#include <alloca.h>
 
 #include <sys/syslog.h>
 
 #include <devices/wait-queue.h>
 
-#define WAIT_QUEUE_WAKE 0x08000000
-
 void wait_queue_ini(struct wait_queue *queue)
 {
 	assert(queue != 0);
@@ -24,8 +21,9 @@ void wait_queue_ini(struct wait_queue *queue)
 	/* Clear the queue memory */
 	memset(queue, 0, sizeof(struct wait_queue));
 
-	/* Initialize the priority sorted list of waiters */
-	list_init(&queue->waiters);
+	/* The futex waiters are kept in priority order by the scheduler */
+	scheduler_futex_init(&queue->futex, &queue->sequence, 0);
+	osPollHeadInit(&queue->pollers);
 }
 
 void wait_queue_fini(struct wait_queue *queue)
@@ -68,10 +66,24 @@ void wait_queue_destroy(struct wait_queue *queue)
 	free(queue);
 }
 
+long wait_prepare(struct wait_queue *queue)
+{
+	assert(queue != 0);
+
+	/* Must be taken before the wait condition is checked, any later notify changes it */
+	return atomic_load(&queue->sequence);
+}
+
 int wait_enqueue(struct wait_queue *queue, unsigned int msec)
 {
-	struct wait_queue_entry entry;
+	assert(queue != 0);
+
+	/* Forward, only notifies after this are seen */
+	return wait_enqueue_sequence(queue, wait_prepare(queue), msec);
+}
 
+int wait_enqueue_sequence(struct wait_queue *queue, long sequence, unsigned int msec)
+{
 	assert(queue != 0);
 
 	/* Check for interruptions */
@@ -80,34 +92,21 @@ int wait_enqueue(struct wait_queue *queue, unsigned int msec)
 		return -EINTR;
 	}
 
-	/* Initialize the wait queue entry */
-	entry.task_id = osThreadGetId();
-	if (!entry.task_id) {
+	/* Only threads can wait */
+	if (!osThreadGetId()) {
 		errno = EINVAL;
 		return -EINVAL;
 	}
-	entry.task_priority = osThreadGetPriority(entry.task_id);
-	entry.timestamp = osKernelGetTickCount();
-	list_init(&entry.node);
 
-	/* Carefully add to the waiters list  */
-	unsigned int state = spin_lock_irqsave(&queue->lock);
-	list_push(&queue->waiters, &entry.node);
+	/* Any notify since the snapshot changed the sequence and stops us from blocking, counting only gets us a kernel wake */
 	++queue->count;
-	spin_unlock_irqrestore(&queue->lock, state);
-
-	/* Suspend ourselves, error are fatal */
-	uint32_t flags = osThreadFlagsWait(WAIT_QUEUE_WAKE, osFlagsWaitAny, msec);
-	if ((flags & (osFlagsErrorTimeout | osFlagsErrorResource)) == 0)
-		syslog_fatal("failed to suspend task: %d\n", (osStatus_t)flags);
-
-	/* Carefully remove from the waiter list if a timeout */
-	state = spin_lock_irqsave(&queue->lock);
-	if ((flags & (osFlagsErrorTimeout | osFlagsErrorResource)) != 0) {
-		list_remove(&entry.node);
-		--queue->count;
-	}
-	spin_unlock_irqrestore(&queue->lock, state);
+	unsigned int timestamp = osKernelGetTickCount();
+
+	/* Suspend ourselves, errors other than a timeout are fatal */
+	int status = msec > 0 ? scheduler_futex_wait(&queue->futex, sequence, msec) : -ETIMEDOUT;
+	--queue->count;
+	if (status < 0 && status != -ETIMEDOUT)
+		syslog_fatal("failed to suspend task: %d\n", status);
 
 	/* Check for interruptions */
 	if (atomic_load(&queue->interrupted)) {
@@ -116,60 +115,30 @@ int wait_enqueue(struct wait_queue *queue, unsigned int msec)
 	}
 
 	/* All done */
-	return osKernelGetTickCount() - entry.timestamp;
+	return osKernelGetTickCount() - timestamp;
 }
 
 int wait_notify(struct wait_queue *queue, bool all)
 {
 	assert(queue != 0);
 
-	osThreadId_t *wakers = 0;
-	size_t num_wakers = 0;
-
-	/* Lock the queue */
-	unsigned int state = spin_lock_irqsave(&queue->lock);
-
-	/* Only do wake is there are waiters */
-	if (!list_is_empty(&queue->waiters)) {
-
-		/* Build the wake list */
-		if (all) {
-
-			/* Add all waiters the vector of wakers */
-			wakers = alloca(atomic_load(&queue->count) * sizeof(osThreadId_t));
-			struct wait_queue_entry *current;
-			list_for_each_entry(current, &queue->waiters, node)
-				wakers[num_wakers++] = current->task_id;
-
-		} else {
-
-			/* Find the highest priority waiter to wake, because the list is not empty and the list is locked there must be a least one */
-			/* TODO osThreadGetPriority can not be call in interrupt context. This will not find the highest priority thread if its priority is changed while blocked on the wait queue */
-			wakers = alloca(sizeof(osThreadId_t));
-			num_wakers = 1;
-			osPriority_t highest_priority = osPriorityNone;
-			struct wait_queue_entry *current;
-			list_for_each_entry(current, &queue->waiters, node) {
-				if (current->task_priority > highest_priority){
-					highest_priority = current->task_priority;
-					wakers[0] = current->task_id;
-				}
-			}
-		}
-	}
+	/* Stop any waiter on the way in from blocking */
+	atomic_fetch_add(&queue->sequence, 1);
 
-	/* Unlock the wait queue */
-	spin_unlock_irqrestore(&queue->lock, state);
+	/* Edge trigger any osWaitMultiple callers */
+	osPollSignal(&queue->pollers);
 
-	/* Got everything in the wake list, resume them */
-	for (size_t i = 0; i < num_wakers; ++i) {
-		uint32_t flags = osThreadFlagsSet(wakers[i], WAIT_QUEUE_WAKE);
-		if (flags & osFlagsError)
-			syslog_fatal("failed to wake block task %p: %d\n", wakers[i], (osStatus_t)flags);
-	}
+	/* Nothing more to do without waiters */
+	if (atomic_load(&queue->count) == 0)
+		return 0;
+
+	/* A single kernel entry wakes the highest priority waiter or all of them, deferred when in an interrupt */
+	int woken = scheduler_futex_wake(&queue->futex, all);
+	if (woken < 0)
+		syslog_fatal("failed to wake blocked tasks: %d\n", woken);
 
 	/* Now we are done */
-	return num_wakers;
+	return woken;
 }
 
 void wait_reset(struct wait_queue *queue)
@@ -40,6 +40,13 @@ static __fast_section void periodic_alarm(IRQn_Type irq, void *context)
 {
 	struct periodic_channel *channel = context;
 
+	/* One shot alarms only wake the core, disable and clear */
+	if (channel->period == 0) {
+		clear_bit(&TIMER->INTE, irq - TIMER_IRQ_0_IRQn);
+		clear_bit(&TIMER->INTR, irq - TIMER_IRQ_0_IRQn);
+		return;
+	}
+
 	/* Update the alarm, hopefully we did not miss it */
 	channel->next = channel->next + channel->period;
 	*channel->alarm = channel->next;
@@ -88,7 +95,7 @@ int periodic_register(unsigned int channel, unsigned int swi, unsigned int frequ
 {
 	assert(channel < TIMER_NUM_CHANNELS || frequency > TIMER_FREQ_HZ);
 
-	/* Make the channel is not running */
+	/* Make sure the channel is not running */
 	if (TIMER->INTE & (1UL << channel))
 		return -EBUSY;
 
@@ -104,7 +111,7 @@ int periodic_unregister(unsigned int channel)
 {
 	assert(channel < TIMER_NUM_CHANNELS);
 
-	/* Make the channel is not running */
+	/* Make sure the channel is not running */
 	if (TIMER->INTE & (1UL << channel))
 		return -EBUSY;
 
@@ -120,7 +127,7 @@ int periodic_enable(unsigned int channel)
 {
 	assert(channel < TIMER_NUM_CHANNELS);
 
-	/* Make the channel is not running */
+	/* Make sure the channel is not running */
 	if (TIMER->INTE & (1UL << channel))
 		return -EBUSY;
 
@@ -142,6 +149,31 @@ int periodic_disable(unsigned int channel)
 	/* Enable the interrupt */
 	clear_bit(&TIMER->INTE, channel);
 
+	/* And disarm any pending alarm */
+	TIMER->ARMED = 1UL << channel;
+
+	return 0;
+}
+
+int periodic_oneshot(unsigned int channel, unsigned long target)
+{
+	assert(channel < TIMER_NUM_CHANNELS);
+
+	/* Make sure the channel is not running */
+	if (TIMER->INTE & (1UL << channel))
+		return -EBUSY;
+
+	/* A zero period marks the channel as one shot */
+	channels[channel].period = 0;
+	channels[channel].next = target;
+
+	/* Setup the alarm, it fires when the low 32 bits of the timer match */
+	clear_bit(&TIMER->INTR, channel);
+	*channels[channel].alarm = target;
+
+	/* Enable the interrupt */
+	set_bit(&TIMER->INTE, channel);
+
 	return 0;
 }
 
@@ -0,0 +1,418 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * syslog-decode.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ *
+ * Format the deferred binary syslog records (include/sys/syslog.h) still pending in the
+ * rings found in a raw target memory dump. The format strings and function names come
+ * from the ELF image the target was running.
+ *
+ * Usage: syslog-decode <elf image> <memory dump>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <elf.h>
+
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+/* Must match include/sys/syslog.h */
+#define SYSLOG_BINARY_MAGIC 0x534c4f47UL
+#define SYSLOG_RING_HEADER_SIZE 24
+#define SYSLOG_RECORD_HEADER_WORDS 4
+#define SYSLOG_MAX_CORES 2
+#define SYSLOG_MAX_WORDS 65536
+#define SYSLOG_MAX_RECORD_WORDS 256
+
+#define SYSLOG_RECORD_WORDS(header) ((header) >> 16)
+#define SYSLOG_RECORD_LEVEL(header) ((header) & 0xff)
+
+/* Must match sys/syslog.c */
+enum syslog_arg
+{
+	SYSLOG_ARG_NONE,
+	SYSLOG_ARG_WORD,
+	SYSLOG_ARG_DWORD,
+	SYSLOG_ARG_DOUBLE,
+	SYSLOG_ARG_POINTER,
+	SYSLOG_ARG_STRING,
+};
+
+struct syslog_spec
+{
+	enum syslog_arg arg;
+	unsigned int stars;
+	char text[16];
+};
+
+struct mapping
+{
+	uint8_t *data;
+	size_t size;
+};
+
+static const char *syslog_level_str[] = { "NONE", "FATAL", "ERROR", "WARN ", "INFO ", "DEBUG", "TRACE" };
+
+static uint32_t read_u32(const uint8_t *data)
+{
+	/* Target is little endian */
+	return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static int map_file(const char *path, struct mapping *mapping)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "could not open `%s`: %s\n", path, strerror(errno));
+		return -errno;
+	}
+
+	struct stat stat;
+	if (fstat(fd, &stat) < 0 || stat.st_size == 0) {
+		fprintf(stderr, "failed to get a usable size for `%s`\n", path);
+		close(fd);
+		return -EINVAL;
+	}
+
+	mapping->data = mmap(0, stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping->data == MAP_FAILED) {
+		fprintf(stderr, "failed mmap `%s`: %s\n", path, strerror(errno));
+		return -errno;
+	}
+	mapping->size = stat.st_size;
+
+	return 0;
+}
+
+static const Elf32_Shdr *elf_sections(const struct mapping *elf, unsigned int *count)
+{
+	const Elf32_Ehdr *ehdr = (const Elf32_Ehdr *)elf->data;
+
+	/* Only 32 bit little endian ARM images */
+	if (elf->size < sizeof(Elf32_Ehdr) || memcmp(ehdr->e_ident, ELFMAG, SELFMAG) != 0 || ehdr->e_ident[EI_CLASS] != ELFCLASS32 || ehdr->e_ident[EI_DATA] != ELFDATA2LSB || ehdr->e_machine != EM_ARM)
+		return 0;
+	if (ehdr->e_shoff + (size_t)ehdr->e_shnum * sizeof(Elf32_Shdr) > elf->size)
+		return 0;
+
+	*count = ehdr->e_shnum;
+	return (const Elf32_Shdr *)(elf->data + ehdr->e_shoff);
+}
+
+static const char *elf_string(const struct mapping *elf, uint32_t addr)
+{
+	unsigned int count;
+	const Elf32_Shdr *shdr = elf_sections(elf, &count);
+
+	/* Find the loaded section holding the address, the string must be terminated inside it */
+	for (unsigned int i = 0; shdr && i < count; ++i) {
+		if (shdr[i].sh_type != SHT_PROGBITS || (shdr[i].sh_flags & SHF_ALLOC) == 0)
+			continue;
+		if (addr < shdr[i].sh_addr || addr >= shdr[i].sh_addr + shdr[i].sh_size || shdr[i].sh_offset + shdr[i].sh_size > elf->size)
+			continue;
+		const char *str = (const char *)elf->data + shdr[i].sh_offset + (addr - shdr[i].sh_addr);
+		if (memchr(str, 0, shdr[i].sh_addr + shdr[i].sh_size - addr) == 0)
+			return 0;
+		return str;
+	}
+
+	return 0;
+}
+
+static const char *elf_function(const struct mapping *elf, uint32_t pc)
+{
+	unsigned int count;
+	const Elf32_Shdr *shdr = elf_sections(elf, &count);
+
+	/* The pc is a return address so the thumb bit may be set */
+	pc &= ~1UL;
+
+	for (unsigned int i = 0; shdr && i < count; ++i) {
+		if (shdr[i].sh_type != SHT_SYMTAB || shdr[i].sh_link >= count)
+			continue;
+		const Elf32_Shdr *strtab = &shdr[shdr[i].sh_link];
+		if (shdr[i].sh_offset + shdr[i].sh_size > elf->size || strtab->sh_offset + strtab->sh_size > elf->size)
+			continue;
+		const Elf32_Sym *sym = (const Elf32_Sym *)(elf->data + shdr[i].sh_offset);
+		for (size_t j = 0; j < shdr[i].sh_size / sizeof(Elf32_Sym); ++j) {
+			uint32_t start = sym[j].st_value & ~1UL;
+			if (ELF32_ST_TYPE(sym[j].st_info) == STT_FUNC && pc >= start && pc < start + sym[j].st_size && sym[j].st_name < strtab->sh_size)
+				return (const char *)elf->data + strtab->sh_offset + sym[j].st_name;
+		}
+	}
+
+	return "unknown";
+}
+
+/* Parse the conversion following a '%', returns the character after it or 0 when it is not supported */
+static const char *parse_spec(const char *fmt, struct syslog_spec *spec)
+{
+	unsigned int len = 0;
+	bool dword = false;
+
+	spec->text[len++] = '%';
+	spec->stars = 0;
+
+	while (*fmt != 0 && strchr("-+ #0123456789.*", *fmt) != 0) {
+		if (len >= sizeof(spec->text) - 4)
+			return 0;
+		if (*fmt == '*')
+			++spec->stars;
+		spec->text[len++] = *fmt++;
+	}
+
+	while (*fmt != 0 && strchr("hlLqjzt", *fmt) != 0) {
+		if (*fmt == 'h' && len < sizeof(spec->text) - 4)
+			spec->text[len++] = 'h';
+		else if ((*fmt == 'l' && fmt[1] == 'l') || *fmt == 'q' || *fmt == 'j')
+			dword = true;
+		fmt += *fmt == 'l' && fmt[1] == 'l' ? 2 : 1;
+	}
+	if (dword) {
+		spec->text[len++] = 'l';
+		spec->text[len++] = 'l';
+	}
+
+	switch (*fmt) {
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+		case 'c':
+			spec->arg = dword ? SYSLOG_ARG_DWORD : SYSLOG_ARG_WORD;
+			break;
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			spec->arg = SYSLOG_ARG_DOUBLE;
+			break;
+		case 'p':
+			spec->arg = SYSLOG_ARG_POINTER;
+			break;
+		case 's':
+			spec->arg = SYSLOG_ARG_STRING;
+			break;
+		case '%':
+			spec->arg = SYSLOG_ARG_NONE;
+			break;
+		default:
+			return 0;
+	}
+	spec->text[len++] = *fmt++;
+	spec->text[len] = 0;
+
+	return fmt;
+}
+
+/* Expand the star arguments into the conversion text, false if the payload ran out */
+static bool expand_spec(const struct syslog_spec *spec, char *text, size_t size, const uint32_t *payload, unsigned int *index, unsigned int count)
+{
+	size_t len = 0;
+
+	for (const char *c = spec->text; *c != 0 && len < size - 1; ++c) {
+		if (*c != '*') {
+			text[len++] = *c;
+			continue;
+		}
+		if (*index == count)
+			return false;
+		int written = snprintf(text + len, size - len, "%d", (int32_t)payload[(*index)++]);
+		if (written < 0 || (size_t)written >= size - len)
+			return false;
+		len += written;
+	}
+	text[len] = 0;
+
+	return true;
+}
+
+static void format_record(const struct mapping *elf, uint32_t core, const uint32_t *record, unsigned int count)
+{
+	const uint32_t *payload = record + SYSLOG_RECORD_HEADER_WORDS;
+	unsigned int level = SYSLOG_RECORD_LEVEL(record[0]);
+	unsigned int index = 0;
+	struct syslog_spec spec;
+	char text[32];
+
+	/* Format strings come from the image, not the dump */
+	const char *fmt = elf_string(elf, record[1]);
+	if (!fmt || level > 6) {
+		printf("core %u %10u: bad record, format 0x%08x from 0x%08x\n", core, record[3], record[1], record[2]);
+		return;
+	}
+
+	printf("core %u %10u: ", core, record[3]);
+	if (level != 0)
+		printf("%s %s - ", syslog_level_str[level], elf_function(elf, record[2]));
+
+	while (*fmt != 0) {
+
+		/* Literal text up to the next conversion */
+		const char *next = strchr(fmt, '%');
+		fwrite(fmt, 1, next ? (size_t)(next - fmt) : strlen(fmt), stdout);
+		if (!next)
+			return;
+
+		/* Unsupported conversions are shown as is */
+		fmt = parse_spec(next + 1, &spec);
+		if (!fmt) {
+			fputs(next, stdout);
+			return;
+		}
+
+		if (!expand_spec(&spec, text, sizeof(text), payload, &index, count))
+			goto truncated;
+
+		switch (spec.arg) {
+			case SYSLOG_ARG_NONE:
+				fputc('%', stdout);
+				break;
+			case SYSLOG_ARG_WORD:
+				if (index == count)
+					goto truncated;
+				printf(text, payload[index++]);
+				break;
+			case SYSLOG_ARG_POINTER:
+				if (index == count)
+					goto truncated;
+				printf("0x%08x", payload[index++]);
+				break;
+			case SYSLOG_ARG_DWORD: {
+				unsigned long long value;
+				if (index + 2 > count)
+					goto truncated;
+				value = (unsigned long long)payload[index] | ((unsigned long long)payload[index + 1] << 32);
+				printf(text, value);
+				index += 2;
+				break;
+			}
+			case SYSLOG_ARG_DOUBLE: {
+				double value;
+				uint64_t bits;
+				if (index + 2 > count)
+					goto truncated;
+				bits = (uint64_t)payload[index] | ((uint64_t)payload[index + 1] << 32);
+				memcpy(&value, &bits, sizeof(value));
+				printf(text, value);
+				index += 2;
+				break;
+			}
+			case SYSLOG_ARG_STRING: {
+				if (index == count)
+					goto truncated;
+				const char *str = (const char *)&payload[index];
+				size_t len = strnlen(str, (count - index) * sizeof(uint32_t));
+				if (len == (count - index) * sizeof(uint32_t))
+					goto truncated;
+				printf(text, str);
+				index += len / sizeof(uint32_t) + 1;
+				break;
+			}
+		}
+	}
+
+	return;
+
+truncated:
+	printf("...\n");
+}
+
+static int decode_ring(const struct mapping *elf, const uint8_t *buffer, size_t available)
+{
+	uint32_t record[SYSLOG_MAX_RECORD_WORDS];
+	uint32_t core = read_u32(buffer + 4);
+	uint32_t size = read_u32(buffer + 8);
+	uint32_t head = read_u32(buffer + 12);
+	uint32_t tail = read_u32(buffer + 16);
+	uint32_t dropped = read_u32(buffer + 20);
+
+	/* Sanity check the header, the magic could be a coincidence */
+	if (core >= SYSLOG_MAX_CORES || size == 0 || size > SYSLOG_MAX_WORDS || (size & (size - 1)) != 0 || head - tail > size)
+		return -EINVAL;
+	if (available < SYSLOG_RING_HEADER_SIZE + (size_t)size * sizeof(uint32_t))
+		return -EINVAL;
+
+	const uint8_t *data = buffer + SYSLOG_RING_HEADER_SIZE;
+	fprintf(stderr, "core %u: %u words pending, %u records dropped\n", core, head - tail, dropped);
+
+	/* Only the records the logger did not get to are intact */
+	while (tail != head) {
+		uint32_t words = SYSLOG_RECORD_WORDS(read_u32(data + (tail & (size - 1)) * sizeof(uint32_t)));
+		if (words < SYSLOG_RECORD_HEADER_WORDS || words > SYSLOG_MAX_RECORD_WORDS || words > head - tail) {
+			fprintf(stderr, "core %u: corrupt record at %u\n", core, tail);
+			break;
+		}
+		for (uint32_t i = 0; i < words; ++i)
+			record[i] = read_u32(data + ((tail + i) & (size - 1)) * sizeof(uint32_t));
+		format_record(elf, core, record, words - SYSLOG_RECORD_HEADER_WORDS);
+		tail += words;
+	}
+
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int exit_status = EXIT_FAILURE;
+	struct mapping elf;
+	struct mapping dump;
+
+	if (argc < 3) {
+		fprintf(stderr, "usage: %s <elf image> <memory dump>\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	/* Map both files into our address space */
+	if (map_file(argv[1], &elf) < 0)
+		return EXIT_FAILURE;
+	unsigned int count;
+	if (!elf_sections(&elf, &count)) {
+		fprintf(stderr, "`%s` is not a 32 bit little endian ARM ELF image\n", argv[1]);
+		goto error_unmap_elf;
+	}
+	if (map_file(argv[2], &dump) < 0)
+		goto error_unmap_elf;
+
+	/* Scan the dump for syslog rings, they are word aligned */
+	unsigned int found = 0;
+	for (size_t offset = 0; offset + SYSLOG_RING_HEADER_SIZE <= dump.size; offset += 4) {
+		if (read_u32(dump.data + offset) == SYSLOG_BINARY_MAGIC && decode_ring(&elf, dump.data + offset, dump.size - offset) == 0)
+			++found;
+	}
+
+	/* Let the user known if nothing was there */
+	if (found == 0)
+		fprintf(stderr, "no syslog rings found in `%s`, was it built with SYSLOG_BINARY=1?\n", argv[2]);
+	else
+		exit_status = EXIT_SUCCESS;
+
+	munmap(dump.data, dump.size);
+
+error_unmap_elf:
+	munmap(elf.data, elf.size);
+
+	return exit_status;
+}
@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * trace-decode.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ *
+ * Decode the scheduler trace rings (include/sys/trace.h) found in a raw target memory
+ * dump into Chrome trace event JSON, which can be loaded by chrome://tracing or Perfetto.
+ *
+ * Usage: trace-decode <memory dump> [<output json>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+/* Must match include/sys/trace.h */
+#define TRACE_MAGIC 0x54524143UL
+#define TRACE_HEADER_SIZE 16
+#define TRACE_RECORD_SIZE 12
+#define TRACE_MAX_CORES 2
+#define TRACE_MAX_ENTRIES 65536
+
+enum trace_event_type
+{
+	TRACE_SWITCH_IN = 1,
+	TRACE_SWITCH_OUT = 2,
+	TRACE_FUTEX_WAIT = 3,
+	TRACE_FUTEX_WAKE = 4,
+	TRACE_DEFERRED_WAKE = 5,
+	TRACE_IRQ_ENTER = 6,
+	TRACE_IRQ_EXIT = 7,
+	TRACE_TIMER_EXPIRED = 8,
+	TRACE_IDLE = 9,
+};
+
+struct trace_state
+{
+	FILE *out;
+	bool first;
+	unsigned int depth;
+	bool idle;
+	bool running;
+};
+
+static uint32_t read_u32(const uint8_t *data)
+{
+	/* Target is little endian */
+	return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static void emit(struct trace_state *state, const char *name, const char *phase, uint64_t ts, uint32_t core, const char *args)
+{
+	fprintf(state->out, "%s\n\t\t{ \"name\": \"%s\", \"ph\": \"%s\", \"ts\": %llu, \"pid\": 0, \"tid\": %u%s%s%s }",
+		state->first ? "" : ",", name, phase, (unsigned long long)ts, core,
+		phase[0] == 'i' ? ", \"s\": \"t\"" : "", args ? ", \"args\": " : "", args ? args : "");
+	state->first = false;
+}
+
+static void begin(struct trace_state *state, const char *name, uint64_t ts, uint32_t core)
+{
+	emit(state, name, "B", ts, core, 0);
+	++state->depth;
+}
+
+static void end(struct trace_state *state, const char *name, uint64_t ts, uint32_t core)
+{
+	/* Drop ends whose begin was overwritten by the ring */
+	if (state->depth == 0)
+		return;
+	emit(state, name, "E", ts, core, 0);
+	--state->depth;
+}
+
+static void decode_record(struct trace_state *state, uint32_t core, uint64_t ts, uint8_t event, uint8_t arg, uint32_t data)
+{
+	char name[64];
+	char args[64];
+
+	switch (event) {
+
+		case TRACE_SWITCH_IN:
+			if (state->idle) {
+				end(state, "idle", ts, core);
+				state->idle = false;
+			}
+			snprintf(name, sizeof(name), "task 0x%08x", data);
+			begin(state, name, ts, core);
+			state->running = true;
+			break;
+
+		case TRACE_SWITCH_OUT:
+			if (state->running) {
+				snprintf(name, sizeof(name), "task 0x%08x", data);
+				end(state, name, ts, core);
+				state->running = false;
+			}
+			break;
+
+		case TRACE_IDLE:
+			if (!state->idle) {
+				begin(state, "idle", ts, core);
+				state->idle = true;
+			}
+			break;
+
+		case TRACE_IRQ_ENTER:
+			snprintf(name, sizeof(name), "irq %u", arg);
+			begin(state, name, ts, core);
+			break;
+
+		case TRACE_IRQ_EXIT:
+			snprintf(name, sizeof(name), "irq %u", arg);
+			end(state, name, ts, core);
+			break;
+
+		case TRACE_FUTEX_WAIT:
+			snprintf(args, sizeof(args), "{ \"futex\": \"0x%08x\" }", data);
+			emit(state, "futex wait", "i", ts, core, args);
+			break;
+
+		case TRACE_FUTEX_WAKE:
+			snprintf(args, sizeof(args), "{ \"futex\": \"0x%08x\", \"woken\": %u }", data, arg);
+			emit(state, "futex wake", "i", ts, core, args);
+			break;
+
+		case TRACE_DEFERRED_WAKE:
+			snprintf(args, sizeof(args), "{ \"futex\": \"0x%08x\", \"all\": %u }", data, arg);
+			emit(state, "deferred wake", "i", ts, core, args);
+			break;
+
+		case TRACE_TIMER_EXPIRED:
+			snprintf(args, sizeof(args), "{ \"task\": \"0x%08x\" }", data);
+			emit(state, "timer expired", "i", ts, core, args);
+			break;
+
+		default:
+			fprintf(stderr, "core %u: unknown event %u at %llu\n", core, event, (unsigned long long)ts);
+			break;
+	}
+}
+
+static int decode_buffer(struct trace_state *state, const uint8_t *buffer, size_t available)
+{
+	uint32_t core = read_u32(buffer + 4);
+	uint32_t size = read_u32(buffer + 8);
+	uint32_t head = read_u32(buffer + 12);
+
+	/* Sanity check the header, the magic could be a coincidence */
+	if (core >= TRACE_MAX_CORES || size == 0 || size > TRACE_MAX_ENTRIES || (size & (size - 1)) != 0)
+		return -EINVAL;
+	if (available < TRACE_HEADER_SIZE + (size_t)size * TRACE_RECORD_SIZE)
+		return -EINVAL;
+
+	/* Oldest record first, the ring may not have wrapped yet */
+	uint32_t count = head < size ? head : size;
+	uint32_t first = head - count;
+	fprintf(stderr, "core %u: %u of %u records, %u dropped\n", core, count, head, head - count);
+
+	/* Per core track, unwrap the 32 bit microsecond timestamps */
+	state->depth = 0;
+	state->idle = false;
+	state->running = false;
+	uint64_t epoch = 0;
+	uint32_t last = 0;
+	for (uint32_t i = 0; i < count; ++i) {
+		const uint8_t *record = buffer + TRACE_HEADER_SIZE + ((first + i) & (size - 1)) * TRACE_RECORD_SIZE;
+		uint32_t timestamp = read_u32(record);
+		if (i > 0 && timestamp < last)
+			epoch += 0x100000000ULL;
+		last = timestamp;
+		decode_record(state, core, epoch + timestamp, record[8], record[9], read_u32(record + 4));
+	}
+
+	/* Name the track */
+	char args[32];
+	snprintf(args, sizeof(args), "{ \"name\": \"core %u\" }", core);
+	emit(state, "thread_name", "M", 0, core, args);
+
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int exit_status = EXIT_FAILURE;
+
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s <memory dump> [<output json>]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	/* Open the dump */
+	int fd = open(argv[1], O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "could not open `%s`: %s\n", argv[1], strerror(errno));
+		return EXIT_FAILURE;
+	}
+
+	/* Get the length of the dump */
+	struct stat stat;
+	if (fstat(fd, &stat) < 0 || stat.st_size < TRACE_HEADER_SIZE) {
+		fprintf(stderr, "failed to get a usable size for `%s`\n", argv[1]);
+		goto error_close;
+	}
+
+	/* Map into our address space */
+	uint8_t *dump = mmap(0, stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (dump == MAP_FAILED) {
+		fprintf(stderr, "failed mmap `%s`: %s\n", argv[1], strerror(errno));
+		goto error_close;
+	}
+
+	/* Open the output */
+	struct trace_state state = { .out = stdout, .first = true };
+	if (argc > 2) {
+		state.out = fopen(argv[2], "w");
+		if (!state.out) {
+			fprintf(stderr, "could not open `%s`: %s\n", argv[2], strerror(errno));
+			goto error_unmap;
+		}
+	}
+
+	/* Scan the dump for trace buffers, they are word aligned */
+	unsigned int found = 0;
+	fprintf(state.out, "{\n\t\"displayTimeUnit\": \"ns\",\n\t\"traceEvents\": [");
+	for (size_t offset = 0; offset + TRACE_HEADER_SIZE <= (size_t)stat.st_size; offset += 4) {
+		if (read_u32(dump + offset) == TRACE_MAGIC && decode_buffer(&state, dump + offset, stat.st_size - offset) == 0)
+			++found;
+	}
+	fprintf(state.out, "\n\t]\n}\n");
+
+	/* Let the user known if nothing was there */
+	if (found == 0)
+		fprintf(stderr, "no trace buffers found in `%s`, was it built with SYS_TRACE=1?\n", argv[1]);
+	else
+		exit_status = EXIT_SUCCESS;
+
+	if (state.out != stdout)
+		fclose(state.out);
+
+error_unmap:
+	munmap(dump, stat.st_size);
+
+error_close:
+	close(fd);
+
+	return exit_status;
+}
@@ -17,6 +17,8 @@
 #define SYSTEM_INIT_PRIORITY 000
 #define RUNTIME_SYSTEM_INIT_PRIORITY 005
 #define FAULT_SYSTEM_INIT_PRIORITY 010
+#define TRACE_SYSTEM_INIT_PRIORITY 015
+#define SYSLOG_SYSTEM_INIT_PRIORITY 016
 #define IRQ_SYSTEM_INIT_PRIORIY 020
 #define SWI_SYSTEM_INIT_PRIORIY 021
 
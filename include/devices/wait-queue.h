@@ -11,25 +11,16 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stdatomic.h>
-#include <linked-list.h>
-#include <sys/spinlock.h>
 
 #include <rtos/rtos.h>
 
-struct wait_queue_entry
-{
-	osThreadId_t task_id;
-	osPriority_t task_priority;
-	unsigned int timestamp;
-	struct linked_list node;
-};
-
 struct wait_queue
 {
-	struct linked_list waiters;
+	struct futex futex;
+	long sequence;
 	atomic_uint count;
 	atomic_bool interrupted;
-	spinlock_t lock;
+	struct rtos_poll_head pollers;
 };
 
 #define wait_event(wq, condition) \
@@ -37,11 +28,12 @@ struct wait_queue
 	__label__ out; \
 	int status = 0; \
 	do { \
+		long sequence = wait_prepare(wq); \
 		if (condition) { \
 			status = 1; \
 			goto out; \
 		} \
-		status = wait_enqueue(wq, osWaitForever); \
+		status = wait_enqueue_sequence(wq, sequence, osWaitForever); \
 		if (status < 0) \
 			goto out; \
 	} while (0); \
@@ -55,11 +47,12 @@ out: \
 	int status = 0; \
 	unsigned int delay = msecs; \
 	do { \
+		long sequence = wait_prepare(wq); \
 		if (condition) { \
 			status = delay - status; \
 			goto out; \
 		} \
-		status = wait_enqueue(wq, msecs); \
+		status = wait_enqueue_sequence(wq, sequence, msecs); \
 		if (status < 0) \
 			goto out; \
 		delay -= status; \
@@ -81,15 +74,25 @@ void wait_queue_fini(struct wait_queue *queue);
 struct wait_queue *wait_queue_create(void);
 void wait_queue_destroy(struct wait_queue *queue);
 
+long wait_prepare(struct wait_queue *queue);
 int wait_enqueue(struct wait_queue *queue, unsigned int msec);
+int wait_enqueue_sequence(struct wait_queue *queue, long sequence, unsigned int msec);
 int wait_notify(struct wait_queue *queue, bool all);
 void wait_reset(struct wait_queue *queue);
 
+static inline struct rtos_poll_head *wait_pollable(struct wait_queue *queue)
+{
+	assert(queue != 0);
+
+	/* For use as the object of an osWaitQueue entry passed to osWaitMultiple */
+	return &queue->pollers;
+}
+
 static inline bool wait_is_busy(const struct wait_queue *queue)
 {
 	assert(queue != 0);
 
-	return !list_is_empty(&queue->waiters);
+	return queue->count > 0;
 }
 
 #endif
@@ -34,14 +34,60 @@
 #define RTOS_TIMER_MARKER 0x42066024UL
 #define RTOS_MESSAGE_QUEUE_MARKER 0x42077024UL
 #define RTOS_DEQUE_MARKER 0x42088024UL
+#define RTOS_EXECUTOR_MARKER 0x42099024UL
 
 #define osDynamicAlloc 0x80000000U
 #define osReapThread 0x40000000U
 #define osThreadCreateSuspended 0x20000000U
+#define osThreadPooled 0x10000000U
+#define osMutexAdaptive 0x10000000U
+#define osMutexPrioCeiling 0x08000000U
+#define osMemoryPoolCached 0x10000000U
+#define osMemoryPoolUncached 0x08000000U
+#define osTimerSwi 0x10000000U
+
+#define osThreadQuantum_Pos 16U
+#define osThreadQuantum_Msk (0xffUL << osThreadQuantum_Pos)
+#define osThreadQuantum(ticks) ((((uint32_t)(ticks)) << osThreadQuantum_Pos) & osThreadQuantum_Msk)
+
+#define osMutexCeiling_Pos 16U
+#define osMutexCeiling_Msk (0xffUL << osMutexCeiling_Pos)
+#define osMutexCeiling(priority) (osMutexPrioCeiling | ((((uint32_t)(priority)) << osMutexCeiling_Pos) & osMutexCeiling_Msk))
 
 #define RTOS_NAME_SIZE 32UL
 #define RTOS_DEFAULT_STACK_SIZE 1024UL
-#define RTOS_TIMER_QUEUE_SIZE 5
+#define RTOS_TIMER_WHEEL_SIZE 256UL
+#define RTOS_MUTEX_SPIN_MAX 1000UL
+#define RTOS_MUTEX_SPIN_TICKS 1UL
+#define RTOS_SEMAPHORE_COUNT_SHIFT 1U
+#define RTOS_SEMAPHORE_MAX_COUNT (UINT32_MAX >> RTOS_SEMAPHORE_COUNT_SHIFT)
+#define RTOS_EVENTFLAGS_SHIFT 1U
+#define RTOS_POOL_MAGAZINE_SIZE 4UL
+#define RTOS_POOL_MAGAZINE_BATCH 2UL
+#define RTOS_POOL_CACHE_MIN_BLOCKS (SystemNumCores * RTOS_POOL_MAGAZINE_SIZE * 2UL)
+#define RTOS_MESSAGE_QUEUE_LEVELS 8UL
+#define RTOS_MESSAGE_QUEUE_LEVEL_SHIFT 5U
+#define RTOS_POLL_WAKE_BATCH 4UL
+
+#ifndef RTOS_TIMER_SWI
+#define RTOS_TIMER_SWI 4
+#endif
+
+#ifndef RTOS_THREAD_POOL_SMALL_STACK
+#define RTOS_THREAD_POOL_SMALL_STACK RTOS_DEFAULT_STACK_SIZE
+#endif
+
+#ifndef RTOS_THREAD_POOL_SMALL_COUNT
+#define RTOS_THREAD_POOL_SMALL_COUNT 4UL
+#endif
+
+#ifndef RTOS_THREAD_POOL_LARGE_STACK
+#define RTOS_THREAD_POOL_LARGE_STACK (RTOS_DEFAULT_STACK_SIZE * 2UL)
+#endif
+
+#ifndef RTOS_THREAD_POOL_LARGE_COUNT
+#define RTOS_THREAD_POOL_LARGE_COUNT 2UL
+#endif
 
 #define osOnceFlagsInit 0
 
@@ -55,6 +101,8 @@ typedef void *osResource_t;
 typedef osStatus_t (*osResouceNodeForEachFunc_t)(const osResource_t resource, void *context);
 
 typedef void *osDequeId_t;
+typedef void *osExecutorId_t;
+typedef void (*osWorkFunc_t)(void *argument);
 
 typedef enum
 {
@@ -81,6 +129,82 @@ typedef struct {
 	uint32_t dq_size;
 } osDequeAttr_t;
 
+typedef struct {
+	const char *name;
+	uint32_t attr_bits;
+	void *cb_mem;
+	uint32_t cb_size;
+	uint32_t stack_size;
+	osPriority_t priority;
+} osExecutorAttr_t;
+
+typedef struct {
+	uint32_t stack_size;
+	uint32_t capacity;
+	uint32_t available;
+	uint32_t misses;
+} osThreadPoolInfo_t;
+
+typedef enum
+{
+	osWaitSemaphore = 0,
+	osWaitEventFlags = 1,
+	osWaitMessageQueue = 2,
+	osWaitDeque = 3,
+	osWaitQueue = 4,
+	osWaitReserved = 0x7fffffff,
+} osWaitType_t;
+
+typedef enum
+{
+	osMessageFree = 0,
+	osMessageAllocated = 1,
+	osMessageQueued = 2,
+	osMessageReceived = 3,
+	osMessageReserved = 0x7fffffff,
+} osMessageState_t;
+
+struct rtos_poll_head
+{
+	spinlock_t lock;
+	atomic_ulong sequence;
+	atomic_long notifying;
+	struct futex notify_futex;
+	unsigned long generation;
+	struct linked_list waiters;
+};
+
+typedef struct {
+	osWaitType_t type;
+	void *object;
+	uint32_t flags;
+	uint32_t options;
+	uint32_t ready;
+
+	/* Private to osWaitMultiple */
+	struct rtos_poll_head *head;
+	struct rtos_thread *thread;
+	struct linked_list node;
+	unsigned long generation;
+	unsigned long sequence;
+} osWaitObject_t;
+
+typedef struct {
+	uint64_t run_time;
+	uint32_t switches;
+	uint32_t preemptions;
+	uint32_t futex_waits;
+} osThreadStats_t;
+
+typedef struct {
+	uint32_t expirations;
+	uint32_t overruns;
+	uint32_t late_max;
+	uint32_t latency_min;
+	uint32_t latency_max;
+	uint64_t latency_total;
+} osTimerStats_t;
+
 struct rtos_eventflags
 {
 	osResourceMarker_t marker;
@@ -93,6 +217,8 @@ struct rtos_eventflags
 	atomic_long waiters;
 	atomic_long flags;
 
+	struct rtos_poll_head pollers;
+
 	struct linked_list resource_node;
 };
 
@@ -107,6 +233,8 @@ struct rtos_mutex
 
 	atomic_long value;
 	int count;
+	uint32_t spins;
+	struct sched_ceiling ceiling;
 
 	struct linked_list resource_node;
 };
@@ -123,6 +251,8 @@ struct rtos_semaphore
 	uint32_t max_count;
 	atomic_uint value;
 
+	struct rtos_poll_head pollers;
+
 	struct linked_list resource_node;
 };
 
@@ -140,11 +270,61 @@ struct rtos_thread
 	struct rtos_eventflags joiner;
 	struct rtos_eventflags flags;
 
+	struct futex poll_futex;
+	atomic_long poll_sequence;
+
+	struct rtos_thread_pool *pool;
+	unsigned long *stack_watermark;
+
 	struct linked_list resource_node;
 
 	uint8_t stack_area[] __aligned(8);
 };
 
+struct rtos_thread_pool
+{
+	size_t stack_size;
+	size_t capacity;
+	size_t slot_size;
+	uint8_t *slots;
+
+	spinlock_t lock;
+	size_t available;
+	uint32_t misses;
+	struct linked_list free_list;
+};
+
+struct rtos_work
+{
+	osWorkFunc_t func;
+	void *argument;
+};
+
+struct rtos_executor
+{
+	osResourceMarker_t marker;
+	char name[RTOS_NAME_SIZE];
+
+	uint32_t attr_bits;
+
+	osDequeId_t queue;
+	struct rtos_eventflags idle;
+	atomic_ulong pending;
+
+	uint32_t count;
+	osThreadId_t workers[];
+};
+
+struct rtos_pool_magazine
+{
+	uint32_t count;
+	void **blocks[RTOS_POOL_MAGAZINE_SIZE];
+
+	struct rtos_memory_pool *pool;
+	struct scheduler_core_call drain;
+	atomic_ulong flushed;
+};
+
 struct rtos_memory_pool
 {
 	osResourceMarker_t marker;
@@ -160,6 +340,9 @@ struct rtos_memory_pool
 	void **free_list;
 	spinlock_t lock;
 
+	struct rtos_pool_magazine magazines[SystemNumCores];
+	atomic_ulong waiting;
+
 	struct linked_list resource_node;
 
 	uint32_t data[] __aligned(8);
@@ -178,8 +361,12 @@ struct rtos_timer
 	uint32_t ticks;
 
 	uint32_t target;
+	bool pending;
+	uint32_t expired_at;
+	osTimerStats_t stats;
 
 	struct linked_list node;
+	struct linked_list dispatch_node;
 
 	struct linked_list resource_node;
 };
@@ -188,6 +375,7 @@ struct rtos_message
 {
 	uint32_t priority;
 	struct linked_list node;
+	osMessageState_t state;
 
 	char data[] __aligned(8);
 };
@@ -206,7 +394,8 @@ struct rtos_message_queue
 	struct rtos_memory_pool message_pool;
 	spinlock_t lock;
 
-	struct linked_list messages;
+	uint32_t levels;
+	struct linked_list messages[RTOS_MESSAGE_QUEUE_LEVELS];
 
 	struct linked_list resource_node;
 
@@ -268,6 +457,8 @@ osStatus_t osDequePutFront(osDequeId_t dq_id, const void *element, uint32_t time
 osStatus_t osDequePutBack(osDequeId_t dq_id, const void *element, uint32_t timeout);
 osStatus_t osDequeGetFront(osDequeId_t dq_id, void *element, uint32_t timeout);
 osStatus_t osDequeGetBack(osDequeId_t dq_id, void *element, uint32_t timeout);
+int32_t osDequePutBackMany(osDequeId_t dq_id, const void *elements, uint32_t count, uint32_t timeout);
+int32_t osDequeGetFrontMany(osDequeId_t dq_id, void *elements, uint32_t count, uint32_t timeout);
 uint32_t osDequeGetCapacity(osDequeId_t dq_id);
 uint32_t osDequeGetElementSize(osDequeId_t dq_id);
 uint32_t osDequeGetCount(osDequeId_t dq_id);
@@ -327,8 +518,44 @@ static inline __always_inline __optimize osPriority_t osKernelPriority(uint32_t
 	return osPriorityISR - scheduler_priority;
 }
 
+void osPollHeadInit(struct rtos_poll_head *head);
+void osPollWake(struct rtos_poll_head *head);
+int32_t osWaitMultiple(osWaitObject_t *objects, uint32_t count, uint32_t timeout);
+
+static inline void osPollNotify(struct rtos_poll_head *head)
+{
+	/* Nobody polling is the common case, keep it to a single load */
+	if (!list_is_empty(&head->waiters))
+		osPollWake(head);
+}
+
+static inline void osPollSignal(struct rtos_poll_head *head)
+{
+	/* Edge triggered sources bump the sequence so pollers can see something happened */
+	atomic_fetch_add(&head->sequence, 1);
+	osPollNotify(head);
+}
+
 osStatus_t osMemoryPoolIsBlockValid(osMemoryPoolId_t mp_id, void *block);
+void *osMessageQueueAlloc(osMessageQueueId_t mq_id, uint32_t timeout);
+osStatus_t osMessageQueueCommit(osMessageQueueId_t mq_id, void *msg_ptr, uint8_t msg_prio);
+void *osMessageQueueReceive(osMessageQueueId_t mq_id, uint8_t *msg_prio, uint32_t timeout);
+osStatus_t osMessageQueueRelease(osMessageQueueId_t mq_id, void *msg_ptr);
+int32_t osMessageQueuePutMany(osMessageQueueId_t mq_id, const void *msg_ptrs, uint32_t count, uint8_t msg_prio, uint32_t timeout);
+int32_t osMessageQueueGetMany(osMessageQueueId_t mq_id, void *msg_ptrs, uint8_t *msg_prios, uint32_t count, uint32_t timeout);
+int32_t osSemaphoreAcquireMany(osSemaphoreId_t semaphore_id, uint32_t count, uint32_t timeout);
+osStatus_t osSemaphoreReleaseMany(osSemaphoreId_t semaphore_id, uint32_t count);
 void osTimerTick(void);
+osStatus_t osTimerGetStats(osTimerId_t timer_id, osTimerStats_t *stats);
 osStatus_t osMutexRobustRelease(osMutexId_t mutex_id, osThreadId_t owner);
+osStatus_t osThreadGetStats(osThreadId_t thread_id, osThreadStats_t *stats);
+osStatus_t osThreadPoolGetInfo(uint32_t index, osThreadPoolInfo_t *info);
+struct rtos_thread *osThreadResource(osThreadId_t thread_id);
+osThreadId_t osThreadResourceId(struct rtos_thread *thread);
+osExecutorId_t osExecutorNew(uint32_t workers, uint32_t queue_size, const osExecutorAttr_t *attr);
+osStatus_t osExecutorSubmit(osExecutorId_t executor_id, osWorkFunc_t func, void *argument, uint32_t timeout);
+osStatus_t osExecutorWait(osExecutorId_t executor_id, uint32_t timeout);
+osStatus_t osExecutorDelete(osExecutorId_t executor_id);
+uint64_t osKernelGetIdleTime(uint32_t core);
 
 #endif
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * scheduler-edf.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ *
+ * Earliest deadline first policy helpers, shared by the scheduler and the host simulation test
+ * so they must stay free of any target dependencies.
+ */
+
+#ifndef _SCHEDULER_EDF_H_
+#define _SCHEDULER_EDF_H_
+
+#include <stdbool.h>
+
+struct task_edf
+{
+	unsigned long period;
+	unsigned long deadline;
+	unsigned long budget;
+	unsigned long priority;
+
+	unsigned long release;
+	unsigned long absolute_deadline;
+	unsigned long remaining;
+
+	unsigned long overruns;
+	unsigned long misses;
+
+	bool exhausted;
+};
+
+static inline bool scheduler_edf_before(unsigned long deadline, unsigned long other)
+{
+	/* Tick counts wrap, compare the distance */
+	return (long)(deadline - other) < 0;
+}
+
+static inline void scheduler_edf_release(struct task_edf *edf, unsigned long release)
+{
+	/* Start a new job, the deadline is relative to the release */
+	edf->release = release;
+	edf->absolute_deadline = release + edf->deadline;
+	edf->remaining = edf->budget;
+}
+
+static inline bool scheduler_edf_complete(struct task_edf *edf, unsigned long now)
+{
+	/* Finishing after the deadline is a miss */
+	bool missed = scheduler_edf_before(edf->absolute_deadline, now);
+	if (missed)
+		++edf->misses;
+
+	/* Next release, if we are running late skip to the latest release which has already passed */
+	unsigned long release = edf->release + edf->period;
+	if (scheduler_edf_before(release, now))
+		release += ((now - release) / edf->period) * edf->period;
+	scheduler_edf_release(edf, release);
+	edf->exhausted = false;
+
+	return missed;
+}
+
+static inline bool scheduler_edf_charge(struct task_edf *edf)
+{
+	/* No budget, no enforcement */
+	if (edf->budget == 0 || edf->remaining == 0)
+		return false;
+
+	/* Charge a tick and report exhaustion exactly once per job */
+	if (--edf->remaining != 0)
+		return false;
+	++edf->overruns;
+	edf->exhausted = true;
+	return true;
+}
+
+#endif
@@ -23,6 +23,8 @@
 
 #include <sys/types.h>
 
+#include <rtos/rtos-toolkit/scheduler-edf.h>
+
 #ifndef SCHEDULER_PRIOR_BITS
 #define SCHEDULER_PRIOR_BITS 0x00000002UL
 #endif
@@ -54,6 +56,13 @@
 
 #define SCHEDULER_WAIT_FOREVER 0xffffffffUL
 
+#ifndef SCHEDULER_MAX_TASKS
+#define SCHEDULER_MAX_TASKS 256UL
+#endif
+
+#define SCHEDULER_HANDLE_SLOT_BITS 16UL
+#define SCHEDULER_HANDLE_SLOT_MASK ((1UL << SCHEDULER_HANDLE_SLOT_BITS) - 1)
+
 #define SCHEDULER_IGNORE_VIABLE 0x00000001UL
 #define SCHEDULER_TASK_STACK_CHECK 0x00000002UL
 #define SCHEDULER_NO_TLS_INIT 0x00000004UL
@@ -61,13 +70,19 @@
 #define SCHEDULER_PRIMORDIAL_TASK 0x00000010UL
 #define SCHEDULER_CORE_AFFINITY 0x00000020UL
 #define SCHEDULER_CREATE_SUSPENDED 0x00000040UL
+#define SCHEDULER_STACK_PREMARKED 0x00000080UL
+#define SCHEDULER_RETAIN_HANDLE 0x00000100UL
 
 #define SCHEDULER_FUTEX_CONTENTION_TRACKING 0x00000001UL
 #define SCHEDULER_FUTEX_PI 0x00000002UL
 #define SCHEDULER_FUTEX_OWNER_TRACKING 0x00000004UL
 
 #ifndef SCHEDULER_MAX_DEFERED_WAKE
-#define SCHEDULER_MAX_DEFERED_WAKE 8
+#define SCHEDULER_MAX_DEFERED_WAKE 32
+#endif
+
+#if (SCHEDULER_MAX_DEFERED_WAKE & (SCHEDULER_MAX_DEFERED_WAKE - 1)) != 0
+#error "SCHEDULER_MAX_DEFERED_WAKE must be a power of 2"
 #endif
 
 #ifndef SCHEDULER_TIME_SLICE
@@ -82,6 +97,53 @@
 #define SCHEDULER_TICK_FREQ 1000UL
 #endif
 
+#ifndef SCHEDULER_BITMAP_QUEUE
+#define SCHEDULER_BITMAP_QUEUE 1
+#endif
+
+#define SCHEDULER_PRIORITY_WORDS (SCHEDULER_NUM_TASK_PRIORITIES / 32UL)
+
+#ifndef SCHEDULER_TIMER_WHEEL_SLOTS
+#define SCHEDULER_TIMER_WHEEL_SLOTS 64UL
+#endif
+
+#ifndef SCHEDULER_LOCK_STATS
+#define SCHEDULER_LOCK_STATS 0
+#endif
+
+/* Kernel lock used by the multicore glue, the ticket lock is fair, the hardware lock is cheapest uncontended and the queued lock hands over in order without every waiter polling the same word */
+#define SCHEDULER_KERNEL_LOCK_TICKET 0
+#define SCHEDULER_KERNEL_LOCK_HW 1
+#define SCHEDULER_KERNEL_LOCK_MCS 2
+
+#ifndef SCHEDULER_KERNEL_LOCK
+#define SCHEDULER_KERNEL_LOCK SCHEDULER_KERNEL_LOCK_TICKET
+#endif
+
+#ifndef SCHEDULER_RUNTIME_STATS
+#define SCHEDULER_RUNTIME_STATS 0
+#endif
+
+#ifndef SCHEDULER_TICKLESS
+#define SCHEDULER_TICKLESS 0
+#endif
+
+#ifndef SCHEDULER_EDF
+#define SCHEDULER_EDF 0
+#endif
+
+#ifndef SCHEDULER_EDF_PRIORITY
+#define SCHEDULER_EDF_PRIORITY SCHEDULER_MAX_TASK_PRIORITY
+#endif
+
+#ifndef SCHEDULER_TICKLESS_MIN_TICKS
+#define SCHEDULER_TICKLESS_MIN_TICKS 2UL
+#endif
+
+#ifndef SCHEDULER_TICKLESS_CHANNEL
+#define SCHEDULER_TICKLESS_CHANNEL 2UL
+#endif
+
 struct exception_frame
 {
 	uint32_t r0;
@@ -125,12 +187,37 @@ struct sched_list
 	struct sched_list *prev;
 };
 
+struct sched_ready_queue;
+
 /* Done like this to allow easy re-implementation */
 struct sched_queue
 {
+	/* Priority sorted list, futex waiters and the ready queues without priority fifos */
 	struct sched_list tasks;
+
+#if SCHEDULER_BITMAP_QUEUE > 0
+	/* The enclosing ready queue, null for futex waiters */
+	struct sched_ready_queue *ready;
+#endif
 };
 
+/* Only the per core ready queues pay for the priority fifos */
+#if SCHEDULER_BITMAP_QUEUE > 0
+struct sched_ready_queue
+{
+	struct sched_queue queue;
+
+	/* One fifo per priority with a bit per non-empty fifo, MSB of the first word is priority 0 */
+	struct sched_list fifos[SCHEDULER_NUM_TASK_PRIORITIES];
+	unsigned long bitmap[SCHEDULER_PRIORITY_WORDS];
+};
+#else
+struct sched_ready_queue
+{
+	struct sched_queue queue;
+};
+#endif
+
 enum task_state
 {
 	TASK_TERMINATED = 1,
@@ -154,6 +241,18 @@ struct task_descriptor
 	unsigned long flags;
 	unsigned long priority;
 	unsigned long affinity;
+	unsigned long quantum;
+	unsigned long period;
+	unsigned long deadline;
+	unsigned long budget;
+};
+
+struct task_stats
+{
+	unsigned long long run_time;
+	unsigned long switches;
+	unsigned long preemptions;
+	unsigned long futex_waits;
 };
 
 struct task
@@ -169,12 +268,16 @@ struct task
 
 	unsigned long base_priority;
 	unsigned long current_priority;
+	unsigned long quantum;
 
 	unsigned long timer_expires;
 	struct sched_list timer_node;
 
 	struct sched_list scheduler_node;
 	struct sched_list owned_futexes;
+	struct sched_list held_ceilings;
+	unsigned long ceiling_priority;
+	unsigned long priority_sequence;
 
 	struct sched_queue *current_queue;
 	struct sched_list queue_node;
@@ -182,6 +285,10 @@ struct task
 	void *context;
 	task_exit_handler_t exit_handler;
 	atomic_ulong flags;
+	unsigned long handle;
+
+	struct task_stats stats;
+	struct task_edf edf;
 
 	unsigned long marker;
 };
@@ -192,18 +299,52 @@ struct futex
 	struct sched_queue waiters;
 	struct sched_list owned;
 	unsigned long flags;
+	atomic_ulong deferred;
 	unsigned long marker;
 };
 
+struct sched_ceiling
+{
+	struct sched_list node;
+	struct task *task;
+	unsigned long priority;
+};
+
+struct scheduler_wake_stats
+{
+	unsigned long capacity;
+	unsigned long high_water;
+	unsigned long deferred;
+	unsigned long coalesced;
+	unsigned long overflows;
+};
+
+struct scheduler_core_call
+{
+	void (*func)(struct scheduler_core_call *call);
+	volatile unsigned long sequence;
+};
+
+struct scheduler_lock_stats
+{
+	unsigned long acquired;
+	unsigned long contended;
+	unsigned long long wait_cycles;
+	unsigned long long hold_cycles;
+	unsigned long max_wait_cycles;
+	unsigned long max_hold_cycles;
+	unsigned long kicks;
+};
+
 struct scheduler
 {
 	size_t tls_size;
 	unsigned long slice_duration;
 
-	struct sched_queue ready_queue;
-
 	struct sched_list tasks;
-	struct sched_list timers;
+	struct sched_list timers[SCHEDULER_TIMER_WHEEL_SLOTS];
+	unsigned long timer_bitmap[SCHEDULER_TIMER_WHEEL_SLOTS / 32];
+	unsigned long timer_position;
 	unsigned long timer_expires;
 
 	atomic_int running;
@@ -211,6 +352,10 @@ struct scheduler
 	atomic_int critical;
 	int critical_counter;
 
+	struct task *task_slots[SCHEDULER_MAX_TASKS];
+	unsigned short task_generations[SCHEDULER_MAX_TASKS];
+	unsigned long task_slot_hint;
+
 	unsigned long marker;
 };
 
@@ -222,13 +367,30 @@ void scheduler_for_each(struct sched_list *list, for_each_sched_node_t func, voi
 unsigned long scheduler_num_cores(void);
 unsigned long scheduler_current_core(void);
 void scheduler_request_switch(unsigned long core);
+void scheduler_core_call(unsigned long core, struct scheduler_core_call *call);
+
+void scheduler_get_lock_stats(unsigned long core, struct scheduler_lock_stats *stats);
+void scheduler_reset_lock_stats(void);
+
+void scheduler_get_wake_stats(unsigned long core, struct scheduler_wake_stats *stats);
+void scheduler_reset_wake_stats(void);
+
+int scheduler_get_task_stats(struct task *task, struct task_stats *stats);
+unsigned long long scheduler_get_idle_time(unsigned long core);
 
 void scheduler_tick(void);
 
 unsigned long scheduler_get_ticks(void);
 
+unsigned long scheduler_tick_deadline_hook(void);
+bool scheduler_tickless_enter(unsigned long ticks);
+unsigned long scheduler_tickless_exit(void);
+
 struct task *scheduler_create(void *stack, size_t stack_size, const struct task_descriptor *descriptor);
 struct task *scheduler_task(void);
+unsigned long scheduler_task_handle(struct task *task);
+struct task *scheduler_task_lookup(unsigned long handle);
+void scheduler_release_handle(struct task *task);
 
 unsigned long scheduler_enter_critical(void);
 void scheduler_exit_critical(unsigned long state);
@@ -241,16 +403,23 @@ bool scheduler_is_locked(void);
 void scheduler_yield(void);
 int scheduler_sleep(unsigned long ticks);
 
-int scheduler_suspend(struct task *task);
-int scheduler_resume(struct task *task);
-int scheduler_terminate(struct task *task);
+int scheduler_suspend(unsigned long handle);
+int scheduler_resume(unsigned long handle);
+int scheduler_terminate(unsigned long handle);
 
 void scheduler_futex_init(struct futex *futex, long *value, unsigned long flags);
 int scheduler_futex_wait(struct futex *futex, long value, unsigned long ticks);
 int scheduler_futex_wake(struct futex *futex, bool all);
+int scheduler_futex_requeue(struct futex *from, struct futex *to, unsigned long nr_wake, unsigned long nr_requeue);
+
+int scheduler_edf_wait(void);
+void scheduler_edf_overrun_hook(struct task *task, bool missed);
 
-int scheduler_set_priority(struct task *task, unsigned long priority);
-unsigned long scheduler_get_priority(struct task *task);
+int scheduler_set_priority(unsigned long handle, unsigned long priority);
+unsigned long scheduler_get_priority(unsigned long handle);
+void scheduler_raise_priority(struct sched_ceiling *ceiling);
+void scheduler_move_ceiling(struct sched_ceiling *from, struct sched_ceiling *to);
+void scheduler_restore_priority(struct sched_ceiling *ceiling);
 
 void scheduler_set_flags(struct task *task, unsigned long mask);
 void scheduler_clear_flags(struct task *task, unsigned long mask);
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * atomic-locks.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ */
+
+#ifndef _ATOMIC_LOCKS_H_
+#define _ATOMIC_LOCKS_H_
+
+/*
+ * The M0+ has no exclusive access instructions so runtime/atomic.c backs every atomic with a SIO
+ * hardware spinlock. Most objects share a lock picked by hashing their address into the striped
+ * locks, objects declared __atomic_pinned get a pinned lock of their own. The pinned locks and the
+ * locks reserved for sys/spinlock.h come out of the bank first and everything left is striped.
+ */
+
+#define ATOMIC_SIO_LOCKS 32UL
+
+#ifndef ATOMIC_PINNED_LOCKS
+#define ATOMIC_PINNED_LOCKS 2UL
+#endif
+
+/* Kept back for the hardware spinlocks, the kernel lock and one spare */
+#ifndef ATOMIC_RESERVED_LOCKS
+#define ATOMIC_RESERVED_LOCKS 2UL
+#endif
+
+/* Need not be a power of 2 */
+#define ATOMIC_HW_LOCKS (ATOMIC_SIO_LOCKS - ATOMIC_PINNED_LOCKS - ATOMIC_RESERVED_LOCKS)
+
+#define ATOMIC_HW_LOCK_INDEX 0UL
+#define ATOMIC_PINNED_LOCK_INDEX (ATOMIC_HW_LOCK_INDEX + ATOMIC_HW_LOCKS)
+#define ATOMIC_LOCK_COUNT (ATOMIC_HW_LOCKS + ATOMIC_PINNED_LOCKS)
+
+/* Count acquisitions and spins for each lock, costs a few cycles on every atomic operation */
+#ifndef ATOMIC_STATS
+#define ATOMIC_STATS 0
+#endif
+
+/* Each pinned object gets an 8 byte slot in .atomic_pinned and the lock matching the slot, sections.ld checks they all fit */
+#define __atomic_pinned __attribute__((section(".atomic_pinned"), aligned(8)))
+
+struct atomic_lock_stats
+{
+	unsigned long acquired;
+	unsigned long contended;
+	unsigned long spins;
+};
+
+unsigned int atomic_lock_index(const volatile void *obj);
+
+void atomic_get_lock_stats(unsigned int lock, struct atomic_lock_stats *stats);
+void atomic_reset_lock_stats(void);
+
+#endif
@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * heap.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ */
+
+#ifndef _HEAP_H_
+#define _HEAP_H_
+
+#include <tlsf.h>
+
+/* Replace the libc malloc family with the TLSF heap, build with HEAP_TLSF=0 to go back to the libc allocator over sbrk */
+#ifndef HEAP_TLSF
+#define HEAP_TLSF 1
+#endif
+
+/* Give each core its own arena in a dedicated SRAM bank, see .heap_0 and .heap_1 in sections.ld, the shared heap backs them up when they run out */
+#ifndef HEAP_PER_CORE_ARENAS
+#define HEAP_PER_CORE_ARENAS 1
+#endif
+
+#define HEAP_ARENA_CORE0 0
+#define HEAP_ARENA_CORE1 1
+#define HEAP_ARENA_SHARED 2
+#define HEAP_ARENA_COUNT 3
+
+int heap_get_stats(struct tlsf_stats *stats);
+int heap_get_arena_stats(unsigned int arena, struct tlsf_stats *stats);
+
+#endif
@@ -19,4 +19,6 @@ int periodic_unregister(unsigned int channel);
 int periodic_enable(unsigned int channel);
 int periodic_disable(unsigned int channel);
 
+int periodic_oneshot(unsigned int channel, unsigned long target);
+
 #endif
@@ -20,8 +20,27 @@
 
 #include <cmsis/cmsis.h>
 
+#include <sys/atomic-locks.h>
+
+/* The SIO hardware locks above the ones used by the atomics */
+#define HW_SPINLOCK_FIRST (ATOMIC_HW_LOCK_INDEX + ATOMIC_LOCK_COUNT)
+#define HW_SPINLOCK_COUNT (ATOMIC_SIO_LOCKS - HW_SPINLOCK_FIRST)
+#define HW_SPINLOCK_KERNEL HW_SPINLOCK_FIRST
+
 typedef atomic_ulong spinlock_t;
 
+/* Index of a SIO hardware lock, taken with a single read and released with a single write but not fair */
+typedef unsigned int hw_spinlock_t;
+
+/* Queued lock, each waiter spins on its own node and the lock is handed over in arrival order */
+typedef atomic_uintptr_t mcs_lock_t;
+
+struct mcs_node
+{
+	struct mcs_node *volatile next;
+	volatile bool locked;
+};
+
 static inline void spin_lock(spinlock_t *spinlock)
 {
 	assert(spinlock != 0);
@@ -81,4 +100,124 @@ static inline void spin_unlock_irqrestore(spinlock_t *spinlock, unsigned int sta
 	enable_interrupts(state);
 }
 
+static inline void hw_spin_lock_init(hw_spinlock_t *spinlock, unsigned int index)
+{
+	assert(spinlock != 0 && index >= HW_SPINLOCK_FIRST && index < HW_SPINLOCK_FIRST + HW_SPINLOCK_COUNT);
+
+	*spinlock = index;
+	(&SIO->SPINLOCK0)[index] = 0;
+}
+
+static inline void hw_spin_lock(hw_spinlock_t *spinlock)
+{
+	assert(spinlock != 0);
+
+	volatile uint32_t *hw_lock = &SIO->SPINLOCK0 + *spinlock;
+	while (*hw_lock == 0);
+	__DMB();
+}
+
+static inline unsigned int hw_spin_lock_irqsave(hw_spinlock_t *spinlock)
+{
+	assert(spinlock != 0);
+
+	uint32_t state = disable_interrupts();
+	hw_spin_lock(spinlock);
+	return state;
+}
+
+static inline bool hw_spin_try_lock(hw_spinlock_t *spinlock)
+{
+	assert(spinlock != 0);
+
+	if ((&SIO->SPINLOCK0)[*spinlock] == 0)
+		return false;
+
+	__DMB();
+	return true;
+}
+
+static inline void hw_spin_unlock(hw_spinlock_t *spinlock)
+{
+	assert(spinlock != 0);
+
+	__DMB();
+	(&SIO->SPINLOCK0)[*spinlock] = 0;
+}
+
+static inline void hw_spin_unlock_irqrestore(hw_spinlock_t *spinlock, unsigned int state)
+{
+	assert(spinlock != 0);
+
+	hw_spin_unlock(spinlock);
+	enable_interrupts(state);
+}
+
+static inline void mcs_lock(mcs_lock_t *lock, struct mcs_node *node)
+{
+	assert(lock != 0 && node != 0);
+
+	/* Join the end of the queue */
+	node->next = 0;
+	node->locked = true;
+	struct mcs_node *prev = (struct mcs_node *)atomic_exchange(lock, (uintptr_t)node);
+	if (!prev)
+		return;
+
+	/* Link in behind the previous waiter and spin on our own node until it hands over */
+	prev->next = node;
+	while (node->locked)
+		__WFE();
+	__DMB();
+}
+
+static inline unsigned int mcs_lock_irqsave(mcs_lock_t *lock, struct mcs_node *node)
+{
+	assert(lock != 0 && node != 0);
+
+	uint32_t state = disable_interrupts();
+	mcs_lock(lock, node);
+	return state;
+}
+
+static inline bool mcs_try_lock(mcs_lock_t *lock, struct mcs_node *node)
+{
+	assert(lock != 0 && node != 0);
+
+	/* Only when nobody holds it or is waiting for it */
+	node->next = 0;
+	node->locked = true;
+	uintptr_t expected = 0;
+	return atomic_compare_exchange_strong(lock, &expected, (uintptr_t)node);
+}
+
+static inline void mcs_unlock(mcs_lock_t *lock, struct mcs_node *node)
+{
+	assert(lock != 0 && node != 0);
+
+	if (!node->next) {
+
+		/* Nobody behind us, release the lock */
+		uintptr_t expected = (uintptr_t)node;
+		if (atomic_compare_exchange_strong(lock, &expected, 0))
+			return;
+
+		/* A waiter swapped in behind us but has not linked itself yet */
+		while (!node->next);
+	}
+
+	/* Hand over to the next waiter */
+	__DMB();
+	node->next->locked = false;
+	__SEV();
+}
+
+static inline void mcs_unlock_irqrestore(mcs_lock_t *lock, struct mcs_node *node, unsigned int state)
+{
+	assert(lock != 0 && node != 0);
+
+	mcs_unlock(lock, node);
+	enable_interrupts(state);
+}
+
 #endif
@@ -1,6 +1,9 @@
 #ifndef _SYSLOG_H_
 #define _SYSLOG_H_
 
+#include <stdint.h>
+#include <stdio.h>
+
 #include <compiler.h>
 
 #define SYSLOG_NONE 0
@@ -13,9 +16,77 @@
 
 #define SYSLOG_BACKTRACE_SIZE 25
 
+/*
+ * With SYSLOG_BINARY=1 the info, debug and trace macros stop formatting in the caller. They record the
+ * address of the format string, the caller PC, a timestamp and the raw arguments into a per core ring,
+ * strings are copied in. The logger task formats the records later, host-tools/syslog-decode can also
+ * decode the rings found in a memory dump using the format strings in the ELF. Errors and warnings are
+ * still formatted immediately.
+ */
+#ifndef SYSLOG_BINARY
+#define SYSLOG_BINARY 0
+#endif
+
+/* Ring size in words for each core, must be a power of 2 */
+#ifndef SYSLOG_BINARY_WORDS
+#define SYSLOG_BINARY_WORDS 512UL
+#endif
+
+/* Longest argument payload in words, extra arguments are dropped */
+#ifndef SYSLOG_BINARY_MAX_PAYLOAD
+#define SYSLOG_BINARY_MAX_PAYLOAD 24UL
+#endif
+
+/* Longest %s argument copied into a record */
+#ifndef SYSLOG_BINARY_MAX_STRING
+#define SYSLOG_BINARY_MAX_STRING 32UL
+#endif
+
+#define SYSLOG_BINARY_MAGIC 0x534c4f47UL
+
+/* Layout is shared with host-tools/syslog-decode, keep them in sync */
+#define SYSLOG_RECORD_WORDS(header) ((header) >> 16)
+#define SYSLOG_RECORD_LEVEL(header) ((header) & 0xff)
+#define SYSLOG_RECORD_HEADER(words, level) (((uint32_t)(words) << 16) | ((uint32_t)(level) & 0xff))
+
+struct syslog_record
+{
+	uint32_t header;
+	uint32_t fmt;
+	uint32_t pc;
+	uint32_t timestamp;
+	uint32_t payload[];
+};
+
+struct syslog_ring
+{
+	uint32_t magic;
+	uint32_t core;
+	uint32_t size;
+	volatile uint32_t head;
+	volatile uint32_t tail;
+	volatile uint32_t dropped;
+	uint32_t data[SYSLOG_BINARY_WORDS];
+};
+
 extern __attribute__((format(printf, 2, 3))) void syslog(int level, const char *fmt, ...);
 extern __noreturn __attribute__((format(printf, 1, 2))) void syslog_fatal_abort(const char *fmt, ...);
 
+#if SYSLOG_BINARY > 0
+extern __attribute__((format(printf, 2, 3))) void syslog_binary(int level, const char *fmt, ...);
+unsigned int syslog_binary_drain(FILE *file, unsigned int max);
+struct syslog_ring *syslog_binary_get_ring(unsigned long core);
+
+/* The format string lands in .syslog_fmt so it can be checked and found by the decoder, the format attribute still checks the arguments */
+#define syslog_deferred(LEVEL, FMT, ...) \
+	do { \
+		static const char __syslog_fmt[] __attribute__((section(".syslog_fmt"))) = FMT; \
+		syslog_binary(LEVEL, __syslog_fmt, ##__VA_ARGS__); \
+	} while (0)
+#else
+#define syslog_deferred(LEVEL, FMT, ...) syslog(LEVEL, FMT, ##__VA_ARGS__)
+#endif
+
 #ifndef NDEBUG
 
 #ifndef SYSLOG_LEVEL
@@ -49,19 +120,19 @@ extern __noreturn __attribute__((format(printf, 1, 2))) void syslog_fatal_abort(
 #endif
 
 #if LOG_LEVEL >= LOG_INFO
-	#define syslog_info(FMT, ...) syslog(SYSLOG_INFO, FMT, ##__VA_ARGS__)
+	#define syslog_info(FMT, ...) syslog_deferred(SYSLOG_INFO, FMT, ##__VA_ARGS__)
 #else
 	#define syslog_info(FMT, ...) do {} while (0)
 #endif
 
 #if LOG_LEVEL >= LOG_DEBUG
-	#define syslog_debug(FMT, ...) syslog(SYSLOG_DEBUG, FMT, ##__VA_ARGS__)
+	#define syslog_debug(FMT, ...) syslog_deferred(SYSLOG_DEBUG, FMT, ##__VA_ARGS__)
 #else
 	#define syslog_debug(FMT, ...) do {} while (0)
 #endif
 
 #if LOG_LEVEL >= LOG_TRACE
-	#define syslog_trace(FMT, ...) syslog(SYSLOG_TRACE, FMT, ##__VA_ARGS__)
+	#define syslog_trace(FMT, ...) syslog_deferred(SYSLOG_TRACE, FMT, ##__VA_ARGS__)
 #else
 	#define syslog_trace(FMT, ...) do {} while (0)
 #endif
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * trace.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ */
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef SYS_TRACE
+#define SYS_TRACE 0
+#endif
+
+#ifndef SYS_TRACE_ENTRIES
+#define SYS_TRACE_ENTRIES 512UL
+#endif
+
+#define TRACE_MAGIC 0x54524143UL
+
+enum trace_event_type
+{
+	TRACE_SWITCH_IN = 1,
+	TRACE_SWITCH_OUT = 2,
+	TRACE_FUTEX_WAIT = 3,
+	TRACE_FUTEX_WAKE = 4,
+	TRACE_DEFERRED_WAKE = 5,
+	TRACE_IRQ_ENTER = 6,
+	TRACE_IRQ_EXIT = 7,
+	TRACE_TIMER_EXPIRED = 8,
+	TRACE_IDLE = 9,
+};
+
+/* Layout is shared with host-tools/trace-decode, keep them in sync */
+struct trace_record
+{
+	uint32_t timestamp;
+	uint32_t data;
+	uint8_t event;
+	uint8_t arg;
+	uint16_t reserved;
+};
+
+struct trace_buffer
+{
+	uint32_t magic;
+	uint32_t core;
+	uint32_t size;
+	volatile uint32_t head;
+	struct trace_record records[SYS_TRACE_ENTRIES];
+};
+
+#if SYS_TRACE > 0
+void trace_record(unsigned int event, unsigned int arg, uint32_t data);
+void trace_start(void);
+void trace_stop(void);
+struct trace_buffer *trace_get_buffer(unsigned long core);
+#define trace_event(event, arg, data) trace_record(event, arg, (uint32_t)(data))
+#else
+#define trace_event(event, arg, data) do { } while (0)
+#endif
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * tlsf.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ */
+
+#ifndef _TLSF_H_
+#define _TLSF_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Two level segregated fit allocator, all operations are O(1) and the caller provides the locking */
+
+#ifndef TLSF_SL_LOG2
+#define TLSF_SL_LOG2 4UL
+#endif
+
+/* Highest bit of the largest supported block, 18 covers all of the RP2040 SRAM */
+#ifndef TLSF_FL_MAX
+#define TLSF_FL_MAX 18UL
+#endif
+
+#define TLSF_ALIGN_LOG2 3UL
+#define TLSF_ALIGN (1UL << TLSF_ALIGN_LOG2)
+#define TLSF_SL_COUNT (1UL << TLSF_SL_LOG2)
+#define TLSF_FL_SHIFT (TLSF_SL_LOG2 + TLSF_ALIGN_LOG2)
+#define TLSF_FL_COUNT (TLSF_FL_MAX - TLSF_FL_SHIFT + 2UL)
+#define TLSF_SMALL_BLOCK (1UL << TLSF_FL_SHIFT)
+
+struct tlsf_block;
+
+struct tlsf_stats
+{
+	size_t total;
+	size_t used;
+	size_t free;
+	size_t peak_used;
+	size_t largest_free;
+	size_t used_blocks;
+	size_t free_blocks;
+	unsigned int fragmentation;
+};
+
+struct tlsf
+{
+	uint32_t fl_bitmap;
+	uint32_t sl_bitmap[TLSF_FL_COUNT];
+	struct tlsf_block *blocks[TLSF_FL_COUNT][TLSF_SL_COUNT];
+	struct tlsf_block *first;
+
+	size_t total;
+	size_t used;
+	size_t free;
+	size_t peak_used;
+	size_t used_blocks;
+	size_t free_blocks;
+};
+
+int tlsf_init(struct tlsf *tlsf, void *mem, size_t size);
+
+void *tlsf_malloc(struct tlsf *tlsf, size_t size);
+void *tlsf_memalign(struct tlsf *tlsf, size_t alignment, size_t size);
+void *tlsf_realloc(struct tlsf *tlsf, void *ptr, size_t size);
+void *tlsf_resize(struct tlsf *tlsf, void *ptr, size_t size);
+void tlsf_free(struct tlsf *tlsf, void *ptr);
+size_t tlsf_usable_size(const void *ptr);
+
+void tlsf_get_stats(const struct tlsf *tlsf, struct tlsf_stats *stats);
+int tlsf_check(const struct tlsf *tlsf);
+
+#endif
@@ -75,6 +75,38 @@ static inline bool deque_is_full(const struct rtos_deque *deque)
 	return modulo(deque->back + 1, deque->element_count) == deque->front;
 }
 
+static inline size_t deque_count(const struct rtos_deque *deque)
+{
+	return modulo(deque->back - deque->front, deque->element_count);
+}
+
+static inline size_t deque_space(const struct rtos_deque *deque)
+{
+	return modulo(deque->front - (deque->back + 1), deque->element_count);
+}
+
+static inline void deque_put_many(struct rtos_deque *deque, const uint8_t *elements, size_t count)
+{
+	/* At most two copies, up to the end of the buffer and then from the start */
+	size_t first = deque->element_count - deque->back;
+	if (first > count)
+		first = count;
+	memcpy(deque->buffer + (deque->back * deque->element_size), elements, first * deque->element_size);
+	memcpy(deque->buffer, elements + (first * deque->element_size), (count - first) * deque->element_size);
+	deque->back = modulo(deque->back + count, deque->element_count);
+}
+
+static inline void deque_get_many(struct rtos_deque *deque, uint8_t *elements, size_t count)
+{
+	/* At most two copies, up to the end of the buffer and then from the start */
+	size_t first = deque->element_count - deque->front;
+	if (first > count)
+		first = count;
+	memcpy(elements, deque->buffer + (deque->front * deque->element_size), first * deque->element_size);
+	memcpy(elements + (first * deque->element_size), deque->buffer, (count - first) * deque->element_size);
+	deque->front = modulo(deque->front + count, deque->element_count);
+}
+
 osDequeId_t osDequeNew(uint32_t element_count, uint32_t element_size, const osDequeAttr_t *attr)
 {
 	const osDequeAttr_t default_attr = { .name = "deque",  .attr_bits = 0 };
@@ -493,6 +525,166 @@ osStatus_t osDequeGetBack(osDequeId_t dq_id, void *element, uint32_t timeout)
 	return osOK;
 }
 
+int32_t osDequePutBackMany(osDequeId_t dq_id, const void *elements, uint32_t count, uint32_t timeout)
+{
+	/* Make sure the elements were provided */
+	if (!elements || count == 0)
+		return osErrorParameter;
+
+	/* This would be bad */
+	osStatus_t os_status = osKernelContextIsValid(true, timeout);
+	if (os_status != osOK)
+		return os_status;
+
+	/* Validate the message queue */
+	os_status = osIsResourceValid(dq_id, RTOS_DEQUE_MARKER);
+	if (os_status != osOK)
+		return os_status;
+	struct rtos_deque *deque = dq_id;
+
+	/* Check for reset in progress */
+	uint32_t flags = osEventFlagsGet(&deque->events);
+	if (flags & (RTOS_DEQUE_RESET | osFlagsError)) {
+		if (flags & RTOS_DEQUE_RESET)
+			return osErrorResource;
+		return (osStatus_t)flags;
+	}
+
+	/* We are a potential waiter */
+	++deque->waiters;
+
+	/* Wait for room for at least one */
+	uint32_t state = spin_lock_irqsave(&deque->lock);
+	while (deque_is_full(deque)) {
+
+		/* Exit the critical section */
+		spin_unlock_irqrestore(&deque->lock, state);
+
+		/* Wait for room */
+		flags = osEventFlagsWait(&deque->events, RTOS_DEQUE_SPACE_AVAILABLE | RTOS_DEQUE_RESET, osFlagsWaitAny | osFlagsNoClear, timeout);
+		if (flags & osFlagsError) {
+			--deque->waiters;
+			return (osStatus_t)flags;
+		}
+
+		/* Clear the space available flag */
+		flags = osEventFlagsClear(&deque->events, RTOS_DEQUE_SPACE_AVAILABLE);
+		if (flags & osFlagsError) {
+			--deque->waiters;
+			return (osStatus_t)flags;
+		}
+
+		/* Is a reset in progress */
+		if (flags & RTOS_DEQUE_RESET) {
+			--deque->waiters;
+			return osErrorResource;
+		}
+
+		/* Lock it up again */
+		state = spin_lock_irqsave(&deque->lock);
+	}
+
+	/* Add as many as fit to the back of the queue */
+	size_t space = deque_space(deque);
+	if (count > space)
+		count = space;
+	deque_put_many(deque, elements, count);
+
+	/* Exit the critical section */
+	spin_unlock_irqrestore(&deque->lock, state);
+
+	/* At last */
+	--deque->waiters;
+
+	/* A single kick for the whole batch */
+	flags = osEventFlagsSet(&deque->events, RTOS_DEQUE_DATA_AVAILABLE);
+	if (flags & osFlagsError)
+		return (osStatus_t)flags;
+
+	/* Report how many went in */
+	return count;
+}
+
+int32_t osDequeGetFrontMany(osDequeId_t dq_id, void *elements, uint32_t count, uint32_t timeout)
+{
+	/* Make sure the elements were provided */
+	if (!elements || count == 0)
+		return osErrorParameter;
+
+	/* This would be bad */
+	osStatus_t os_status = osKernelContextIsValid(true, timeout);
+	if (os_status != osOK)
+		return os_status;
+
+	/* Validate the message queue */
+	os_status = osIsResourceValid(dq_id, RTOS_DEQUE_MARKER);
+	if (os_status != osOK)
+		return os_status;
+	struct rtos_deque *deque = dq_id;
+
+	/* Check for reset in progress */
+	uint32_t flags = osEventFlagsGet(&deque->events);
+	if (flags & (RTOS_DEQUE_RESET | osFlagsError)) {
+		if (flags & RTOS_DEQUE_RESET)
+			return osErrorResource;
+		return (osStatus_t)flags;
+	}
+
+	/* We are a potential waiter */
+	++deque->waiters;
+
+	/* Wait for at least one */
+	uint32_t state = spin_lock_irqsave(&deque->lock);
+	while (deque_is_empty(deque)) {
+
+		/* Exit the critical section */
+		spin_unlock_irqrestore(&deque->lock, state);
+
+		/* Wait for data */
+		flags = osEventFlagsWait(&deque->events, RTOS_DEQUE_DATA_AVAILABLE | RTOS_DEQUE_RESET, osFlagsWaitAny | osFlagsNoClear, timeout);
+		if (flags & osFlagsError) {
+			--deque->waiters;
+			return (osStatus_t)flags;
+		}
+
+		/* Clear the data available flag */
+		flags = osEventFlagsClear(&deque->events, RTOS_DEQUE_DATA_AVAILABLE);
+		if (flags & osFlagsError) {
+			--deque->waiters;
+			return (osStatus_t)flags;
+		}
+
+		/* Is a reset in progress */
+		if (flags & RTOS_DEQUE_RESET) {
+			--deque->waiters;
+			return osErrorResource;
+		}
+
+		/* Lock it up again */
+		state = spin_lock_irqsave(&deque->lock);
+	}
+
+	/* Take as many as are queued from the front */
+	size_t available = deque_count(deque);
+	if (count > available)
+		count = available;
+	deque_get_many(deque, elements, count);
+
+	/* Exit the critical section */
+	spin_unlock_irqrestore(&deque->lock, state);
+
+	/* At last */
+	--deque->waiters;
+
+	/* A single kick for the whole batch */
+	flags = osEventFlagsSet(&deque->events, RTOS_DEQUE_SPACE_AVAILABLE);
+	if (flags & osFlagsError)
+		return (osStatus_t)flags;
+
+	/* Report how many came out */
+	return count;
+}
+
 uint32_t osDequeGetCapacity(osDequeId_t dq_id)
 {
 	/* Valid in interrupt context */
@@ -535,7 +727,7 @@ uint32_t osDequeGetCount(osDequeId_t dq_id)
 		return 0;
 	struct rtos_deque *deque = dq_id;
 
-	return modulo(deque->back - deque->front, deque->element_count);
+	return deque_count(deque);
 }
 
 uint32_t osDequeGetSpace(osDequeId_t dq_id)
@@ -546,7 +738,7 @@ uint32_t osDequeGetSpace(osDequeId_t dq_id)
 		return 0;
 	struct rtos_deque *deque = dq_id;
 
-	return modulo(deque->front - (deque->back + 1), deque->element_count);
+	return deque_space(deque);
 }
 
 osStatus_t osDequeReset(osDequeId_t dq_id)
@@ -63,7 +63,8 @@ osEventFlagsId_t osEventFlagsNew(const osEventFlagsAttr_t *attr)
 	new_eventflags->attr_bits = attr->attr_bits | (new_eventflags != attr->cb_mem ? osDynamicAlloc : 0);
 	new_eventflags->flags = 0;
 	new_eventflags->waiters = 0;
-	scheduler_futex_init(&new_eventflags->futex, (long *)&new_eventflags->flags, 0);
+	scheduler_futex_init(&new_eventflags->futex, (long *)&new_eventflags->flags, SCHEDULER_FUTEX_CONTENTION_TRACKING);
+	osPollHeadInit(&new_eventflags->pollers);
 	list_init(&new_eventflags->resource_node);
 
 	/* Add the new eventflags to the resource list */
@@ -110,15 +111,23 @@ uint32_t osEventFlagsSet(osEventFlagsId_t ef_id, uint32_t flags)
 		return osFlagsErrorParameter;
 	struct rtos_eventflags *eventflags = ef_id;
 
-	/* Run the algo */
-	uint32_t prev_flags = atomic_fetch_or(&eventflags->flags, flags);
+	/* Run the algo, the flags sit above the waiter bit maintained by the kernel */
+	uint32_t prev_value = atomic_fetch_or(&eventflags->flags, flags << RTOS_EVENTFLAGS_SHIFT);
+	uint32_t prev_flags = prev_value >> RTOS_EVENTFLAGS_SHIFT;
 	if ((prev_flags & flags) != flags) {
-		int status = scheduler_futex_wake(&eventflags->futex, true);
-		if (status < 0)
-			return osFlagsError;
+
+		/* Only enter the kernel when someone is sleeping */
+		if (prev_value & SCHEDULER_FUTEX_CONTENTION_TRACKING) {
+			int status = scheduler_futex_wake(&eventflags->futex, true);
+			if (status < 0)
+				return osFlagsError;
+		}
 		prev_flags |= flags;
 	}
 
+	/* Pollers are told about every set, a deque sets its data flag even when it is already set */
+	osPollNotify(&eventflags->pollers);
+
 	/* Return the current flags */
 	return prev_flags;
 }
@@ -135,8 +144,8 @@ uint32_t osEventFlagsClear(osEventFlagsId_t ef_id, uint32_t flags)
 		return osFlagsErrorParameter;
 	struct rtos_eventflags *eventflags = ef_id;
 
-	/* Update the flags and return the current contents */
-	return atomic_fetch_and(&eventflags->flags, ~flags);
+	/* Update the flags and return the current contents, leaving the waiter bit alone */
+	return (uint32_t)atomic_fetch_and(&eventflags->flags, ~(flags << RTOS_EVENTFLAGS_SHIFT)) >> RTOS_EVENTFLAGS_SHIFT;
 }
 
 uint32_t osEventFlagsGet(osEventFlagsId_t ef_id)
@@ -148,7 +157,7 @@ uint32_t osEventFlagsGet(osEventFlagsId_t ef_id)
 	struct rtos_eventflags *eventflags = ef_id;
 
 	/* Return the current flags */
-	return eventflags->flags;
+	return (uint32_t)eventflags->flags >> RTOS_EVENTFLAGS_SHIFT;
 }
 
 uint32_t osEventFlagsWait(osEventFlagsId_t ef_id, uint32_t flags, uint32_t options, uint32_t timeout)
@@ -172,21 +181,22 @@ uint32_t osEventFlagsWait(osEventFlagsId_t ef_id, uint32_t flags, uint32_t optio
 	++eventflags->waiters;
 
 	/* Run the algo */
-	uint32_t clear = (options & osFlagsNoClear) ? UINT32_MAX : ~flags;
+	uint32_t clear = (options & osFlagsNoClear) ? UINT32_MAX : ~(flags << RTOS_EVENTFLAGS_SHIFT);
 	do {
 		/* Get the current flags  */
-		uint32_t prev_flags = atomic_load(&eventflags->flags);
+		uint32_t prev_value = atomic_load(&eventflags->flags);
+		uint32_t prev_flags = prev_value >> RTOS_EVENTFLAGS_SHIFT;
 
 		/* Are we done? */
 		if (options & osFlagsWaitAll) {
 			if ((prev_flags & flags) == flags) {
 				--eventflags->waiters;
-				return atomic_fetch_and(&eventflags->flags, clear);
+				return (uint32_t)atomic_fetch_and(&eventflags->flags, clear) >> RTOS_EVENTFLAGS_SHIFT;
 			}
 		} else {
 			if ((prev_flags & flags) != 0) {
 				--eventflags->waiters;
-				return atomic_fetch_and(&eventflags->flags, clear);
+				return (uint32_t)atomic_fetch_and(&eventflags->flags, clear) >> RTOS_EVENTFLAGS_SHIFT;
 			}
 		}
 
@@ -203,7 +213,7 @@ uint32_t osEventFlagsWait(osEventFlagsId_t ef_id, uint32_t flags, uint32_t optio
 		}
 
 		/* Nope wait for the flags */
-		int status = scheduler_futex_wait(&eventflags->futex, prev_flags, timeout);
+		int status = scheduler_futex_wait(&eventflags->futex, prev_value, timeout);
 		if (status < 0) {
 			--eventflags->waiters;
 			return status == -ETIMEDOUT || status == -ECANCELED ? osErrorTimeout : osError;
@@ -0,0 +1,278 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * cmsis-rtos2-executor.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <compiler.h>
+
+#include <rtos/rtos.h>
+
+#define RTOS_EXECUTOR_IDLE 0x00000001UL
+
+extern void *_rtos2_alloc(size_t size);
+extern void _rtos2_release(void *ptr);
+
+extern __weak struct rtos_executor *_rtos2_alloc_executor(uint32_t workers);
+extern __weak void _rtos2_release_executor(struct rtos_executor *executor);
+
+__weak struct rtos_executor *_rtos2_alloc_executor(uint32_t workers)
+{
+	return _rtos2_alloc(sizeof(struct rtos_executor) + workers * sizeof(osThreadId_t));
+}
+
+__weak void _rtos2_release_executor(struct rtos_executor *executor)
+{
+	_rtos2_release(executor);
+}
+
+static void osExecutorWorker(void *context)
+{
+	struct rtos_executor *executor = context;
+	struct rtos_work work;
+
+	while (true) {
+
+		/* Wait for something to do */
+		osStatus_t os_status = osDequeGetFront(executor->queue, &work, osWaitForever);
+		if (os_status != osOK)
+			abort();
+
+		/* An empty work item is the request to exit */
+		if (!work.func)
+			break;
+
+		/* Run it */
+		work.func(work.argument);
+
+		/* Let any waiters know when the last outstanding item completes */
+		if (atomic_fetch_sub(&executor->pending, 1) == 1) {
+			uint32_t flags = osEventFlagsSet(&executor->idle, RTOS_EXECUTOR_IDLE);
+			if (flags & osFlagsError)
+				abort();
+		}
+	}
+}
+
+static osStatus_t osExecutorStop(struct rtos_executor *executor, uint32_t started)
+{
+	/* Queue one exit request per worker behind any outstanding work */
+	struct rtos_work work = { .func = 0, .argument = 0 };
+	for (uint32_t i = 0; i < started; ++i) {
+		osStatus_t os_status = osDequePutBack(executor->queue, &work, osWaitForever);
+		if (os_status != osOK)
+			return os_status;
+	}
+
+	/* The workers are joinable, wait for them to drain */
+	for (uint32_t i = 0; i < started; ++i) {
+		osStatus_t os_status = osThreadJoin(executor->workers[i]);
+		if (os_status != osOK)
+			return os_status;
+	}
+
+	/* All gone */
+	return osOK;
+}
+
+osExecutorId_t osExecutorNew(uint32_t workers, uint32_t queue_size, const osExecutorAttr_t *attr)
+{
+	const osExecutorAttr_t default_attr = { .name = "executor", .stack_size = RTOS_DEFAULT_STACK_SIZE, .priority = osPriorityNormal };
+
+	/* This would be bad */
+	osStatus_t os_status = osKernelContextIsValid(false, 0);
+	if (os_status != osOK)
+		return 0;
+
+	/* Need at least one worker and room to queue work */
+	if (workers == 0 || queue_size == 0)
+		return 0;
+
+	/* Check for attribute */
+	if (!attr)
+		attr = &default_attr;
+
+	/* Setup the executor memory and validate the size */
+	struct rtos_executor *new_executor = attr->cb_mem;
+	if (!new_executor) {
+		new_executor = _rtos2_alloc_executor(workers);
+		if (!new_executor)
+			return 0;
+	} else if (attr->cb_size < sizeof(struct rtos_executor) + workers * sizeof(osThreadId_t))
+		return 0;
+
+	/* Initialize */
+	new_executor->marker = RTOS_EXECUTOR_MARKER;
+	strncpy(new_executor->name, (attr->name == 0 ? default_attr.name : attr->name), RTOS_NAME_SIZE);
+	new_executor->name[RTOS_NAME_SIZE - 1] = 0;
+	new_executor->attr_bits = attr->attr_bits | (new_executor != attr->cb_mem ? osDynamicAlloc : 0);
+	new_executor->pending = 0;
+	new_executor->count = 0;
+
+	/* The work queue */
+	osDequeAttr_t deque_attr = { .name = new_executor->name };
+	new_executor->queue = osDequeNew(queue_size, sizeof(struct rtos_work), &deque_attr);
+	if (!new_executor->queue)
+		goto release_executor;
+
+	/* Completion tracking */
+	osEventFlagsAttr_t eventflags_attr = { .name = new_executor->name, .cb_mem = &new_executor->idle, .cb_size = sizeof(struct rtos_eventflags) };
+	if (!osEventFlagsNew(&eventflags_attr))
+		goto delete_queue;
+
+	/* Start the workers, their stacks come from the thread pools when a class fits */
+	osThreadAttr_t thread_attr = { .name = new_executor->name, .attr_bits = osThreadJoinable, .stack_size = attr->stack_size, .priority = attr->priority };
+	if (thread_attr.priority == osPriorityNone)
+		thread_attr.priority = osPriorityNormal;
+	for (; new_executor->count < workers; ++new_executor->count) {
+		new_executor->workers[new_executor->count] = osThreadNew(osExecutorWorker, new_executor, &thread_attr);
+		if (!new_executor->workers[new_executor->count])
+			goto stop_workers;
+	}
+
+	/* Ready for work */
+	return new_executor;
+
+stop_workers:
+	osExecutorStop(new_executor, new_executor->count);
+	osEventFlagsDelete(&new_executor->idle);
+
+delete_queue:
+	osDequeDelete(new_executor->queue);
+
+release_executor:
+	new_executor->marker = 0;
+	if (new_executor->attr_bits & osDynamicAlloc)
+		_rtos2_release_executor(new_executor);
+
+	return 0;
+}
+
+osStatus_t osExecutorSubmit(osExecutorId_t executor_id, osWorkFunc_t func, void *argument, uint32_t timeout)
+{
+	/* Work must be provided */
+	if (!func)
+		return osErrorParameter;
+
+	/* Interrupts may submit as long as they do not wait */
+	osStatus_t os_status = osKernelContextIsValid(true, timeout);
+	if (os_status != osOK)
+		return os_status;
+
+	/* Validate the executor */
+	os_status = osIsResourceValid(executor_id, RTOS_EXECUTOR_MARKER);
+	if (os_status != osOK)
+		return os_status;
+	struct rtos_executor *executor = executor_id;
+
+	/* Count it before it can possibly complete */
+	atomic_fetch_add(&executor->pending, 1);
+
+	/* Hand it to the workers */
+	struct rtos_work work = { .func = func, .argument = argument };
+	os_status = osDequePutBack(executor->queue, &work, timeout);
+	if (os_status != osOK) {
+
+		/* Undo the count, we might have been the last thing keeping a waiter waiting */
+		if (atomic_fetch_sub(&executor->pending, 1) == 1)
+			osEventFlagsSet(&executor->idle, RTOS_EXECUTOR_IDLE);
+		return os_status;
+	}
+
+	/* Queued */
+	return osOK;
+}
+
+osStatus_t osExecutorWait(osExecutorId_t executor_id, uint32_t timeout)
+{
+	/* This would be bad */
+	osStatus_t os_status = osKernelContextIsValid(false, 0);
+	if (os_status != osOK)
+		return os_status;
+
+	/* Validate the executor */
+	os_status = osIsResourceValid(executor_id, RTOS_EXECUTOR_MARKER);
+	if (os_status != osOK)
+		return os_status;
+	struct rtos_executor *executor = executor_id;
+
+	/* Workers waiting on themselves would never finish */
+	osThreadId_t current = osThreadGetId();
+	for (uint32_t i = 0; i < executor->count; ++i)
+		if (executor->workers[i] == current)
+			return osErrorResource;
+
+	/* Wait until nothing is outstanding, the idle flag may be stale so always recheck the count */
+	uint32_t start = osKernelGetTickCount();
+	while (atomic_load(&executor->pending) != 0) {
+
+		/* Work out how much longer we can wait */
+		uint32_t remaining = timeout;
+		if (timeout != osWaitForever) {
+			uint32_t elapsed = osKernelGetTickCount() - start;
+			if (elapsed >= timeout)
+				return timeout == 0 ? osErrorResource : osErrorTimeout;
+			remaining = timeout - elapsed;
+		}
+
+		uint32_t flags = osEventFlagsWait(&executor->idle, RTOS_EXECUTOR_IDLE, osFlagsWaitAny, remaining);
+		if ((flags & osFlagsError) && flags != osFlagsErrorTimeout && flags != osFlagsErrorResource)
+			return (osStatus_t)flags;
+	}
+
+	/* All done */
+	return osOK;
+}
+
+osStatus_t osExecutorDelete(osExecutorId_t executor_id)
+{
+	/* Validate the context */
+	osStatus_t os_status = osKernelContextIsValid(false, 0);
+	if (os_status != osOK)
+		return os_status;
+
+	/* Validate the executor */
+	os_status = osIsResourceValid(executor_id, RTOS_EXECUTOR_MARKER);
+	if (os_status != osOK)
+		return os_status;
+	struct rtos_executor *executor = executor_id;
+
+	/* A worker can not join itself */
+	osThreadId_t current = osThreadGetId();
+	for (uint32_t i = 0; i < executor->count; ++i)
+		if (executor->workers[i] == current)
+			return osErrorResource;
+
+	/* Outstanding work is run before the workers exit */
+	os_status = osExecutorStop(executor, executor->count);
+	if (os_status != osOK)
+		return os_status;
+
+	/* Clear the resource marker */
+	executor->marker = 0;
+
+	/* Release the completion event and the queue */
+	os_status = osEventFlagsDelete(&executor->idle);
+	if (os_status != osOK)
+		return os_status;
+	os_status = osDequeDelete(executor->queue);
+	if (os_status != osOK)
+		return os_status;
+
+	/* Release any memory */
+	if (executor->attr_bits & osDynamicAlloc)
+		_rtos2_release_executor(executor);
+
+	/* All good */
+	return osOK;
+}
@@ -287,6 +287,16 @@ uint32_t osKernelGetSysTimerFreq(void)
 	return SystemCoreClock;
 }
 
+uint64_t osKernelGetIdleTime(uint32_t core)
+{
+	/* Only valid for running kernels and real cores */
+	if (osKernelGetState() != osKernelRunning || core >= scheduler_num_cores())
+		return 0;
+
+	/* In timestamp microseconds */
+	return scheduler_get_idle_time(core);
+}
+
 void osCallOnce(osOnceFlagId_t once_flag, osOnceFunc_t func, void *context)
 {
 	/* All ready done */
@@ -428,7 +438,7 @@ static osStatus_t osKernelDumpResource(osResource_t resource, void *context)
 
 		case RTOS_THREAD_MARKER:
 		{
-			struct rtos_thread *thread = resource;
+			osThreadId_t thread = osThreadResourceId(resource);
 			fprintf(stdout, "thread: %p name: %s, state: %d stack available: %lu\n", thread, osThreadGetName(thread), osThreadGetState(thread), osThreadGetStackSpace(thread));
 			break;
 		}
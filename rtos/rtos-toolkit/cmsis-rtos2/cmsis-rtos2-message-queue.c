@@ -33,6 +33,119 @@ __weak void _rtos2_release_message_queue(struct rtos_message_queue *message_queu
 	_rtos2_release(message_queue);
 }
 
+static void osMessageQueuePush(struct rtos_message_queue *queue, struct rtos_message *message)
+{
+	/* Each level is a fifo, walk back from the tail past lower priorities, a level of equal priorities appends in O(1) */
+	uint32_t level = message->priority >> RTOS_MESSAGE_QUEUE_LEVEL_SHIFT;
+	struct linked_list *fifo = &queue->messages[level];
+	struct linked_list *cursor = fifo->prev;
+	while (cursor != fifo && list_entry(cursor, struct rtos_message, node)->priority < message->priority)
+		cursor = cursor->prev;
+	list_insert_after(cursor, &message->node);
+	queue->levels |= 1UL << level;
+	message->state = osMessageQueued;
+}
+
+static struct rtos_message *osMessageQueuePop(struct rtos_message_queue *queue)
+{
+	/* Nothing queued? */
+	if (queue->levels == 0)
+		return 0;
+
+	/* Front of the highest non-empty level */
+	uint32_t level = 31 - __builtin_clz(queue->levels);
+	struct rtos_message *message = list_pop_entry(&queue->messages[level], struct rtos_message, node);
+	if (list_is_empty(&queue->messages[level]))
+		queue->levels &= ~(1UL << level);
+	message->state = osMessageReceived;
+
+	return message;
+}
+
+static struct rtos_message *osMessageQueueAllocMessage(struct rtos_message_queue *queue, uint32_t timeout)
+{
+	/* Allocate a message from the pool */
+	struct rtos_message *message = osMemoryPoolAlloc(&queue->message_pool, timeout);
+	if (message) {
+		list_init(&message->node);
+		message->state = osMessageAllocated;
+	}
+	return message;
+}
+
+static osStatus_t osMessageQueueFreeMessage(struct rtos_message_queue *queue, struct rtos_message *message)
+{
+	/* Mark free first so a stale pointer can not be committed or released again */
+	message->state = osMessageFree;
+	return osMemoryPoolFree(&queue->message_pool, message);
+}
+
+static osStatus_t osMessageQueueCommitMessage(struct rtos_message_queue *queue, struct rtos_message *message, uint8_t msg_prio)
+{
+	/* Only an allocated message can be queued, anything else is a double commit or a received message */
+	uint32_t state = spin_lock_irqsave(&queue->lock);
+	if (message->state != osMessageAllocated) {
+		spin_unlock_irqrestore(&queue->lock, state);
+		return osErrorParameter;
+	}
+
+	/* Insert in the correct priority position */
+	message->priority = msg_prio;
+	osMessageQueuePush(queue, message);
+	spin_unlock_irqrestore(&queue->lock, state);
+
+	/* Kick the semaphore */
+	osStatus_t os_status = osSemaphoreRelease(&queue->data_available);
+	if (os_status != osOK) {
+
+		/* Remove the message */
+		state = spin_lock_irqsave(&queue->lock);
+		list_remove(&message->node);
+		uint32_t level = msg_prio >> RTOS_MESSAGE_QUEUE_LEVEL_SHIFT;
+		if (list_is_empty(&queue->messages[level]))
+			queue->levels &= ~(1UL << level);
+		spin_unlock_irqrestore(&queue->lock, state);
+
+		/* Ignore the pool error if any */
+		osMessageQueueFreeMessage(queue, message);
+	}
+
+	/* Maybe good */
+	return os_status;
+}
+
+static struct rtos_message *osMessageQueueReceiveMessage(struct rtos_message_queue *queue, uint32_t timeout, osStatus_t *os_status)
+{
+	/* Acquire a message token */
+	*os_status = osSemaphoreAcquire(&queue->data_available, timeout);
+	if (*os_status != osOK) {
+		*os_status = timeout == 0 ? osErrorResource : osErrorTimeout;
+		return 0;
+	}
+
+	/* Remove the highest priority message */
+	uint32_t state = spin_lock_irqsave(&queue->lock);
+	struct rtos_message *message = osMessageQueuePop(queue);
+	spin_unlock_irqrestore(&queue->lock, state);
+
+	/* Was there a sync error? */
+	if (!message)
+		*os_status = osError;
+
+	return message;
+}
+
+static struct rtos_message *osMessageQueueMessage(struct rtos_message_queue *queue, void *msg_ptr)
+{
+	/* Map the caller's buffer back to the pool block */
+	if (!msg_ptr)
+		return 0;
+	struct rtos_message *message = container_of(msg_ptr, struct rtos_message, data);
+	if (osMemoryPoolIsBlockValid(&queue->message_pool, message) != osOK)
+		return 0;
+	return message;
+}
+
 osMessageQueueId_t osMessageQueueNew(uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t *attr)
 {
 	const osMessageQueueAttr_t default_attr = { .name = "" };
@@ -87,11 +200,16 @@ osMessageQueueId_t osMessageQueueNew(uint32_t msg_count, uint32_t msg_size, cons
 	new_queue->name[RTOS_NAME_SIZE - 1] = 0;
 	new_queue->msg_size = msg_size;
 	new_queue->msg_count = msg_count;
-	list_init(&new_queue->messages);
+	new_queue->levels = 0;
+	for (uint32_t level = 0; level < RTOS_MESSAGE_QUEUE_LEVELS; ++level)
+		list_init(&new_queue->messages[level]);
 	new_queue->lock = 0;
 
-	/* Initialize the message pool */
-	osMemoryPoolAttr_t pool_attr = { .name = new_queue->name, .cb_mem = &new_queue->message_pool, .cb_size = sizeof(struct rtos_memory_pool), .mp_mem = pool_data, .mp_size = pool_size };
+	/* Every message starts out free, the pool only links through the first word so the state survives in free blocks */
+	memset(pool_data, 0, pool_size);
+
+	/* Initialize the message pool, uncached since messages usually cross cores and the put must see every free slot */
+	osMemoryPoolAttr_t pool_attr = { .name = new_queue->name, .attr_bits = osMemoryPoolUncached, .cb_mem = &new_queue->message_pool, .cb_size = sizeof(struct rtos_memory_pool), .mp_mem = pool_data, .mp_size = pool_size };
 	if (!osMemoryPoolNew(new_queue->msg_count, sizeof(struct rtos_message) + msg_size, &pool_attr))
 		goto delete_queue;
 
@@ -156,45 +274,52 @@ osStatus_t osMessageQueuePut(osMessageQueueId_t mq_id, const void *msg_ptr, uint
 	struct rtos_message_queue *queue = mq_id;
 
 	/* Allocate a message from the pool */
-	struct rtos_message *message = osMemoryPoolAlloc(&queue->message_pool, timeout);
+	struct rtos_message *message = osMessageQueueAllocMessage(queue, timeout);
 	if (!message)
 		return timeout == 0 ? osErrorResource : osErrorTimeout;
 
-	/* Load up the message */
-	list_init(&message->node);
-	message->priority = msg_prio;
+	/* Load up the message and queue it */
 	memcpy(message->data, msg_ptr, queue->msg_size);
+	return osMessageQueueCommitMessage(queue, message, msg_prio);
+}
 
-	/* Insert in the correct priority position */
-	uint32_t state = spin_lock_irqsave(&queue->lock);
-	struct rtos_message *current;
-	list_for_each_entry(current, &queue->messages, node)
-		if (message->priority > current->priority)
-			break;
-	list_insert_before(&current->node, &message->node);
-	spin_unlock_irqrestore(&queue->lock, state);
+osStatus_t osMessageQueueGet(osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *msg_prio, uint32_t timeout)
+{
+	/* Make sure a message was provided */
+	if (!msg_ptr)
+		return osErrorParameter;
 
-	/* Kick the semaphore */
-	os_status = osSemaphoreRelease(&queue->data_available);
-	if (os_status != osOK) {
+	/* This would be bad */
+	osStatus_t os_status = osKernelContextIsValid(true, timeout);
+	if (os_status != osOK)
+		return os_status;
 
-		/* Remove the message */
-		state = spin_lock_irqsave(&queue->lock);
-		list_remove(&message->node);
-		spin_unlock_irqrestore(&queue->lock, state);
+	/* Validate the message queue */
+	os_status = osIsResourceValid(mq_id, RTOS_MESSAGE_QUEUE_MARKER);
+	if (os_status != osOK)
+		return os_status;
+	struct rtos_message_queue *queue = mq_id;
 
-		/* Ignore the pool error if any */
-		osMemoryPoolFree(&queue->message_pool, message);
-	}
+	/* Get the highest priority message */
+	struct rtos_message *message = osMessageQueueReceiveMessage(queue, timeout, &os_status);
+	if (!message)
+		return os_status;
 
-	/* Maybe good */
-	return os_status;
+	/* Hand back the message */
+	memcpy(msg_ptr, message->data, queue->msg_size);
+	if (msg_prio)
+		*msg_prio = message->priority & 0xff;
+
+	/* Release the message with much joy */
+	return osMessageQueueFreeMessage(queue, message);
 }
 
-osStatus_t osMessageQueueGet(osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *msg_prio, uint32_t timeout)
+int32_t osMessageQueuePutMany(osMessageQueueId_t mq_id, const void *msg_ptrs, uint32_t count, uint8_t msg_prio, uint32_t timeout)
 {
-	/* Make sure a message was provided */
-	if (!msg_ptr)
+	struct linked_list batch;
+
+	/* Make sure the messages were provided */
+	if (!msg_ptrs || count == 0)
 		return osErrorParameter;
 
 	/* This would be bad */
@@ -208,26 +333,182 @@ osStatus_t osMessageQueueGet(osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *m
 		return os_status;
 	struct rtos_message_queue *queue = mq_id;
 
-	/* Acquire a message token */
-	os_status = osSemaphoreAcquire(&queue->data_available, timeout);
+	/* Wait for the first message only, then take whatever else the pool has */
+	list_init(&batch);
+	uint32_t loaded = 0;
+	while (loaded < count) {
+		struct rtos_message *message = osMessageQueueAllocMessage(queue, loaded == 0 ? timeout : 0);
+		if (!message)
+			break;
+		memcpy(message->data, msg_ptrs + (loaded * queue->msg_size), queue->msg_size);
+		message->priority = msg_prio;
+		list_add(&batch, &message->node);
+		++loaded;
+	}
+	if (loaded == 0)
+		return timeout == 0 ? osErrorResource : osErrorTimeout;
+
+	/* Queue the whole batch under one lock */
+	uint32_t state = spin_lock_irqsave(&queue->lock);
+	struct rtos_message *message;
+	while ((message = list_pop_entry(&batch, struct rtos_message, node)) != 0)
+		osMessageQueuePush(queue, message);
+	spin_unlock_irqrestore(&queue->lock, state);
+
+	/* One kick for the batch, can not overflow as every queued message holds a pool block */
+	os_status = osSemaphoreReleaseMany(&queue->data_available, loaded);
 	if (os_status != osOK)
+		return os_status;
+
+	/* Report how many went in */
+	return loaded;
+}
+
+int32_t osMessageQueueGetMany(osMessageQueueId_t mq_id, void *msg_ptrs, uint8_t *msg_prios, uint32_t count, uint32_t timeout)
+{
+	struct linked_list batch;
+
+	/* Make sure the buffers were provided */
+	if (!msg_ptrs || count == 0)
+		return osErrorParameter;
+
+	/* This would be bad */
+	osStatus_t os_status = osKernelContextIsValid(true, timeout);
+	if (os_status != osOK)
+		return os_status;
+
+	/* Validate the message queue */
+	os_status = osIsResourceValid(mq_id, RTOS_MESSAGE_QUEUE_MARKER);
+	if (os_status != osOK)
+		return os_status;
+	struct rtos_message_queue *queue = mq_id;
+
+	/* Take up to count tokens in one go, waiting only for the first */
+	int32_t taken = osSemaphoreAcquireMany(&queue->data_available, count, timeout);
+	if (taken < 0)
 		return timeout == 0 ? osErrorResource : osErrorTimeout;
 
-	/* Remove the highest priority message */
+	/* Remove the highest priority messages under one lock */
+	list_init(&batch);
 	uint32_t state = spin_lock_irqsave(&queue->lock);
-	struct rtos_message *message = list_pop_entry(&queue->messages, struct rtos_message, node);
+	for (int32_t i = 0; i < taken; ++i) {
+		struct rtos_message *message = osMessageQueuePop(queue);
+		if (!message)
+			break;
+		list_add(&batch, &message->node);
+	}
 	spin_unlock_irqrestore(&queue->lock, state);
 
+	/* Hand back the messages in priority order and release them */
+	int32_t received = 0;
+	struct rtos_message *message;
+	while ((message = list_pop_entry(&batch, struct rtos_message, node)) != 0) {
+		memcpy(msg_ptrs + (received * queue->msg_size), message->data, queue->msg_size);
+		if (msg_prios)
+			msg_prios[received] = message->priority & 0xff;
+		osMessageQueueFreeMessage(queue, message);
+		++received;
+	}
+
 	/* Was there a sync error? */
-	if (!message)
+	if (received != taken)
 		return osError;
 
-	/* Hand back the message */
-	memcpy(msg_ptr, message->data, queue->msg_size);
+	return received;
+}
+
+void *osMessageQueueAlloc(osMessageQueueId_t mq_id, uint32_t timeout)
+{
+	/* This would be bad */
+	osStatus_t os_status = osKernelContextIsValid(true, timeout);
+	if (os_status != osOK)
+		return 0;
+
+	/* Validate the message queue */
+	os_status = osIsResourceValid(mq_id, RTOS_MESSAGE_QUEUE_MARKER);
+	if (os_status != osOK)
+		return 0;
+	struct rtos_message_queue *queue = mq_id;
+
+	/* The caller fills in the message in place */
+	struct rtos_message *message = osMessageQueueAllocMessage(queue, timeout);
+	return message ? message->data : 0;
+}
+
+osStatus_t osMessageQueueCommit(osMessageQueueId_t mq_id, void *msg_ptr, uint8_t msg_prio)
+{
+	/* This would be bad */
+	osStatus_t os_status = osKernelContextIsValid(true, 0);
+	if (os_status != osOK)
+		return os_status;
+
+	/* Validate the message queue */
+	os_status = osIsResourceValid(mq_id, RTOS_MESSAGE_QUEUE_MARKER);
+	if (os_status != osOK)
+		return os_status;
+	struct rtos_message_queue *queue = mq_id;
+
+	/* Must be a buffer from osMessageQueueAlloc */
+	struct rtos_message *message = osMessageQueueMessage(queue, msg_ptr);
+	if (!message)
+		return osErrorParameter;
+
+	/* Queue it without copying */
+	return osMessageQueueCommitMessage(queue, message, msg_prio);
+}
+
+void *osMessageQueueReceive(osMessageQueueId_t mq_id, uint8_t *msg_prio, uint32_t timeout)
+{
+	/* This would be bad */
+	osStatus_t os_status = osKernelContextIsValid(true, timeout);
+	if (os_status != osOK)
+		return 0;
+
+	/* Validate the message queue */
+	os_status = osIsResourceValid(mq_id, RTOS_MESSAGE_QUEUE_MARKER);
+	if (os_status != osOK)
+		return 0;
+	struct rtos_message_queue *queue = mq_id;
+
+	/* Get the highest priority message */
+	struct rtos_message *message = osMessageQueueReceiveMessage(queue, timeout, &os_status);
+	if (!message)
+		return 0;
+
+	/* Hand over the message itself, the caller must release it */
 	if (msg_prio)
 		*msg_prio = message->priority & 0xff;
+	return message->data;
+}
 
-	/* Release the message with much joy */
+osStatus_t osMessageQueueRelease(osMessageQueueId_t mq_id, void *msg_ptr)
+{
+	/* This would be bad */
+	osStatus_t os_status = osKernelContextIsValid(true, 0);
+	if (os_status != osOK)
+		return os_status;
+
+	/* Validate the message queue */
+	os_status = osIsResourceValid(mq_id, RTOS_MESSAGE_QUEUE_MARKER);
+	if (os_status != osOK)
+		return os_status;
+	struct rtos_message_queue *queue = mq_id;
+
+	/* Must be a buffer from osMessageQueueReceive or an uncommitted osMessageQueueAlloc */
+	struct rtos_message *message = osMessageQueueMessage(queue, msg_ptr);
+	if (!message)
+		return osErrorParameter;
+
+	/* Only an uncommitted or received message belongs to the caller, a queued one belongs to the consumer */
+	uint32_t state = spin_lock_irqsave(&queue->lock);
+	if (message->state != osMessageAllocated && message->state != osMessageReceived) {
+		spin_unlock_irqrestore(&queue->lock, state);
+		return osErrorParameter;
+	}
+	message->state = osMessageFree;
+	spin_unlock_irqrestore(&queue->lock, state);
+
+	/* Back to the pool */
 	return osMemoryPoolFree(&queue->message_pool, message);
 }
 
@@ -310,7 +591,7 @@ osStatus_t osMessageQueueReset(osMessageQueueId_t mq_id)
 
 		/* Pop a message */
 		uint32_t state = spin_lock_irqsave(&queue->lock);
-		struct rtos_message *message = list_pop_entry(&queue->messages, struct rtos_message, node);
+		struct rtos_message *message = osMessageQueuePop(queue);
 		spin_unlock_irqrestore(&queue->lock, state);
 
 		/* Was there a sync failure */
@@ -318,7 +599,7 @@ osStatus_t osMessageQueueReset(osMessageQueueId_t mq_id)
 			return osError;
 
 		/* Return the message to the pool */
-		os_status = osMemoryPoolFree(&queue->message_pool, message);
+		os_status = osMessageQueueFreeMessage(queue, message);
 		if (os_status != osOK)
 			return os_status;
 	}
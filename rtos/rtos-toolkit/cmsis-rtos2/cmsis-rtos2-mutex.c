@@ -34,6 +34,52 @@ __weak void _rtos2_release_mutex(struct rtos_mutex *mutex)
 	_rtos2_release(mutex);
 }
 
+static bool osMutexSpin(struct rtos_mutex *mutex, long value, uint32_t ticks)
+{
+	/* Self tuning limit, allow up to twice the running average */
+	uint32_t limit = mutex->spins * 2 + 10;
+	if (limit > RTOS_MUTEX_SPIN_MAX)
+		limit = RTOS_MUTEX_SPIN_MAX;
+
+	/* Never spin past the tick budget, every tick interrupt ends a WFE so this also bounds the time */
+	uint32_t start = osKernelGetTickCount();
+	uint32_t count = 0;
+	bool locked = false;
+	while (count < limit && osKernelGetTickCount() - start < ticks) {
+
+		/* Try to grab it when free */
+		long expected = atomic_load(&mutex->value);
+		if (expected == 0) {
+			if (atomic_compare_exchange_strong(&mutex->value, &expected, value)) {
+				locked = true;
+				break;
+			}
+			continue;
+		}
+
+		/* Nobody queued ahead of us and the owner still looks like a task */
+		struct task *owner = (struct task *)(expected & ~SCHEDULER_FUTEX_CONTENTION_TRACKING);
+		if ((expected & SCHEDULER_FUTEX_CONTENTION_TRACKING) || owner->marker != SCHEDULER_TASK_MARKER)
+			break;
+
+		/* Only worth spinning while the owner is running on the other core, a changed value means a new owner so look again */
+		bool running = owner->state == TASK_RUNNING && owner->core != scheduler_current_core();
+		if (atomic_load(&mutex->value) != expected)
+			continue;
+		if (!running)
+			break;
+
+		/* The release sends an event */
+		__WFE();
+		++count;
+	}
+
+	/* Move the average toward this acquisition */
+	mutex->spins += ((int32_t)count - (int32_t)mutex->spins) / 8;
+
+	return locked;
+}
+
 osMutexId_t osMutexNew(const osMutexAttr_t *attr)
 {
 	const osMutexAttr_t default_attr = { .name = "" };
@@ -47,6 +93,13 @@ osMutexId_t osMutexNew(const osMutexAttr_t *attr)
 	if (!attr)
 		attr = &default_attr;
 
+	/* Ceiling and inheritance are competing protocols, and the ceiling must be a thread priority */
+	if (attr->attr_bits & osMutexPrioCeiling) {
+		osPriority_t ceiling = (attr->attr_bits & osMutexCeiling_Msk) >> osMutexCeiling_Pos;
+		if ((attr->attr_bits & osMutexPrioInherit) || ceiling < osPriorityIdle || ceiling >= osPriorityISR)
+			return 0;
+	}
+
 	/* Setup the mutex memory and validate the size*/
 	struct rtos_mutex *new_mutex = attr->cb_mem;
 	if (!new_mutex) {
@@ -63,6 +116,9 @@ osMutexId_t osMutexNew(const osMutexAttr_t *attr)
 	new_mutex->attr_bits = attr->attr_bits | (new_mutex != attr->cb_mem ? osDynamicAlloc : 0);
 	scheduler_futex_init(&new_mutex->futex, (long *)&new_mutex->value, (new_mutex->attr_bits & osMutexPrioInherit) ? SCHEDULER_FUTEX_PI | SCHEDULER_FUTEX_OWNER_TRACKING | SCHEDULER_FUTEX_CONTENTION_TRACKING : SCHEDULER_FUTEX_OWNER_TRACKING | SCHEDULER_FUTEX_CONTENTION_TRACKING);
 	new_mutex->count = 0;
+	new_mutex->spins = 0;
+	new_mutex->ceiling.task = 0;
+	new_mutex->ceiling.priority = osSchedulerPriority((attr->attr_bits & osMutexCeiling_Msk) >> osMutexCeiling_Pos);
 	list_init(&new_mutex->resource_node);
 
 	/* Add the new mutex to the resource list */
@@ -119,18 +175,45 @@ osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout)
 		return osOK;
 	}
 
+	/* Immediate priority ceiling, raise before taking the lock so nothing at or below the ceiling can preempt the owner */
+	struct sched_ceiling acquiring = { .priority = mutex->ceiling.priority };
+	if (mutex->attr_bits & osMutexPrioCeiling) {
+		if (((struct task *)value)->base_priority < mutex->ceiling.priority)
+			return osErrorParameter;
+		scheduler_raise_priority(&acquiring);
+	}
+
 	/* Run the lock algo */
 	long expected = 0;
 	while (!atomic_compare_exchange_strong(&mutex->value, &expected, value)) {
 
 		/* Try sematics? */
-		if (timeout == 0)
-			return osErrorResource;
+		if (timeout == 0) {
+			os_status = osErrorResource;
+			goto restore_priority;
+		}
+
+		/* Short critical sections on the other core are cheaper to wait out than to block on, the spin comes out of the timeout */
+		if (mutex->attr_bits & osMutexAdaptive) {
+			uint32_t start = osKernelGetTickCount();
+			if (osMutexSpin(mutex, value, timeout < RTOS_MUTEX_SPIN_TICKS ? timeout : RTOS_MUTEX_SPIN_TICKS))
+				break;
+			if (timeout != osWaitForever) {
+				uint32_t elapsed = osKernelGetTickCount() - start;
+				if (elapsed >= timeout) {
+					os_status = osErrorTimeout;
+					goto restore_priority;
+				}
+				timeout -= elapsed;
+			}
+		}
 
 		/* Nope wait for the lock */
 		int status = scheduler_futex_wait(&mutex->futex, expected, timeout);
-		if (status < 0)
-			return status == -ETIMEDOUT || status == -ECANCELED ? osErrorTimeout : osError;
+		if (status < 0) {
+			os_status = status == -ETIMEDOUT || status == -ECANCELED ? osErrorTimeout : osError;
+			goto restore_priority;
+		}
 
 		/* We have requested contention tracking, we might own the mutex now */
 		if (value == (long)(mutex->value & ~SCHEDULER_FUTEX_CONTENTION_TRACKING))
@@ -144,8 +227,17 @@ osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout)
 	if (mutex->attr_bits & osMutexRecursive)
 		mutex->count = 1;
 
+	/* The mutex carries the ceiling until the release, the local one only covered the acquire */
+	if (mutex->attr_bits & osMutexPrioCeiling)
+		scheduler_move_ceiling(&acquiring, &mutex->ceiling);
+
 	/* Locked */
 	return osOK;
+
+restore_priority:
+	if (mutex->attr_bits & osMutexPrioCeiling)
+		scheduler_restore_priority(&acquiring);
+	return os_status;
 }
 
 osStatus_t osMutexRelease(osMutexId_t mutex_id)
@@ -169,15 +261,27 @@ osStatus_t osMutexRelease(osMutexId_t mutex_id)
 	if ((mutex->attr_bits & osMutexRecursive) && --mutex->count > 0)
 		return osOK;
 
-	/* Hot path unlock in the non-contended case */
+	/* The next owner takes over the mutex ceiling node as soon as we unlock, keep ours in a local one */
+	struct sched_ceiling releasing = { .priority = mutex->ceiling.priority };
+	if (mutex->attr_bits & osMutexPrioCeiling)
+		scheduler_move_ceiling(&mutex->ceiling, &releasing);
+
+	/* Hot path unlock in the non-contended case, kick any spinners */
 	long expected = (long)scheduler_task();
-	if (mutex->value == expected && atomic_compare_exchange_strong(&mutex->value, &expected, 0))
-		return osOK;
+	if (mutex->value == expected && atomic_compare_exchange_strong(&mutex->value, &expected, 0)) {
+		if (mutex->attr_bits & osMutexAdaptive)
+			__SEV();
+	} else {
 
-	/* Must have been contended */
-	int status = scheduler_futex_wake(&mutex->futex, false);
-	if (status < 0)
-		return osError;
+		/* Must have been contended */
+		int status = scheduler_futex_wake(&mutex->futex, false);
+		if (status < 0)
+			return osError;
+	}
+
+	/* Drop back from the ceiling only after the unlock, this may switch to a thread we were holding off */
+	if (mutex->attr_bits & osMutexPrioCeiling)
+		scheduler_restore_priority(&releasing);
 
 	/* All good */
 	return osOK;
@@ -197,10 +301,9 @@ osStatus_t osMutexRobustRelease(osMutexId_t mutex_id, osThreadId_t owner)
 	struct rtos_mutex *mutex = mutex_id;
 
 	/* Validate the owner */
-	os_status = osIsResourceValid(owner, RTOS_THREAD_MARKER);
-	if (os_status != osOK)
-		return os_status;
-	struct rtos_thread *thread = owner;
+	struct rtos_thread *thread = osThreadResource(owner);
+	if (!thread)
+		return osErrorParameter;
 
 	/* Make sure we are the locker */
 	if (osMutexGetOwner(mutex_id) != owner)
@@ -210,10 +313,17 @@ osStatus_t osMutexRobustRelease(osMutexId_t mutex_id, osThreadId_t owner)
 	if (mutex->attr_bits & osMutexRecursive)
 		mutex->count = 0;
 
+	/* Take the ceiling off the dead owner before anyone else can hold it */
+	if ((mutex->attr_bits & osMutexPrioCeiling) && mutex->ceiling.task != 0)
+		scheduler_restore_priority(&mutex->ceiling);
+
 	/* Hot path unlock in the non-contented case */
 	long expected = (long)thread->stack;
-	if (mutex->value == expected && atomic_compare_exchange_strong(&mutex->value, &expected, 0))
+	if (mutex->value == expected && atomic_compare_exchange_strong(&mutex->value, &expected, 0)) {
+		if (mutex->attr_bits & osMutexAdaptive)
+			__SEV();
 		return osOK;
+	}
 
 	/* Must have been contended */
 	int status = scheduler_futex_wake(&mutex->futex, false);
@@ -247,8 +357,8 @@ osThreadId_t osMutexGetOwner(osMutexId_t mutex_id)
 	if (task->marker != SCHEDULER_TASK_MARKER)
 		abort();
 
-	/* Our thread is in the context */
-	return task->context;
+	/* Thread ids are the scheduler handles */
+	return (osThreadId_t)scheduler_task_handle(task);
 }
 
 osStatus_t osMutexDelete(osMutexId_t mutex_id)
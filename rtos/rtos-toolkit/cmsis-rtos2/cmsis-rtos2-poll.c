@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * cmsis-rtos2-poll.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+#include <compiler.h>
+
+#include <rtos/rtos.h>
+
+void osPollHeadInit(struct rtos_poll_head *head)
+{
+	assert(head != 0);
+
+	head->lock = 0;
+	head->sequence = 0;
+	head->notifying = 0;
+	scheduler_futex_init(&head->notify_futex, (long *)&head->notifying, SCHEDULER_FUTEX_CONTENTION_TRACKING);
+	head->generation = 0;
+	list_init(&head->waiters);
+}
+
+void osPollWake(struct rtos_poll_head *head)
+{
+	struct rtos_thread *wake[RTOS_POLL_WAKE_BATCH];
+	osWaitObject_t *entry;
+	unsigned long generation = 0;
+	bool more;
+
+	do {
+		size_t count = 0;
+		more = false;
+
+		/* Bump the poll sequence of every polling thread, collecting the sleeping ones */
+		uint32_t state = spin_lock_irqsave(&head->lock);
+		if (generation == 0)
+			generation = ++head->generation | 1;
+		list_for_each_entry(entry, &head->waiters, node) {
+
+			/* Already handled in an earlier batch */
+			if (entry->generation == generation)
+				continue;
+
+			/* Pick up the rest after waking this batch */
+			if (count == RTOS_POLL_WAKE_BATCH) {
+				more = true;
+				break;
+			}
+			entry->generation = generation;
+
+			/* The kernel keeps the contention bit set while the poller is asleep */
+			long sequence = atomic_fetch_add(&entry->thread->poll_sequence, 2);
+			if (sequence & SCHEDULER_FUTEX_CONTENTION_TRACKING)
+				wake[count++] = entry->thread;
+		}
+
+		/* Waking must be done with interrupts enabled, hold off the pollers from leaving until we are done, counted in twos to leave the contention bit alone */
+		if (count > 0)
+			atomic_fetch_add(&head->notifying, 2);
+		spin_unlock_irqrestore(&head->lock, state);
+
+		/* Each thread is woken once per batch, deferred when in an interrupt */
+		for (size_t i = 0; i < count; ++i)
+			scheduler_futex_wake(&wake[i]->poll_futex, false);
+
+		/* The last notifier out releases any poller sleeping in osWaitRemove, the kernel sets the contention bit for them */
+		if (count > 0 && atomic_fetch_sub(&head->notifying, 2) == (2 | SCHEDULER_FUTEX_CONTENTION_TRACKING))
+			scheduler_futex_wake(&head->notify_futex, true);
+
+	} while (more);
+}
+
+static struct rtos_poll_head *osWaitHead(osWaitObject_t *object)
+{
+	switch (object->type) {
+
+		case osWaitSemaphore:
+			if (osIsResourceValid(object->object, RTOS_SEMAPHORE_MARKER) != osOK)
+				return 0;
+			return &((struct rtos_semaphore *)object->object)->pollers;
+
+		case osWaitEventFlags:
+			if (osIsResourceValid(object->object, RTOS_EVENTFLAGS_MARKER) != osOK || (object->flags & osFlagsError) != 0)
+				return 0;
+			return &((struct rtos_eventflags *)object->object)->pollers;
+
+		case osWaitMessageQueue:
+			if (osIsResourceValid(object->object, RTOS_MESSAGE_QUEUE_MARKER) != osOK)
+				return 0;
+			return &((struct rtos_message_queue *)object->object)->data_available.pollers;
+
+		case osWaitDeque:
+			if (osIsResourceValid(object->object, RTOS_DEQUE_MARKER) != osOK)
+				return 0;
+			return &((struct rtos_deque *)object->object)->events.pollers;
+
+		case osWaitQueue:
+			return object->object;
+
+		default:
+			return 0;
+	}
+}
+
+static uint32_t osWaitReady(osWaitObject_t *object)
+{
+	switch (object->type) {
+
+		case osWaitSemaphore:
+			return osSemaphoreGetCount(object->object);
+
+		case osWaitEventFlags: {
+			uint32_t flags = osEventFlagsGet(object->object) & object->flags;
+			if ((object->options & osFlagsWaitAll) != 0 && flags != object->flags)
+				return 0;
+			return flags;
+		}
+
+		case osWaitMessageQueue:
+			return osMessageQueueGetCount(object->object);
+
+		case osWaitDeque:
+			return osDequeGetCount(object->object);
+
+		case osWaitQueue:
+			return atomic_load(&object->head->sequence) != object->sequence;
+
+		default:
+			return 0;
+	}
+}
+
+static void osWaitRemove(osWaitObject_t *objects, uint32_t count)
+{
+	for (uint32_t i = 0; i < count; ++i) {
+
+		/* Unlink from the source */
+		struct rtos_poll_head *head = objects[i].head;
+		uint32_t state = spin_lock_irqsave(&head->lock);
+		list_remove(&objects[i].node);
+		spin_unlock_irqrestore(&head->lock, state);
+
+		/* A notifier could still be waking our futex, it may be a lower priority thread so block until the last one is out */
+		long notifying;
+		while (((notifying = atomic_load(&head->notifying)) & ~SCHEDULER_FUTEX_CONTENTION_TRACKING) != 0)
+			scheduler_futex_wait(&head->notify_futex, notifying & ~SCHEDULER_FUTEX_CONTENTION_TRACKING, SCHEDULER_WAIT_FOREVER);
+	}
+}
+
+int32_t osWaitMultiple(osWaitObject_t *objects, uint32_t count, uint32_t timeout)
+{
+	/* Only threads can wait */
+	osStatus_t os_status = osKernelContextIsValid(false, 0);
+	if (os_status != osOK)
+		return os_status;
+	struct rtos_thread *thread = osThreadResource(osThreadGetId());
+	if (!thread)
+		return osError;
+
+	/* Validate everything before we link anything */
+	if (!objects || count == 0)
+		return osErrorParameter;
+	for (uint32_t i = 0; i < count; ++i) {
+		objects[i].head = osWaitHead(&objects[i]);
+		if (!objects[i].head)
+			return osErrorParameter;
+	}
+
+	/* Link every entry, any notification from here on bumps our poll sequence */
+	for (uint32_t i = 0; i < count; ++i) {
+		osWaitObject_t *object = &objects[i];
+		object->thread = thread;
+		object->generation = 0;
+		object->ready = 0;
+		uint32_t state = spin_lock_irqsave(&object->head->lock);
+		object->sequence = atomic_load(&object->head->sequence);
+		list_push(&object->head->waiters, &object->node);
+		spin_unlock_irqrestore(&object->head->lock, state);
+	}
+
+	uint32_t start = osKernelGetTickCount();
+	int32_t ready;
+	while (true) {
+
+		/* Snapshot the sequence before the readiness scan so a notify during the scan stops us from blocking */
+		long sequence = atomic_load(&thread->poll_sequence);
+
+		/* Level triggered, nothing is consumed */
+		ready = 0;
+		for (uint32_t i = 0; i < count; ++i) {
+			objects[i].ready = osWaitReady(&objects[i]);
+			if (objects[i].ready)
+				++ready;
+		}
+		if (ready > 0)
+			break;
+
+		/* Work out how much longer we can wait */
+		uint32_t remaining = timeout;
+		if (timeout != osWaitForever) {
+			uint32_t elapsed = osKernelGetTickCount() - start;
+			if (elapsed >= timeout) {
+				ready = timeout == 0 ? osErrorResource : osErrorTimeout;
+				break;
+			}
+			remaining = timeout - elapsed;
+		}
+
+		/* Sleep until any of the sources is notified, a changed sequence returns straight away */
+		int status = scheduler_futex_wait(&thread->poll_futex, sequence, remaining);
+		if (status < 0 && status != -ETIMEDOUT && status != -ECANCELED) {
+			ready = osError;
+			break;
+		}
+	}
+
+	/* Unlink everything */
+	osWaitRemove(objects, count);
+
+	return ready;
+}
@@ -14,6 +14,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <compiler.h>
+#include <container-of.h>
 
 #include <rtos/rtos.h>
 
@@ -33,6 +34,54 @@ __weak void _rtos2_pool_release(void *ptr)
 	_rtos2_release(ptr);
 }
 
+static uint32_t osMemoryPoolFlush(struct rtos_memory_pool *pool, struct rtos_pool_magazine *magazine, uint32_t count)
+{
+	/* Interrupts are already off on the core owning the magazine, move the top of the magazine to the shared list */
+	spin_lock(&pool->lock);
+	for (uint32_t i = 0; i < count; ++i) {
+		void **block = magazine->blocks[--magazine->count];
+		*block = pool->free_list;
+		pool->free_list = block;
+	}
+	spin_unlock(&pool->lock);
+
+	return count;
+}
+
+static void osMemoryPoolReleaseTokens(struct rtos_memory_pool *pool, uint32_t count)
+{
+	/* Flushed blocks become visible to the other cores and any waiters */
+	while (count-- > 0)
+		osSemaphoreRelease(&pool->pool_semaphore);
+}
+
+static void osMemoryPoolDrain(struct scheduler_core_call *call)
+{
+	/* Runs on the core owning the magazine with its interrupts off, the tokens are released by the caller */
+	struct rtos_pool_magazine *magazine = container_of(call, struct rtos_pool_magazine, drain);
+	atomic_fetch_add(&magazine->flushed, osMemoryPoolFlush(magazine->pool, magazine, magazine->count));
+}
+
+static void osMemoryPoolReclaim(struct rtos_memory_pool *pool)
+{
+	/* Pull every cached block back to the shared list, a magazine is only ever touched by its own core */
+	for (uint32_t core = 0; core < SystemNumCores; ++core) {
+		struct rtos_pool_magazine *magazine = &pool->magazines[core];
+		scheduler_core_call(core, &magazine->drain);
+		osMemoryPoolReleaseTokens(pool, atomic_exchange(&magazine->flushed, 0));
+	}
+}
+
+static uint32_t osMemoryPoolSpace(struct rtos_memory_pool *pool)
+{
+	/* The shared list plus whatever the cores have cached, a racy but good enough snapshot */
+	uint32_t space = osSemaphoreGetCount(&pool->pool_semaphore);
+	if (pool->attr_bits & osMemoryPoolCached)
+		for (uint32_t core = 0; core < SystemNumCores; ++core)
+			space += pool->magazines[core].count;
+	return space;
+}
+
 osMemoryPoolId_t osMemoryPoolNew (uint32_t block_count, uint32_t block_size, const osMemoryPoolAttr_t *attr)
 {
 	const osMemoryPoolAttr_t default_attr = { .name = "" };
@@ -72,6 +121,7 @@ osMemoryPoolId_t osMemoryPoolNew (uint32_t block_count, uint32_t block_size, con
 		/* Initialize the pointers */
 		new_pool = attr->cb_mem;
 		new_pool->pool_data = attr->mp_mem;
+		new_pool->attr_bits = attr->attr_bits;
 
 	/* Static memory allocation is all or nothing */
 	} else
@@ -84,6 +134,18 @@ osMemoryPoolId_t osMemoryPoolNew (uint32_t block_count, uint32_t block_size, con
 	new_pool->block_size = block_size;
 	new_pool->capacity = block_count;
 	new_pool->lock = 0;
+	new_pool->waiting = 0;
+
+	/* Per core magazines only pay off on larger pools */
+	for (uint32_t core = 0; core < SystemNumCores; ++core) {
+		new_pool->magazines[core].count = 0;
+		new_pool->magazines[core].pool = new_pool;
+		new_pool->magazines[core].drain.func = osMemoryPoolDrain;
+		new_pool->magazines[core].drain.sequence = 0;
+		new_pool->magazines[core].flushed = 0;
+	}
+	if (block_count >= RTOS_POOL_CACHE_MIN_BLOCKS && (new_pool->attr_bits & osMemoryPoolUncached) == 0)
+		new_pool->attr_bits |= osMemoryPoolCached;
 
 	/* Initialize the semaphore */
 	osSemaphoreAttr_t semaphore_attr = { .name = attr->name, .cb_mem = &new_pool->pool_semaphore, .cb_size = sizeof(struct rtos_semaphore) };
@@ -143,16 +205,61 @@ void *osMemoryPoolAlloc (osMemoryPoolId_t mp_id, uint32_t timeout)
 		return 0;
 	struct rtos_memory_pool *pool = mp_id;
 
+	/* Hot path, take a block from this core's magazine, only this core touches it so masking interrupts is enough */
+	void **block = 0;
+	if (pool->attr_bits & osMemoryPoolCached) {
+		uint32_t state = disable_interrupts();
+		struct rtos_pool_magazine *magazine = &pool->magazines[SystemCurrentCore];
+		if (magazine->count > 0)
+			block = magazine->blocks[--magazine->count];
+		enable_interrupts(state);
+		if (block)
+			return block;
+	}
+
 	/* Acquire a token from the semaphore */
-	os_status = osSemaphoreAcquire(&pool->pool_semaphore, timeout);
-	if (os_status != osOK)
-		return 0;
+	os_status = osSemaphoreAcquire(&pool->pool_semaphore, 0);
+	if (os_status != osOK) {
 
-	/* There must be a block available, get it */
-	uint32_t state = spin_lock_irqsave(&pool->lock);
-	void **block = pool->free_list;
+		/* About to fail or block, stop the frees from caching and take back the cached blocks first */
+		if (pool->attr_bits & osMemoryPoolCached) {
+			atomic_fetch_add(&pool->waiting, 1);
+			osMemoryPoolReclaim(pool);
+		}
+
+		os_status = osSemaphoreAcquire(&pool->pool_semaphore, timeout);
+
+		if (pool->attr_bits & osMemoryPoolCached)
+			atomic_fetch_sub(&pool->waiting, 1);
+
+		if (os_status != osOK)
+			return 0;
+	}
+
+	/* Take a batch to refill the magazine */
+	uint32_t taken = 1;
+	if (pool->attr_bits & osMemoryPoolCached)
+		while (taken < RTOS_POOL_MAGAZINE_BATCH && osSemaphoreAcquire(&pool->pool_semaphore, 0) == osOK)
+			++taken;
+
+	/* There must be enough blocks available, get them, extras which do not fit stay on the shared list */
+	uint32_t returned = 0;
+	uint32_t state = disable_interrupts();
+	struct rtos_pool_magazine *magazine = &pool->magazines[SystemCurrentCore];
+	spin_lock(&pool->lock);
+	block = pool->free_list;
 	pool->free_list = *block;
-	spin_unlock_irqrestore(&pool->lock, state);
+	for (uint32_t i = 1; i < taken; ++i) {
+		if (magazine->count < RTOS_POOL_MAGAZINE_SIZE) {
+			void **extra = pool->free_list;
+			pool->free_list = *extra;
+			magazine->blocks[magazine->count++] = extra;
+		} else
+			++returned;
+	}
+	spin_unlock(&pool->lock);
+	enable_interrupts(state);
+	osMemoryPoolReleaseTokens(pool, returned);
 
 	/* Should be good */
 	return block;
@@ -175,6 +282,25 @@ osStatus_t osMemoryPoolFree (osMemoryPoolId_t mp_id, void *block)
 	if (block < pool->pool_data || block > pool->pool_data + (pool->block_size * pool->capacity))
 		return osErrorParameter;
 
+	/* Hot path, cache the block on this core unless an alloc is short of blocks */
+	if (pool->attr_bits & osMemoryPoolCached) {
+		uint32_t flushed = 0;
+		uint32_t state = disable_interrupts();
+		struct rtos_pool_magazine *magazine = &pool->magazines[SystemCurrentCore];
+
+		/* Checked with interrupts off, a reclaim following the waiting increment drains us only after this block is cached */
+		if (pool->waiting == 0) {
+			if (magazine->count == RTOS_POOL_MAGAZINE_SIZE)
+				flushed = osMemoryPoolFlush(pool, magazine, RTOS_POOL_MAGAZINE_BATCH);
+			magazine->blocks[magazine->count++] = block;
+			block = 0;
+		}
+		enable_interrupts(state);
+		osMemoryPoolReleaseTokens(pool, flushed);
+		if (!block)
+			return osOK;
+	}
+
 	/* Add the block to the free list */
 	uint32_t state = spin_lock_irqsave(&pool->lock);
 	*(void **)block = pool->free_list;
@@ -241,7 +367,7 @@ uint32_t osMemoryPoolGetCount (osMemoryPoolId_t mp_id)
 	struct rtos_memory_pool *pool = mp_id;
 
 	/* Return it */
-	return pool->capacity - osSemaphoreGetCount(&pool->pool_semaphore);
+	return pool->capacity - osMemoryPoolSpace(pool);
 }
 
 uint32_t osMemoryPoolGetSpace (osMemoryPoolId_t mp_id)
@@ -258,7 +384,7 @@ uint32_t osMemoryPoolGetSpace (osMemoryPoolId_t mp_id)
 	struct rtos_memory_pool *pool = mp_id;
 
 	/* Return it */
-	return osSemaphoreGetCount(&pool->pool_semaphore);
+	return osMemoryPoolSpace(pool);
 }
 
 osStatus_t osMemoryPoolIsBlockValid(osMemoryPoolId_t mp_id, void *block)
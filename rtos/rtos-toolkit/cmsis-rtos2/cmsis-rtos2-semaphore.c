@@ -47,6 +47,10 @@ osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const
 	if (!attr)
 		attr = &default_attr;
 
+	/* The count shares the value with the waiter bit */
+	if (max_count > RTOS_SEMAPHORE_MAX_COUNT || initial_count > max_count)
+		return 0;
+
 	/* Setup the semaphore memory and validate the size*/
 	struct rtos_semaphore *new_semaphore = attr->cb_mem;
 	if (!new_semaphore) {
@@ -62,8 +66,9 @@ osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const
 	new_semaphore->name[RTOS_NAME_SIZE - 1] = 0;
 	new_semaphore->attr_bits = attr->attr_bits | (new_semaphore != attr->cb_mem ? osDynamicAlloc : 0);
 	new_semaphore->max_count = max_count;
-	new_semaphore->value = initial_count;
-	scheduler_futex_init(&new_semaphore->futex, (long *)&new_semaphore->value, 0);
+	new_semaphore->value = initial_count << RTOS_SEMAPHORE_COUNT_SHIFT;
+	scheduler_futex_init(&new_semaphore->futex, (long *)&new_semaphore->value, SCHEDULER_FUTEX_CONTENTION_TRACKING);
+	osPollHeadInit(&new_semaphore->pollers);
 	list_init(&new_semaphore->resource_node);
 
 	/* Add the new semaphore to the resource list */
@@ -111,27 +116,28 @@ osStatus_t osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout)
 		return os_status;
 	struct rtos_semaphore *semaphore = semaphore_id;
 
-	/* Run the acquire algo, this is tricky, the happy path does 2 compare exchanges,
-	 * The first checks to zero and the second decrements the counter, the whole thing
-	 * depends on the how expected is handled */
-	uint32_t expected = 1;
-	while (!atomic_compare_exchange_weak(&semaphore->value, &expected, expected - 1)) {
+	/* Run the acquire algo, the waiter bit is carried through the decrement and is only ever set by the kernel */
+	uint32_t expected = atomic_load(&semaphore->value);
+	while (true) {
 
-		/* No resources */
-		if (expected == 0) {
+		/* Take a token if there is one */
+		if ((expected >> RTOS_SEMAPHORE_COUNT_SHIFT) > 0) {
+			if (atomic_compare_exchange_weak(&semaphore->value, &expected, expected - (1UL << RTOS_SEMAPHORE_COUNT_SHIFT)))
+				break;
+			continue;
+		}
 
-			/* If try semantics, we are done */
-			if (timeout == 0)
-				return osErrorResource;
+		/* If try semantics, we are done */
+		if (timeout == 0)
+			return osErrorResource;
 
-			/* We need to wait */
-			int status = scheduler_futex_wait(&semaphore->futex, 0, timeout);
-			if (status < 0)
-				return status == -ETIMEDOUT || status == -ECANCELED ? osErrorTimeout : osError;
+		/* We need to wait, the kernel marks the value as contended while we sleep */
+		int status = scheduler_futex_wait(&semaphore->futex, expected, timeout);
+		if (status < 0)
+			return status == -ETIMEDOUT || status == -ECANCELED ? osErrorTimeout : osError;
 
-			/* Try again */
-			expected = 1;
-		}
+		/* Try again */
+		expected = atomic_load(&semaphore->value);
 	}
 
 	/* Got a token */
@@ -151,16 +157,93 @@ osStatus_t osSemaphoreRelease(osSemaphoreId_t semaphore_id)
 		return os_status;
 	struct rtos_semaphore *semaphore = semaphore_id;
 
-	/* Already at the max count? */
-	if (semaphore->value >= semaphore->max_count)
-		return osErrorResource;
+	/* Run the algo, respecting the max count */
+	uint32_t expected = atomic_load(&semaphore->value);
+	do {
+		if ((expected >> RTOS_SEMAPHORE_COUNT_SHIFT) >= semaphore->max_count)
+			return osErrorResource;
+	} while (!atomic_compare_exchange_weak(&semaphore->value, &expected, expected + (1UL << RTOS_SEMAPHORE_COUNT_SHIFT)));
 
-	/* Run the algo */
-    if (atomic_fetch_add(&semaphore->value, 1) == 0)
+	/* Only enter the kernel when someone is sleeping */
+	if (expected & SCHEDULER_FUTEX_CONTENTION_TRACKING)
 		scheduler_futex_wake(&semaphore->futex, false);
 
-    /* Looks good */
-    return osOK;
+	/* Let any osWaitMultiple callers know */
+	osPollNotify(&semaphore->pollers);
+
+	/* Looks good */
+	return osOK;
+}
+
+int32_t osSemaphoreAcquireMany(osSemaphoreId_t semaphore_id, uint32_t count, uint32_t timeout)
+{
+	/* Validate the context */
+	osStatus_t os_status = osKernelContextIsValid(true, timeout);
+	if (os_status != osOK)
+		return os_status;
+
+	/* Validate the semaphore */
+	os_status = osIsResourceValid(semaphore_id, RTOS_SEMAPHORE_MARKER);
+	if (os_status != osOK || count == 0)
+		return osErrorParameter;
+	struct rtos_semaphore *semaphore = semaphore_id;
+
+	/* Same as the single acquire but takes up to count tokens in one update */
+	uint32_t expected = atomic_load(&semaphore->value);
+	while (true) {
+
+		/* Take what is there */
+		uint32_t available = expected >> RTOS_SEMAPHORE_COUNT_SHIFT;
+		if (available > 0) {
+			uint32_t taken = available < count ? available : count;
+			if (atomic_compare_exchange_weak(&semaphore->value, &expected, expected - (taken << RTOS_SEMAPHORE_COUNT_SHIFT)))
+				return taken;
+			continue;
+		}
+
+		/* If try semantics, we are done */
+		if (timeout == 0)
+			return osErrorResource;
+
+		/* We need to wait, the kernel marks the value as contended while we sleep */
+		int status = scheduler_futex_wait(&semaphore->futex, expected, timeout);
+		if (status < 0)
+			return status == -ETIMEDOUT || status == -ECANCELED ? osErrorTimeout : osError;
+
+		/* Try again */
+		expected = atomic_load(&semaphore->value);
+	}
+}
+
+osStatus_t osSemaphoreReleaseMany(osSemaphoreId_t semaphore_id, uint32_t count)
+{
+	/* Validate the context */
+	osStatus_t os_status = osKernelContextIsValid(true, 0);
+	if (os_status != osOK)
+		return os_status;
+
+	/* Validate the semaphore */
+	os_status = osIsResourceValid(semaphore_id, RTOS_SEMAPHORE_MARKER);
+	if (os_status != osOK || count == 0)
+		return osErrorParameter;
+	struct rtos_semaphore *semaphore = semaphore_id;
+
+	/* All or nothing, respecting the max count */
+	uint32_t expected = atomic_load(&semaphore->value);
+	do {
+		if (count > semaphore->max_count - (expected >> RTOS_SEMAPHORE_COUNT_SHIFT))
+			return osErrorResource;
+	} while (!atomic_compare_exchange_weak(&semaphore->value, &expected, expected + (count << RTOS_SEMAPHORE_COUNT_SHIFT)));
+
+	/* A single kernel entry for the whole batch, everyone is woken when there is more than one token */
+	if (expected & SCHEDULER_FUTEX_CONTENTION_TRACKING)
+		scheduler_futex_wake(&semaphore->futex, count > 1);
+
+	/* Let any osWaitMultiple callers know */
+	osPollNotify(&semaphore->pollers);
+
+	/* Looks good */
+	return osOK;
 }
 
 uint32_t osSemaphoreGetCount(osSemaphoreId_t semaphore_id)
@@ -176,8 +259,8 @@ uint32_t osSemaphoreGetCount(osSemaphoreId_t semaphore_id)
 		return 0;
 	struct rtos_semaphore *semaphore = semaphore_id;
 
-	/* Return the name */
-	return semaphore->value;
+	/* Return the count */
+	return semaphore->value >> RTOS_SEMAPHORE_COUNT_SHIFT;
 }
 
 osStatus_t osSemaphoreDelete(osSemaphoreId_t semaphore_id)
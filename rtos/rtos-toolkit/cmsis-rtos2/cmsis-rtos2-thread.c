@@ -52,6 +52,13 @@ const size_t osThreadMinimumStackSize = sizeof(struct task) + (size_t)&__tls_siz
 static osThreadId_t reaper_thread = 0;
 static osOnceFlag_t reaper_thread_init = osOnceFlagsInit;
 
+static struct rtos_thread_pool thread_pools[] =
+{
+	{ .stack_size = RTOS_THREAD_POOL_SMALL_STACK, .capacity = RTOS_THREAD_POOL_SMALL_COUNT },
+	{ .stack_size = RTOS_THREAD_POOL_LARGE_STACK, .capacity = RTOS_THREAD_POOL_LARGE_COUNT },
+};
+static osOnceFlag_t thread_pools_init = osOnceFlagsInit;
+
 __weak struct rtos_thread *_rtos2_alloc_thread(size_t stack_size)
 {
 	/* Calculate the required size needed to provide the request stack size and make it a multiple of 8 bytes */
@@ -71,6 +78,106 @@ __weak void _rtos2_thread_stack_overflow(struct rtos_thread *thread)
 	fprintf(stderr, "stack overflow: %s %p\n", thread->name, thread);
 }
 
+static void osThreadPoolInit(osOnceFlagId_t flag_id, void *context)
+{
+	for (size_t i = 0; i < sizeof(thread_pools) / sizeof(thread_pools[0]); ++i) {
+		struct rtos_thread_pool *pool = &thread_pools[i];
+
+		list_init(&pool->free_list);
+		if (pool->capacity == 0)
+			continue;
+
+		/* Carve the whole class in one allocation, an empty class just falls back to dynamic allocation */
+		pool->slot_size = (sizeof(struct rtos_thread) + osThreadMinimumStackSize + pool->stack_size + 7) & ~7UL;
+		pool->slots = _rtos2_alloc(pool->slot_size * pool->capacity);
+		if (!pool->slots) {
+			pool->capacity = 0;
+			continue;
+		}
+
+		/* The stack markers are written on first use */
+		for (size_t slot = 0; slot < pool->capacity; ++slot) {
+			struct rtos_thread *thread = (struct rtos_thread *)(pool->slots + slot * pool->slot_size);
+			thread->marker = 0;
+			thread->name[RTOS_NAME_SIZE - 1] = 0;
+			thread->pool = pool;
+			thread->stack_watermark = 0;
+			list_init(&thread->resource_node);
+			list_push(&pool->free_list, &thread->resource_node);
+		}
+		pool->available = pool->capacity;
+	}
+}
+
+static struct rtos_thread *osThreadPoolAlloc(size_t stack_size)
+{
+	/* Carve the pools on first use */
+	osCallOnce(&thread_pools_init, osThreadPoolInit, 0);
+
+	/* Take the first slot large enough, moving up a class when one is exhausted */
+	for (size_t i = 0; i < sizeof(thread_pools) / sizeof(thread_pools[0]); ++i) {
+		struct rtos_thread_pool *pool = &thread_pools[i];
+		if (pool->capacity == 0 || pool->stack_size < stack_size)
+			continue;
+
+		uint32_t state = spin_lock_irqsave(&pool->lock);
+		struct rtos_thread *thread = list_pop_entry(&pool->free_list, struct rtos_thread, resource_node);
+		if (thread)
+			--pool->available;
+		else
+			++pool->misses;
+		spin_unlock_irqrestore(&pool->lock, state);
+
+		if (thread)
+			return thread;
+	}
+
+	/* Nothing suitable */
+	return 0;
+}
+
+static void osThreadPoolMark(struct rtos_thread *thread, size_t stack_size)
+{
+	/* Only the part of the stack dirtied by the last user needs the markers written again */
+	unsigned long *pos = thread->stack_watermark ? thread->stack_watermark : thread->stack;
+	unsigned long *end = thread->stack + stack_size;
+	while (pos < end)
+		*pos++ = SCHEDULER_STACK_MARKER;
+
+	/* All clean */
+	thread->stack_watermark = end;
+}
+
+static void osThreadPoolRelease(struct rtos_thread *thread)
+{
+	struct rtos_thread_pool *pool = thread->pool;
+
+	/* Find the deepest point the stack reached, a cleared watermark means the thread never ran and the slot must be fully marked */
+	if (thread->stack_watermark) {
+		struct task *task = thread->stack;
+		unsigned long *pos = task->stack_marker;
+		unsigned long *end = thread->stack + osThreadMinimumStackSize + pool->stack_size;
+		while (pos < end && *pos == SCHEDULER_STACK_MARKER)
+			++pos;
+		thread->stack_watermark = pos;
+	}
+
+	/* Back in the pool */
+	uint32_t state = spin_lock_irqsave(&pool->lock);
+	list_push(&pool->free_list, &thread->resource_node);
+	++pool->available;
+	spin_unlock_irqrestore(&pool->lock, state);
+}
+
+static void osThreadRelease(struct rtos_thread *thread)
+{
+	/* Are we managing the memory? */
+	if (thread->attr_bits & osThreadPooled)
+		osThreadPoolRelease(thread);
+	else if (thread->attr_bits & osDynamicAlloc)
+		_rtos2_release_thread(thread);
+}
+
 static osStatus_t osCaptureOwnedRobustMutexes(const osResource_t resource, void *context)
 {
 	/* Make sure we can work correctly */
@@ -183,7 +290,7 @@ static void osThreadReaper(void *context)
 				while ((thread = list_pop_entry(&reap_list, struct rtos_thread, resource_node)) != 0) {
 
 					/* Release any owned robust mutexes */
-					os_status = osReleaseRobustMutex(thread);
+					os_status = osReleaseRobustMutex(osThreadResourceId(thread));
 					if (os_status != osOK)
 						abort();
 
@@ -197,12 +304,12 @@ static void osThreadReaper(void *context)
 					if (os_status != osOK)
 						abort();
 
-					/* Clear the marker */
+					/* Clear the marker and retire the id */
 					thread->marker = 0;
+					scheduler_release_handle(thread->stack);
 
-					/* Are we managing the memory? */
-					if (thread->attr_bits & osDynamicAlloc)
-						_rtos2_release_thread(thread);
+					/* Return the memory */
+					osThreadRelease(thread);
 				}
 			}
 		}
@@ -268,6 +375,36 @@ static void osSchedulerTaskExitHandler(struct task *task)
 		abort();
 }
 
+static struct rtos_thread *osThreadCurrent(void)
+{
+	/* Only tasks started by osThreadNew are threads */
+	struct task *task = scheduler_task();
+	if (!task || task->exit_handler != osSchedulerTaskExitHandler)
+		return 0;
+	return task->context;
+}
+
+struct rtos_thread *osThreadResource(osThreadId_t thread_id)
+{
+	/* Resolve through the scheduler handle table, the id of a released thread fails even when its memory is reused */
+	struct task *task = scheduler_task_lookup((unsigned long)thread_id);
+	if (!task || task->exit_handler != osSchedulerTaskExitHandler)
+		return 0;
+
+	/* Reaped threads have the marker cleared */
+	if (osIsResourceValid(task->context, RTOS_THREAD_MARKER) != osOK)
+		return 0;
+
+	return task->context;
+}
+
+osThreadId_t osThreadResourceId(struct rtos_thread *thread)
+{
+	assert(thread != 0);
+
+	return (osThreadId_t)scheduler_task_handle(thread->stack);
+}
+
 osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr_t *attr)
 {
 	const osThreadAttr_t default_attr = { .stack_size = RTOS_DEFAULT_STACK_SIZE, .priority = osPriorityNormal };
@@ -294,18 +431,35 @@ osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr
 	size_t stack_size = 0;
 	if (!attr->cb_mem && !attr->stack_mem) {
 
-		/* We will need more room on the stack for book keeping */
-		stack_size = osThreadMinimumStackSize + (attr->stack_size == 0 ? RTOS_DEFAULT_STACK_SIZE : attr->stack_size);
+		/* Try the thread pools first, the stack is pre-carved and mostly marked */
+		size_t requested_size = attr->stack_size == 0 ? RTOS_DEFAULT_STACK_SIZE : attr->stack_size;
+		new_thread = osThreadPoolAlloc(requested_size);
+		if (new_thread) {
 
-		/* Dynamic allocation */
-		new_thread = _rtos2_alloc_thread(stack_size);
-		if (!new_thread)
-			return 0;
+			/* Use the whole of the slot */
+			stack_size = osThreadMinimumStackSize + new_thread->pool->stack_size;
+			new_thread->stack = new_thread->stack_area;
+			new_thread->stack_size = new_thread->pool->stack_size;
+			new_thread->attr_bits = attr->attr_bits | osDynamicAlloc | osThreadPooled;
 
-		/* Initialize the pointers */
-		new_thread->stack = new_thread->stack_area;
-		new_thread->stack_size = attr->stack_size == 0 ? RTOS_DEFAULT_STACK_SIZE : attr->stack_size;
-		new_thread->attr_bits = attr->attr_bits | osDynamicAlloc;
+			/* Refresh the stack markers the last user dirtied */
+			osThreadPoolMark(new_thread, stack_size);
+
+		} else {
+
+			/* We will need more room on the stack for book keeping */
+			stack_size = osThreadMinimumStackSize + requested_size;
+
+			/* Dynamic allocation */
+			new_thread = _rtos2_alloc_thread(stack_size);
+			if (!new_thread)
+				return 0;
+
+			/* Initialize the pointers */
+			new_thread->stack = new_thread->stack_area;
+			new_thread->stack_size = requested_size;
+			new_thread->attr_bits = (attr->attr_bits & ~osThreadPooled) | osDynamicAlloc;
+		}
 
 	/* Static allocation */
 	} else if (attr->cb_mem && attr->stack_mem) {
@@ -321,7 +475,7 @@ osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr
 		new_thread = attr->cb_mem;
 		new_thread->stack = attr->stack_mem;
 		new_thread->stack_size = attr->stack_size;
-		new_thread->attr_bits = attr->attr_bits;
+		new_thread->attr_bits = attr->attr_bits & ~osThreadPooled;
 
 	/* Static memory allocation is all or nothing */
 	} else
@@ -334,6 +488,10 @@ osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr
 	new_thread->context = argument;
 	list_init(&new_thread->resource_node);
 
+	/* Initialized the osWaitMultiple futex */
+	new_thread->poll_sequence = 0;
+	scheduler_futex_init(&new_thread->poll_futex, (long *)&new_thread->poll_sequence, SCHEDULER_FUTEX_CONTENTION_TRACKING);
+
 	/* Initialized the the thread flags */
 	osEventFlagsAttr_t eventflags_attr = { .name = attr->name, .cb_mem = &new_thread->flags, .cb_size = sizeof(struct rtos_eventflags) };
 	if (!osEventFlagsNew(&eventflags_attr))
@@ -349,8 +507,13 @@ osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr
 	desc.entry_point = osSchedulerTaskEntryPoint;
 	desc.exit_handler = osSchedulerTaskExitHandler;
 	desc.context = new_thread;
-	desc.flags = SCHEDULER_TASK_STACK_CHECK | ((attr->attr_bits & osThreadCreateSuspended) ? SCHEDULER_CREATE_SUSPENDED : 0);
+	desc.flags = SCHEDULER_TASK_STACK_CHECK | SCHEDULER_RETAIN_HANDLE | ((attr->attr_bits & osThreadCreateSuspended) ? SCHEDULER_CREATE_SUSPENDED : 0);
+	desc.flags |= (new_thread->attr_bits & osThreadPooled) ? SCHEDULER_STACK_PREMARKED : 0;
 	desc.priority = osSchedulerPriority(attr->priority == osPriorityNone ? osPriorityNormal : attr->priority);
+	desc.quantum = (attr->attr_bits & osThreadQuantum_Msk) >> osThreadQuantum_Pos;
+	desc.period = 0;
+	desc.deadline = 0;
+	desc.budget = 0;
 
 	/* Add it to the kernel thread resource list */
 	os_status = osKernelResourceAdd(osResourceThread, &new_thread->resource_node);
@@ -358,11 +521,12 @@ osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr
 		goto delete_joiner;
 
 	/* Launch the thread, the entry point handler will complete the initialization */
-	if (!scheduler_create(new_thread->stack, stack_size, &desc))
+	struct task *task = scheduler_create(new_thread->stack, stack_size, &desc);
+	if (!task)
 		goto remove_resource;
 
-	/* Joy */
-	return new_thread;
+	/* Joy, the id is the scheduler handle so it goes stale when the memory is reused */
+	return (osThreadId_t)scheduler_task_handle(task);
 
 remove_resource:
 	osKernelResourceRemove(osResourceThread, &new_thread->resource_node);
@@ -374,8 +538,8 @@ delete_flags:
 	osEventFlagsDelete(&new_thread->flags);
 
 delete_thread:
-	if (new_thread->attr_bits & osDynamicAlloc)
-		_rtos2_release_thread(new_thread);
+	new_thread->stack_watermark = 0;
+	osThreadRelease(new_thread);
 
 	/* The big fail */
 	return 0;
@@ -384,8 +548,7 @@ delete_thread:
 const char *osThreadGetName(osThreadId_t thread_id)
 {
 	/* Check the thread id is provided */
-	struct rtos_thread *thread = (struct rtos_thread *)thread_id;
-	if (!thread)
+	if (!thread_id)
 		return 0;
 
 	/* This would be bad */
@@ -394,21 +557,21 @@ const char *osThreadGetName(osThreadId_t thread_id)
 		return 0;
 
 	/* Validate the thread */
-	os_status = osIsResourceValid(thread_id, RTOS_THREAD_MARKER);
-	if (os_status != osOK)
+	struct rtos_thread *thread = osThreadResource(thread_id);
+	if (!thread)
 		return 0;
 
-
 	/* Return the name */
 	return thread->name[0] == 0 ? 0 : thread->name;
 }
 
 osThreadId_t osThreadGetId(void)
 {
-	osThreadId_t id = scheduler_task()->context;
-	if (osIsResourceValid(id, RTOS_THREAD_MARKER) != osOK)
+	/* Only tasks started by osThreadNew are threads */
+	struct task *task = scheduler_task();
+	if (!task || task->exit_handler != osSchedulerTaskExitHandler)
 		return 0;
-	return id;
+	return (osThreadId_t)scheduler_task_handle(task);
 }
 
 osThreadState_t osThreadGetState(osThreadId_t thread_id)
@@ -419,11 +582,10 @@ osThreadState_t osThreadGetState(osThreadId_t thread_id)
 		return osThreadError;
 
 	/* Validate the thread */
-	os_status = osIsResourceValid(thread_id, RTOS_THREAD_MARKER);
-	if (os_status != osOK)
+	struct rtos_thread *thread = osThreadResource(thread_id);
+	if (!thread)
 		return osThreadError;
 
-	struct rtos_thread *thread = thread_id;
 	if (thread->attr_bits & osReapThread)
 		return osThreadError;
 
@@ -456,15 +618,65 @@ uint32_t osThreadGetStackSize(osThreadId_t thread_id)
 		return 0;
 
 	/* Validate the thread */
-	os_status = osIsResourceValid(thread_id, RTOS_THREAD_MARKER);
-	if (os_status != osOK)
+	struct rtos_thread *thread = osThreadResource(thread_id);
+	if (!thread)
 		return 0;
-	struct rtos_thread *thread = thread_id;
 
 	/* Looks ok */
 	return thread->stack_size;
 }
 
+osStatus_t osThreadGetStats(osThreadId_t thread_id, osThreadStats_t *stats)
+{
+	/* Check the parameters */
+	if (!stats)
+		return osErrorParameter;
+
+	/* This would be bad */
+	osStatus_t os_status = osKernelContextIsValid(false, 0);
+	if (os_status != osOK)
+		return os_status;
+
+	/* Validate the thread */
+	struct rtos_thread *thread = osThreadResource(thread_id);
+	if (!thread)
+		return osErrorParameter;
+
+	/* Get the scheduler view */
+	struct task_stats task_stats;
+	if (scheduler_get_task_stats(thread->stack, &task_stats) < 0)
+		return osError;
+
+	/* And convert */
+	stats->run_time = task_stats.run_time;
+	stats->switches = task_stats.switches;
+	stats->preemptions = task_stats.preemptions;
+	stats->futex_waits = task_stats.futex_waits;
+
+	return osOK;
+}
+
+osStatus_t osThreadPoolGetInfo(uint32_t index, osThreadPoolInfo_t *info)
+{
+	/* Check the parameters */
+	if (!info || index >= sizeof(thread_pools) / sizeof(thread_pools[0]))
+		return osErrorParameter;
+
+	/* Make sure the pools are carved */
+	osCallOnce(&thread_pools_init, osThreadPoolInit, 0);
+
+	/* Snapshot the class */
+	struct rtos_thread_pool *pool = &thread_pools[index];
+	uint32_t state = spin_lock_irqsave(&pool->lock);
+	info->stack_size = pool->stack_size;
+	info->capacity = pool->capacity;
+	info->available = pool->available;
+	info->misses = pool->misses;
+	spin_unlock_irqrestore(&pool->lock, state);
+
+	return osOK;
+}
+
 uint32_t osThreadGetStackSpace(osThreadId_t thread_id)
 {
 	/* This would be bad */
@@ -473,10 +685,9 @@ uint32_t osThreadGetStackSpace(osThreadId_t thread_id)
 		return 0;
 
 	/* Validate the thread */
-	os_status = osIsResourceValid(thread_id, RTOS_THREAD_MARKER);
-	if (os_status != osOK)
+	struct rtos_thread *thread = osThreadResource(thread_id);
+	if (!thread)
 		return 0;
-	struct rtos_thread *thread = thread_id;
 	struct task *task = thread->stack;
 
 	/* Lock the kernel so we the thread does not change */
@@ -506,13 +717,12 @@ osStatus_t osThreadSetPriority(osThreadId_t thread_id, osPriority_t priority)
 		return osErrorISR;
 
 	/* Validate the thread */
-	os_status = osIsResourceValid(thread_id, RTOS_THREAD_MARKER);
-	if (os_status != osOK)
-		return os_status;
-	struct rtos_thread *thread = thread_id;
+	struct rtos_thread *thread = osThreadResource(thread_id);
+	if (!thread)
+		return osErrorParameter;
 
-	/* Forward */
-	int status = scheduler_set_priority(thread->stack, osSchedulerPriority(priority));
+	/* Forward the id, the scheduler checks it again under the kernel lock */
+	int status = scheduler_set_priority((unsigned long)thread_id, osSchedulerPriority(priority));
 	if (status < 0)
 		return osError;
 
@@ -528,13 +738,15 @@ osPriority_t osThreadGetPriority(osThreadId_t thread_id)
 		return osPriorityError;
 
 	/* Validate the thread */
-	os_status = osIsResourceValid(thread_id, RTOS_THREAD_MARKER);
-	if (os_status != osOK)
+	struct rtos_thread *thread = osThreadResource(thread_id);
+	if (!thread)
 		return osPriorityError;
-	struct rtos_thread *thread = thread_id;
 
-	/* Return the mapped priority */
-	return osKernelPriority(scheduler_get_priority(thread->stack));
+	/* Return the mapped priority, the thread may have gone since the check */
+	unsigned long priority = scheduler_get_priority((unsigned long)thread_id);
+	if (priority == UINT32_MAX)
+		return osPriorityError;
+	return osKernelPriority(priority);
 }
 
 osStatus_t osThreadYield(void)
@@ -545,9 +757,8 @@ osStatus_t osThreadYield(void)
 		return os_status;
 
 	/* Validate the thread */
-	os_status = osIsResourceValid(osThreadGetId(), RTOS_THREAD_MARKER);
-	if (os_status != osOK)
-		return os_status;
+	if (!osThreadGetId())
+		return osErrorParameter;
 
 	/* Forward to the scheduler */
 	scheduler_yield();
@@ -564,10 +775,9 @@ osStatus_t osThreadSuspend(osThreadId_t thread_id)
 		return os_status;
 
 	/* Validate the thread */
-	os_status = osIsResourceValid(thread_id, RTOS_THREAD_MARKER);
-	if (os_status != osOK)
-		return os_status;
-	struct rtos_thread *thread = thread_id;
+	struct rtos_thread *thread = osThreadResource(thread_id);
+	if (!thread)
+		return osErrorParameter;
 
 	/* Check the thread state */
 	switch (osThreadGetState(thread_id)) {
@@ -584,8 +794,8 @@ osStatus_t osThreadSuspend(osThreadId_t thread_id)
 	if (thread_id == osThreadGetId() && rtos2_kernel->locked)
 		return osError;
 
-	/* Forward */
-	int status = scheduler_suspend(thread->stack);
+	/* Forward the id, the scheduler checks it again under the kernel lock */
+	int status = scheduler_suspend((unsigned long)thread_id);
 	if (status < 0)
 		return osError;
 
@@ -601,17 +811,16 @@ osStatus_t osThreadResume(osThreadId_t thread_id)
 		return os_status;
 
 	/* Validate the thread */
-	os_status = osIsResourceValid(thread_id, RTOS_THREAD_MARKER);
-	if (os_status != osOK)
-		return os_status;
-	struct rtos_thread *thread = thread_id;
+	struct rtos_thread *thread = osThreadResource(thread_id);
+	if (!thread)
+		return osErrorParameter;
 
 	/* Check the thread state */
 	if (osThreadGetState(thread_id) != osThreadBlocked)
 		return osErrorResource;
 
-	/* Forward */
-	int status = scheduler_resume(thread->stack);
+	/* Forward the id, the scheduler checks it again under the kernel lock */
+	int status = scheduler_resume((unsigned long)thread_id);
 	if (status < 0)
 		return osError;
 
@@ -627,10 +836,9 @@ osStatus_t osThreadDetach(osThreadId_t thread_id)
 		return os_status;
 
 	/* Validate the thread */
-	os_status = osIsResourceValid(thread_id, RTOS_THREAD_MARKER);
-	if (os_status != osOK)
-		return os_status;
-	struct rtos_thread *thread = thread_id;
+	struct rtos_thread *thread = osThreadResource(thread_id);
+	if (!thread)
+		return osErrorParameter;
 
 	/* Make sure the thread is not already detached */
 	if ((thread->attr_bits & osThreadJoinable) == 0)
@@ -660,18 +868,16 @@ void osThreadExit(void)
 		abort();
 
 	/* As well as this */
-	osThreadId_t id = osThreadGetId();
-	os_status = osIsResourceValid(id, RTOS_THREAD_MARKER);
-	if (os_status != osOK)
+	struct rtos_thread *thread = osThreadCurrent();
+	if (!thread)
 		abort();
-	struct rtos_thread *thread = id;
 
 	/* Initialize the thread reaper if needed  */
 	if ((thread->attr_bits & osThreadJoinable) == 0)
 		osCallOnce(&reaper_thread_init, osThreadReaperInit, 0);
 
 	/* Tell the scheduler to evict the task, cleaning happens on the reaper thread through the scheduler task exit handler callback for via osThreadJoin */
-	scheduler_terminate(thread->stack);
+	scheduler_terminate(0);
 
 	/* We should never get here but scheduler_terminate is not __no_return */
 	abort();
@@ -684,17 +890,16 @@ osStatus_t osThreadJoin(osThreadId_t thread_id)
 	if (os_status != osOK)
 		return os_status;
 
+	/* Validate the thread */
+	struct rtos_thread *thread = osThreadResource(thread_id);
+	if (!thread)
+		return osErrorParameter;
+
 	/* Sure the thread is know to the kernel */
-	os_status = osKernelResourceIsRegistered(osResourceThread, thread_id);
+	os_status = osKernelResourceIsRegistered(osResourceThread, thread);
 	if (os_status == osErrorResource)
 		return osErrorParameter;
 
-	/* Validate the thread */
-	os_status = osIsResourceValid(thread_id, RTOS_THREAD_MARKER);
-	if (os_status != osOK)
-		return os_status;
-	struct rtos_thread *thread = thread_id;
-
 	/* Check the state */
 	if (osThreadGetState(thread_id) == osThreadError)
 		return osErrorParameter;
@@ -718,7 +923,7 @@ osStatus_t osThreadJoin(osThreadId_t thread_id)
 		return os_status;
 
 	/* Release any robust mutexes owned by the thread */
-	os_status = osReleaseRobustMutex(thread);
+	os_status = osReleaseRobustMutex(thread_id);
 	if (os_status != osOK)
 		return os_status;
 
@@ -732,12 +937,12 @@ osStatus_t osThreadJoin(osThreadId_t thread_id)
 	if (os_status != osOK)
 		return os_status;
 
-	/* Clear the marker */
+	/* Clear the marker and retire the id */
 	thread->marker = 0;
+	scheduler_release_handle(thread->stack);
 
-	/* Are we managing the memory? */
-	if (thread->attr_bits & osDynamicAlloc)
-		_rtos2_release_thread(thread);
+	/* Return the memory */
+	osThreadRelease(thread);
 
 	/* We own the terminating thread clean up */
 	return osOK;
@@ -751,17 +956,16 @@ osStatus_t osThreadTerminate(osThreadId_t thread_id)
 		return os_status;
 
 	/* Validate the thread */
-	os_status = osIsResourceValid(thread_id, RTOS_THREAD_MARKER);
-	if (os_status != osOK)
-		return os_status;
-	struct rtos_thread *thread = thread_id;
+	struct rtos_thread *thread = osThreadResource(thread_id);
+	if (!thread)
+		return osErrorParameter;
 
 	/* Initialize the thread reaper if needed */
 	if ((thread->attr_bits & osThreadJoinable) == 0)
 		osCallOnce(&reaper_thread_init, osThreadReaperInit, 0);
 
-	/* Start the thread termination */
-	int status = scheduler_terminate(thread->stack);
+	/* Start the thread termination, the scheduler checks the id again under the kernel lock */
+	int status = scheduler_terminate((unsigned long)thread_id);
 	if (status < 0) {
 
 		/* Bad error? */
@@ -784,7 +988,7 @@ static osStatus_t osCountThreads(const osResource_t resource, void *context)
 		return osError;
 
 	/* Only count active threads */
-	osThreadState_t thread_state = osThreadGetState(resource);
+	osThreadState_t thread_state = osThreadGetState(osThreadResourceId(resource));
 	if (thread_state != osThreadError)
 		*((int *)context) += 1;
 
@@ -816,8 +1020,9 @@ static osStatus_t osCaptureThreads(const osResource_t resource, void *context)
 
 	/* Update the capture */
 	struct rtos2_thread_capture *capture = context;
-	if (capture->count < capture->size && osThreadGetState(resource) != osThreadError)
-		capture->threads[capture->count++] = resource;
+	osThreadId_t thread_id = osThreadResourceId(resource);
+	if (capture->count < capture->size && osThreadGetState(thread_id) != osThreadError)
+		capture->threads[capture->count++] = thread_id;
 
 	/* Continue */
 	return osOK;
@@ -847,10 +1052,9 @@ uint32_t osThreadFlagsSet(osThreadId_t thread_id, uint32_t flags)
 		return osErrorParameter;
 
 	/* Validate the thread */
-	osStatus_t os_status = osIsResourceValid(thread_id, RTOS_THREAD_MARKER);
-	if (os_status != osOK)
-		return os_status;
-	struct rtos_thread *thread = thread_id;
+	struct rtos_thread *thread = osThreadResource(thread_id);
+	if (!thread)
+		return osErrorParameter;
 
 	/* Forward */
 	return osEventFlagsSet(&thread->flags, flags);
@@ -864,7 +1068,7 @@ uint32_t osThreadFlagsClear(uint32_t flags)
 		return os_status;
 
 	/* Always clear the current thread flags */
-	struct rtos_thread *thread = osThreadGetId();
+	struct rtos_thread *thread = osThreadCurrent();
 	if (!thread)
 		return osFlagsErrorUnknown;
 
@@ -875,7 +1079,7 @@ uint32_t osThreadFlagsClear(uint32_t flags)
 uint32_t osThreadFlagsGet(void)
 {
 	/* We always get the flags current thread */
-	struct rtos_thread *thread = osThreadGetId();
+	struct rtos_thread *thread = osThreadCurrent();
 	if (!thread)
 		return osFlagsErrorUnknown;
 
@@ -895,7 +1099,7 @@ uint32_t osThreadFlagsWait(uint32_t flags, uint32_t options, uint32_t timeout)
 		return os_status;
 
 	/* We always wait on the current thread  */
-	struct rtos_thread *thread = osThreadGetId();
+	struct rtos_thread *thread = osThreadCurrent();
 	if (!thread)
 		return osFlagsErrorUnknown;
 
@@ -13,8 +13,12 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <config.h>
 #include <compiler.h>
 
+#include <sys/swi.h>
+#include <sys/timestamp.h>
+
 #include <rtos/rtos.h>
 
 extern void *_rtos2_alloc(size_t size);
@@ -24,12 +28,22 @@ extern __weak struct rtos_timer *_rtos2_alloc_timer(void);
 extern __weak void _rtos2_release_timer(struct rtos_timer *timer);
 
 void scheduler_tick_hook(unsigned long ticks);
+unsigned long scheduler_tick_deadline_hook(void);
+
+#define RTOS_TIMER_DISPATCH 0x00000001UL
+#define RTOS_TIMER_WHEEL_MASK (RTOS_TIMER_WHEEL_SIZE - 1)
 
-static osMessageQueueId_t timer_queue;
 static osThreadId_t timer_thread;
 static osOnceFlag_t timer_thread_init = osOnceFlagsInit;
+static bool timer_swi_ready = false;
 static spinlock_t active_timers_lock = 0;
-static struct linked_list active_timers = LIST_INIT(active_timers);
+static unsigned long active_timers = 0;
+static unsigned long timer_wheel_now = 0;
+static unsigned long timer_wheel_deadline = UINT32_MAX;
+static struct linked_list timer_wheel[RTOS_TIMER_WHEEL_SIZE];
+static unsigned long timer_wheel_bitmap[RTOS_TIMER_WHEEL_SIZE / 32];
+static struct linked_list timer_dispatch = LIST_INIT(timer_dispatch);
+static struct linked_list timer_swi_dispatch = LIST_INIT(timer_swi_dispatch);
 
 __weak struct rtos_timer *_rtos2_alloc_timer(void)
 {
@@ -41,47 +55,209 @@ __weak void _rtos2_release_timer(struct rtos_timer *timer)
 	_rtos2_release(timer);
 }
 
+static void osTimerInsert(struct rtos_timer *timer)
+{
+	/* Never hash into a slot the wheel has already passed, it would wait a whole revolution */
+	if ((long)(timer->target - timer_wheel_now) <= 0)
+		timer->target = timer_wheel_now + 1;
+
+	/* Slots are unsorted, timers more than a revolution out sit in their slot until their round comes */
+	unsigned long slot = timer->target & RTOS_TIMER_WHEEL_MASK;
+	list_add(&timer_wheel[slot], &timer->node);
+	timer_wheel_bitmap[slot >> 5] |= 0x80000000UL >> (slot & 0x1f);
+	++active_timers;
+}
+
+static void osTimerRemove(struct rtos_timer *timer)
+{
+	/* Keep the bitmap of occupied slots in step */
+	unsigned long slot = timer->target & RTOS_TIMER_WHEEL_MASK;
+	list_remove(&timer->node);
+	if (list_is_empty(&timer_wheel[slot]))
+		timer_wheel_bitmap[slot >> 5] &= ~(0x80000000UL >> (slot & 0x1f));
+	--active_timers;
+}
+
+static unsigned long osTimerWheelNext(unsigned long start)
+{
+	/* Slot 0 is the MSB of the first word so count leading zeros finds the lowest occupied slot */
+	for (unsigned long i = start >> 5; i < RTOS_TIMER_WHEEL_SIZE / 32; ++i) {
+		unsigned long word = i == (start >> 5) ? timer_wheel_bitmap[i] & (0xffffffffUL >> (start & 0x1f)) : timer_wheel_bitmap[i];
+		if (word != 0)
+			return (i << 5) + __builtin_clz(word);
+	}
+
+	/* Nothing at or after start */
+	return RTOS_TIMER_WHEEL_SIZE;
+}
+
+static bool osTimerSlotIsDue(struct linked_list *slot, unsigned long tick)
+{
+	struct rtos_timer *timer;
+	list_for_each_entry(timer, slot, node)
+		if (timer->target == tick)
+			return true;
+	return false;
+}
+
+static bool osTimerExpire(struct rtos_timer *timer, unsigned long ticks)
+{
+	/* Lateness at expiry is only non zero when the tick hook ran late or slept through the target */
+	++timer->stats.expirations;
+	uint32_t late = ticks - timer->target;
+	if (late > timer->stats.late_max)
+		timer->stats.late_max = late;
+
+	/* Still waiting on the last expiry, count it rather than queue it twice */
+	if (timer->pending) {
+		++timer->stats.overruns;
+		return false;
+	}
+
+	/* Hand to the dispatcher, the queue is intrusive so it never fills up */
+	timer->pending = true;
+	timer->expired_at = timestamp_usec();
+	list_add((timer->attr_bits & osTimerSwi) ? &timer_swi_dispatch : &timer_dispatch, &timer->dispatch_node);
+	return true;
+}
+
+static void osTimerDispatch(struct linked_list *queue)
+{
+	while (true) {
+
+		/* Pop the next expired timer and account for the dispatch latency */
+		uint32_t state = spin_lock_irqsave(&active_timers_lock);
+		struct rtos_timer *timer = list_pop_entry(queue, struct rtos_timer, dispatch_node);
+		osTimerFunc_t func = 0;
+		void *argument = 0;
+		if (timer) {
+			uint32_t latency = timestamp_usec() - timer->expired_at;
+			if (timer->stats.latency_min == 0 || latency < timer->stats.latency_min)
+				timer->stats.latency_min = latency;
+			if (latency > timer->stats.latency_max)
+				timer->stats.latency_max = latency;
+			timer->stats.latency_total += latency;
+			timer->pending = false;
+			func = timer->func;
+			argument = timer->argument;
+		}
+		spin_unlock_irqrestore(&active_timers_lock, state);
+
+		/* All done? */
+		if (!timer)
+			break;
+
+		/* Run it */
+		func(argument);
+	}
+}
+
+static void osTimerSwiHandler(unsigned int swi, void *context)
+{
+	osTimerDispatch(&timer_swi_dispatch);
+}
+
 void scheduler_tick_hook(unsigned long ticks)
 {
+	bool thread_work = false;
+	bool swi_work = false;
+
 	/* Drop if not the first core in a multicore system */
 	if (scheduler_current_core() != 0)
 		return;
 
-	/* Work to do? */
-	while (!list_is_empty(&active_timers) && list_first_entry(&active_timers, struct rtos_timer, node)->target <= ticks) {
+	/* Visit every slot passed since the last tick, once round the wheel at most */
+	uint32_t state = spin_lock_irqsave(&active_timers_lock);
+	unsigned long elapsed = ticks - timer_wheel_now;
+	if (elapsed > RTOS_TIMER_WHEEL_SIZE)
+		elapsed = RTOS_TIMER_WHEEL_SIZE;
+	unsigned long first = ticks - elapsed + 1;
+	for (unsigned long i = 0; i < elapsed && active_timers > 0; ++i) {
+
+		struct linked_list *slot = &timer_wheel[(first + i) & RTOS_TIMER_WHEEL_MASK];
+		struct rtos_timer *timer;
+		struct rtos_timer *next;
+		list_for_each_entry_mutable(timer, next, slot, node) {
+
+			/* Not this round */
+			if ((long)(timer->target - ticks) > 0)
+				continue;
+
+			/* Expire it */
+			osTimerRemove(timer);
+			if (osTimerExpire(timer, ticks)) {
+				if (timer->attr_bits & osTimerSwi)
+					swi_work = true;
+				else
+					thread_work = true;
+			}
+
+			/* Periodic timers keep their phase rather than drifting with the tick they were seen on */
+			if (timer->type == osTimerPeriodic) {
+				timer->target += timer->ticks;
+				if ((long)(timer->target - ticks) <= 0)
+					timer->target = ticks + timer->ticks;
+				osTimerInsert(timer);
+			}
+		}
+	}
+	timer_wheel_now = ticks;
+	spin_unlock_irqrestore(&active_timers_lock, state);
 
-		/* Pop the expired timer */
-		struct rtos_timer *expired = list_pop_entry(&active_timers, struct rtos_timer, node);
+	/* Kick the timer thread */
+	if (thread_work)
+		osThreadFlagsSet(timer_thread, RTOS_TIMER_DISPATCH);
 
-		/* Post to timer execution thread */
-		osStatus_t os_status = osMessageQueuePut(timer_queue, &expired, 0, 0);
-		if (os_status != osErrorResource && os_status != osOK)
-			abort();
-
-		/* If periodic, add back to the list */
-		if (os_status == osErrorResource || expired->type == osTimerPeriodic) {
+	/* Short callbacks run straight from the software interrupt, hooked up on the core running the wheel */
+	if (swi_work) {
+		if (!timer_swi_ready) {
+			swi_register(RTOS_TIMER_SWI, INTERRUPT_NORMAL, osTimerSwiHandler, 0);
+			swi_enable(RTOS_TIMER_SWI);
+			timer_swi_ready = true;
+		}
+		swi_trigger(RTOS_TIMER_SWI);
+	}
+}
 
-			/* Next target, or retry is dispatch queue is full */
-			expired->target = ticks + (os_status == osErrorResource ? 0 : expired->ticks);
+unsigned long scheduler_tick_deadline_hook(void)
+{
+	/* Only the first core runs the timers */
+	if (scheduler_current_core() != 0)
+		return UINT32_MAX;
 
-			/* Insert in order */
-			struct rtos_timer *current;
-			list_for_each_entry(current, &active_timers, node)
-				if (expired->target < current->target)
-					break;
-			list_insert_before(&current->node, &expired->node);
+	/* Find the first occupied slot holding a timer due this revolution, at worst wake once per revolution */
+	unsigned long deadline = UINT32_MAX;
+	uint32_t state = spin_lock_irqsave(&active_timers_lock);
+	if (active_timers > 0) {
+		deadline = timer_wheel_now + RTOS_TIMER_WHEEL_SIZE;
+		for (unsigned long tick = timer_wheel_now + 1; (long)(deadline - tick) > 0; ++tick) {
+
+			/* Empty slots are skipped through the bitmap, wrapping round the end of the wheel */
+			unsigned long index = tick & RTOS_TIMER_WHEEL_MASK;
+			unsigned long slot = osTimerWheelNext(index);
+			if (slot == RTOS_TIMER_WHEEL_SIZE) {
+				tick += RTOS_TIMER_WHEEL_SIZE - index - 1;
+				continue;
+			}
+			tick += slot - index;
+			if ((long)(deadline - tick) <= 0)
+				break;
+
+			/* Only the timers in occupied slots are looked at */
+			if (osTimerSlotIsDue(&timer_wheel[slot], tick)) {
+				deadline = tick;
+				break;
+			}
 		}
-
-		/* Wait for next tick if timer worker thread is full */
-		if (os_status == osErrorResource)
-			break;
 	}
+	timer_wheel_deadline = deadline;
+	spin_unlock_irqrestore(&active_timers_lock, state);
+
+	return deadline;
 }
 
 static void osTimerThread(void *context)
 {
-	struct rtos_timer *timer;
-
 	/* Allow kernel to exit even if we are still running */
 	scheduler_set_flags(0, SCHEDULER_IGNORE_VIABLE);
 
@@ -89,26 +265,20 @@ static void osTimerThread(void *context)
 	while (true) {
 
 		/* Wait for work */
-		osStatus_t os_status = osMessageQueueGet(timer_queue, &timer, 0, osWaitForever);
-		if (os_status != osOK)
+		uint32_t flags = osThreadFlagsWait(RTOS_TIMER_DISPATCH, osFlagsWaitAny, osWaitForever);
+		if (flags & osFlagsError)
 			abort();
 
-		/* Null timer pointer force exit */
-		if (!timer)
-			break;
-
-		/* Dispatch */
-		timer->func(timer->argument);
+		/* Dispatch everything which has expired */
+		osTimerDispatch(&timer_dispatch);
 	}
 }
 
 static void osTimerThreadInit(osOnceFlagId_t flag_id, void *context)
 {
-	/* Create the time message queue */
-	osMessageQueueAttr_t queue_attr = { .name = "osTimerQueue" };
-	timer_queue = osMessageQueueNew(RTOS_TIMER_QUEUE_SIZE, sizeof(struct rtos_timer *), &queue_attr);
-	if (!timer_queue)
-		abort();
+	/* Empty wheel */
+	for (size_t i = 0; i < RTOS_TIMER_WHEEL_SIZE; ++i)
+		list_init(&timer_wheel[i]);
 
 	/* Create the thread thread */
 	osThreadAttr_t thread_attr = { .name = "osTimerThread", .stack_size = RTOS_DEFAULT_STACK_SIZE, .priority = osPriorityAboveNormal };
@@ -151,8 +321,11 @@ osTimerId_t osTimerNew (osTimerFunc_t func, osTimerType_t type, void *argument,
 	new_timer->type = type;
 	new_timer->func = func;
 	new_timer->argument = argument;
+	new_timer->pending = false;
+	memset(&new_timer->stats, 0, sizeof(new_timer->stats));
 	list_init(&new_timer->resource_node);
 	list_init(&new_timer->node);
+	list_init(&new_timer->dispatch_node);
 
 	/* Add the new timer to the resource list */
 	if (osKernelResourceAdd(osResourceTimer, &new_timer->resource_node) != osOK) {
@@ -206,28 +379,28 @@ osStatus_t osTimerStart (osTimerId_t timer_id, uint32_t ticks)
 	/* Start the timer thread and initialize the message if needed */
 	osCallOnce(&timer_thread_init, osTimerThreadInit, 0);
 
-	/* Set the tick time */
-	timer->ticks = ticks;
-	timer->target = osKernelGetTickCount() + ticks;
-
-	/* Carefully update the timer and add to the active list */
-	struct rtos_timer *current = 0;
+	/* Carefully update the timer, restarting a running timer */
 	uint32_t state = spin_lock_irqsave(&active_timers_lock);
+	if (list_is_linked(&timer->node))
+		osTimerRemove(timer);
 
-	/* Set the time ticks, target and ensure it is not already in the list */
+	/* Set the time ticks and target and hash into the wheel, O(1) however many timers are running */
 	timer->ticks = ticks;
 	timer->target = osKernelGetTickCount() + ticks;
-	list_remove(&timer->node);
-
-	/* Find the insertion point and insert */
-	list_for_each_entry(current, &active_timers, node)
-		if (timer->target < current->target)
-			break;
-	list_insert_before(&current->node, &timer->node);
+	osTimerInsert(timer);
+	bool earlier = timer->target < timer_wheel_deadline;
 
 	/* All good */
 	spin_unlock_irqrestore(&active_timers_lock, state);
 
+#if SCHEDULER_TICKLESS > 0
+	/* The first core may be sleeping past the new target, kick it to recompute its deadline */
+	if (scheduler_current_core() != 0 && earlier)
+		scheduler_request_switch(0);
+#else
+	(void)earlier;
+#endif
+
 	/* All good */
 	return osOK;
 }
@@ -251,7 +424,8 @@ osStatus_t osTimerStop (osTimerId_t timer_id)
 
 	/* Remove timer */
 	uint32_t state = spin_lock_irqsave(&active_timers_lock);
-	list_remove(&timer->node);
+	if (list_is_linked(&timer->node))
+		osTimerRemove(timer);
 	spin_unlock_irqrestore(&active_timers_lock, state);
 
 	/* All good */
@@ -287,10 +461,14 @@ osStatus_t osTimerDelete (osTimerId_t timer_id)
 		return os_status;
 	struct rtos_timer *timer = timer_id;
 
-	/* Stop the timer if it is running */
+	/* Stop the timer if it is running and drop any undispatched expiry */
 	uint32_t state = spin_lock_irqsave(&active_timers_lock);
 	if (list_is_linked(&timer->node))
-		list_remove(&timer->node);
+		osTimerRemove(timer);
+	if (timer->pending) {
+		list_remove(&timer->dispatch_node);
+		timer->pending = false;
+	}
 	spin_unlock_irqrestore(&active_timers_lock, state);
 
 	/* Clear the marker */
@@ -308,3 +486,23 @@ osStatus_t osTimerDelete (osTimerId_t timer_id)
 	/* Yea, yea, done */
 	return osOK;
 }
+
+osStatus_t osTimerGetStats(osTimerId_t timer_id, osTimerStats_t *stats)
+{
+	/* Make sure we have somewhere to put them */
+	if (!stats)
+		return osErrorParameter;
+
+	/* Validate the timer */
+	osStatus_t os_status = osIsResourceValid(timer_id, RTOS_TIMER_MARKER);
+	if (os_status != osOK)
+		return os_status;
+	struct rtos_timer *timer = timer_id;
+
+	/* Consistent snapshot */
+	uint32_t state = spin_lock_irqsave(&active_timers_lock);
+	*stats = timer->stats;
+	spin_unlock_irqrestore(&active_timers_lock, state);
+
+	return osOK;
+}
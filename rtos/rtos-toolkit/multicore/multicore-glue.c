@@ -11,8 +11,11 @@
  *      Author: Stephen Street (stephen@redrocketcomputing.com)
  */
 
+#include <assert.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <stdatomic.h>
 
 #include <sys/systick.h>
@@ -25,6 +28,10 @@
 
 #include <hardware/rp2040/multicore-event.h>
 
+#define SCHEDULER_CORE_CALL_EVENT 0x40000000UL
+#define SCHEDULER_CORE_CALL_Msk 0x0fffffffUL
+#define SCHEDULER_CORE_CALL_BASE 0x20000000UL
+
 extern void scheduler_startup_hook(void);
 
 void scheduler_spin_lock(void);
@@ -34,28 +41,145 @@ void scheduler_spin_unlock_irqrestore(unsigned int state);
 void init_fault(void);
 void multicore_startup_hook(void);
 void multicore_shutdown_hook(void);
+void scheduler_core_call(unsigned long core, struct scheduler_core_call *call);
 
-static spinlock_t kernel_lock = 0;
 struct async multicore_start_async;
 
-void scheduler_spin_lock()
+#if SCHEDULER_KERNEL_LOCK == SCHEDULER_KERNEL_LOCK_MCS
+static mcs_lock_t kernel_lock = 0;
+core_local struct mcs_node kernel_lock_node;
+
+static inline void kernel_lock_acquire(void)
+{
+	mcs_lock(&kernel_lock, cls_datum_ptr(kernel_lock_node));
+}
+
+static inline bool kernel_lock_try(void)
+{
+	return mcs_try_lock(&kernel_lock, cls_datum_ptr(kernel_lock_node));
+}
+
+static inline void kernel_lock_release(void)
+{
+	mcs_unlock(&kernel_lock, cls_datum_ptr(kernel_lock_node));
+}
+#elif SCHEDULER_KERNEL_LOCK == SCHEDULER_KERNEL_LOCK_HW
+/* Released at startup along with all the other hardware locks, see __atomic_init */
+static hw_spinlock_t kernel_lock = HW_SPINLOCK_KERNEL;
+
+static inline void kernel_lock_acquire(void)
+{
+	hw_spin_lock(&kernel_lock);
+}
+
+static inline bool kernel_lock_try(void)
+{
+	return hw_spin_try_lock(&kernel_lock);
+}
+
+static inline void kernel_lock_release(void)
+{
+	hw_spin_unlock(&kernel_lock);
+}
+#else
+static spinlock_t kernel_lock = 0;
+
+static inline void kernel_lock_acquire(void)
 {
 	spin_lock(&kernel_lock);
 }
 
-void scheduler_spin_unlock(void)
+static inline bool kernel_lock_try(void)
+{
+	return spin_try_lock(&kernel_lock);
+}
+
+static inline void kernel_lock_release(void)
 {
 	spin_unlock(&kernel_lock);
 }
+#endif
+
+#if SCHEDULER_LOCK_STATS > 0
+core_local struct scheduler_lock_stats lock_stats;
+core_local uint32_t lock_acquired_at;
+
+static inline unsigned long scheduler_lock_cycles(uint32_t start, uint32_t end)
+{
+	/* The SysTick counts core clocks down, anything longer than a tick period will be under reported */
+	return start >= end ? start - end : start + SysTick->LOAD + 1 - end;
+}
+
+static void scheduler_spin_lock_contended(void)
+{
+	uint32_t start = SysTick->VAL;
+	kernel_lock_acquire();
+	uint32_t end = SysTick->VAL;
+
+	/* Account for the wait */
+	struct scheduler_lock_stats *stats = cls_datum_ptr(lock_stats);
+	unsigned long wait = scheduler_lock_cycles(start, end);
+	++stats->contended;
+	stats->wait_cycles += wait;
+	if (wait > stats->max_wait_cycles)
+		stats->max_wait_cycles = wait;
+}
+
+void scheduler_get_lock_stats(unsigned long core, struct scheduler_lock_stats *stats)
+{
+	assert(core < SystemNumCores && stats != 0);
+
+	/* A snapshot is good enough */
+	memcpy(stats, cls_datum_core_ptr(core, lock_stats), sizeof(struct scheduler_lock_stats));
+}
+
+void scheduler_reset_lock_stats(void)
+{
+	for (unsigned long core = 0; core < SystemNumCores; ++core)
+		memset(cls_datum_core_ptr(core, lock_stats), 0, sizeof(struct scheduler_lock_stats));
+}
+#endif
+
+void scheduler_spin_lock()
+{
+#if SCHEDULER_LOCK_STATS > 0
+	/* Only time the wait when we have to wait for the other core */
+	if (!kernel_lock_try())
+		scheduler_spin_lock_contended();
+	++cls_datum(lock_stats).acquired;
+
+	/* Start timing the hold */
+	cls_datum(lock_acquired_at) = SysTick->VAL;
+#else
+	kernel_lock_acquire();
+#endif
+}
+
+void scheduler_spin_unlock(void)
+{
+#if SCHEDULER_LOCK_STATS > 0
+	/* Account for the hold */
+	struct scheduler_lock_stats *stats = cls_datum_ptr(lock_stats);
+	unsigned long hold = scheduler_lock_cycles(cls_datum(lock_acquired_at), SysTick->VAL);
+	stats->hold_cycles += hold;
+	if (hold > stats->max_hold_cycles)
+		stats->max_hold_cycles = hold;
+#endif
+
+	kernel_lock_release();
+}
 
 unsigned int scheduler_spin_lock_irqsave(void)
 {
-	return spin_lock_irqsave(&kernel_lock);
+	unsigned int state = disable_interrupts();
+	scheduler_spin_lock();
+	return state;
 }
 
 void scheduler_spin_unlock_irqrestore(unsigned int state)
 {
-	spin_unlock_irqrestore(&kernel_lock, state);
+	scheduler_spin_unlock();
+	enable_interrupts(state);
 }
 
 unsigned long scheduler_num_cores(void)
@@ -75,9 +199,47 @@ void scheduler_request_switch(unsigned long core)
 		return;
 	}
 
+#if SCHEDULER_LOCK_STATS > 0
+	++cls_datum(lock_stats).kicks;
+#endif
+
 	multicore_event_post(0x30000000 | (PendSV_IRQn + 16));
 }
 
+static void scheduler_core_call_handler(uint32_t event, void *context)
+{
+	/* Calls live in SRAM so the offset next to the event id is enough to find them */
+	struct scheduler_core_call *call = (struct scheduler_core_call *)(SCHEDULER_CORE_CALL_BASE | (event & SCHEDULER_CORE_CALL_Msk));
+	call->func(call);
+
+	/* Let the caller go */
+	++call->sequence;
+	__SEV();
+}
+
+void scheduler_core_call(unsigned long core, struct scheduler_core_call *call)
+{
+	assert(call != 0 && call->func != 0 && ((uintptr_t)call & ~SCHEDULER_CORE_CALL_Msk) == SCHEDULER_CORE_CALL_BASE);
+
+	/* Our own core, just mask our interrupts */
+	if (core == SystemCurrentCore) {
+		uint32_t state = disable_interrupts();
+		call->func(call);
+		++call->sequence;
+		enable_interrupts(state);
+		return;
+	}
+
+	/* Both cores calling each other with interrupts masked would never finish */
+	assert(__get_PRIMASK() == 0);
+
+	/* Interrupt the other core and wait for it to run the call */
+	unsigned long sequence = call->sequence;
+	multicore_event_post(SCHEDULER_CORE_CALL_EVENT | ((uintptr_t)call & SCHEDULER_CORE_CALL_Msk));
+	while (call->sequence == sequence)
+		__WFE();
+}
+
 static void multicore_trap(void)
 {
 	while (true);
@@ -98,6 +260,7 @@ void multicore_startup_hook(void)
 {
 	/* If we are running on the startup core, launch core 1 */
 	if (SystemCurrentCore == 0) {
+		multicore_event_register(SCHEDULER_CORE_CALL_EVENT, scheduler_core_call_handler, 0);
 		async_run(&multicore_start_async, multicore_start, 0);
 		return;
 	}
@@ -18,6 +18,8 @@
 
 #include <sys/tls.h>
 #include <sys/systick.h>
+#include <sys/periodic.h>
+#include <sys/timestamp.h>
 #include <sys/retarget-lock.h>
 
 #include <cmsis/cmsis.h>
@@ -25,6 +27,11 @@
 
 #define LIBC_LOCK_MARKER 0x89988998
 
+#define TICKLESS_USEC_PER_TICK (1000000UL / SCHEDULER_TICK_FREQ)
+#define TICKLESS_MAX_TICKS (INT32_MAX / TICKLESS_USEC_PER_TICK)
+#define TICKLESS_MIN_USEC (SCHEDULER_TICKLESS_MIN_TICKS * TICKLESS_USEC_PER_TICK)
+#define TICKLESS_ALARM_MARGIN_USEC 10L
+
 struct __rtos_runtime_lock
 {
 	struct __retarget_runtime_lock retarget_lock;
@@ -47,6 +54,11 @@ extern __weak void multicore_shutdown_hook(void);
 
 static core_local void *old_tls = { 0 };
 
+#if SCHEDULER_TICKLESS > 0
+static core_local unsigned long long tickless_start = { 0 };
+static core_local unsigned long tickless_residue = { 0 };
+#endif
+
 static struct __rtos_runtime_lock libc_recursive_mutex = { 0 };
 struct __lock __lock___libc_recursive_mutex =
 {
@@ -160,6 +172,64 @@ static void scheduler_systick_handler(void *context)
 	scheduler_tick();
 }
 
+#if SCHEDULER_TICKLESS > 0
+bool scheduler_tickless_enter(unsigned long ticks)
+{
+	/* Let a pending tick run first */
+	if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)
+		return false;
+
+	/* Keep the alarm well inside the 32 bit timer range */
+	if (ticks > TICKLESS_MAX_TICKS)
+		ticks = TICKLESS_MAX_TICKS;
+
+	/* Account for the partial tick already counted down by the systick */
+	unsigned long load = SysTick->LOAD;
+	unsigned long residue = cls_datum(tickless_residue) + (load - SysTick->VAL) * TICKLESS_USEC_PER_TICK / (load + 1);
+
+	/* The residue can eat most of two ticks, not worth stopping the tick for what is left */
+	long sleep = (long)(ticks * TICKLESS_USEC_PER_TICK) - (long)residue;
+	if (sleep < (long)TICKLESS_MIN_USEC)
+		return false;
+
+	/* Arm the core local alarm to fire on the deadline tick */
+	unsigned int channel = SCHEDULER_TICKLESS_CHANNEL + scheduler_current_core();
+	cls_datum(tickless_start) = timestamp();
+	unsigned long target = (unsigned long)cls_datum(tickless_start) + sleep;
+	if (periodic_oneshot(channel, target) < 0)
+		return false;
+
+	/* The alarm only fires on an exact match, if the target has slipped by it would not fire until the timer wraps */
+	if ((long)(target - periodic_ticks()) <= TICKLESS_ALARM_MARGIN_USEC) {
+		periodic_disable(channel);
+		return false;
+	}
+
+	/* Stop the tick, the alarm or any other interrupt will wake us */
+	SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+	cls_datum(tickless_residue) = residue;
+
+	return true;
+}
+
+unsigned long scheduler_tickless_exit(void)
+{
+	/* We may have been woken by something other than the alarm */
+	periodic_disable(SCHEDULER_TICKLESS_CHANNEL + scheduler_current_core());
+
+	/* How long were we really asleep */
+	unsigned long elapsed = (unsigned long)(timestamp() - cls_datum(tickless_start)) + cls_datum(tickless_residue);
+
+	/* Restart the tick, the partial tick is carried to the next sleep */
+	SysTick->VAL = 0;
+	SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+	cls_datum(tickless_residue) = elapsed % TICKLESS_USEC_PER_TICK;
+
+	/* Return the number of whole ticks slept */
+	return elapsed / TICKLESS_USEC_PER_TICK;
+}
+#endif
+
 void scheduler_startup_hook(void)
 {
 	/* First set the rtos system exception priority, done this way SDK does not support setting the system irq priorities */
@@ -20,6 +20,8 @@
 
 #include <sys/tls.h>
 #include <sys/svc.h>
+#include <sys/timestamp.h>
+#include <sys/trace.h>
 
 #include <cmsis/cmsis.h>
 #include <rtos/rtos-toolkit/scheduler.h>
@@ -34,13 +36,26 @@
 #define SCHEDULER_WAIT_SVC 6
 #define SCHEDULER_WAKE_SVC 7
 #define SCHEDULER_PRIORITY_SVC 8
+#define SCHEDULER_REQUEUE_SVC 9
 
 #define SCHEDULER_FRAME_NEEDED 0x00000002
 
+#define SCHEDULER_WAKE_QUEUED 0x00000001UL
+#define SCHEDULER_WAKE_ALL 0x00000002UL
+#define SCHEDULER_WAKE_CORE_SHIFT 2
+
 #define ALIGNMENT_ROUND_SIZE(SIZE, BYTES) ((SIZE + (BYTES - 1)) & ~(BYTES - 1))
 #define ALIGNMENT_ROUND_TYPE(TYPE, BYTES) ((sizeof(TYPE) + (BYTES - 1)) & ~(BYTES - 1))
 #define DELAY_MAX (UINT32_MAX / 2)
 
+struct sched_wake_ring
+{
+	atomic_ulong head;
+	unsigned long tail;
+	struct futex *volatile slots[SCHEDULER_MAX_DEFERED_WAKE];
+	struct scheduler_wake_stats stats;
+};
+
 #define sched_container_of(ptr, type, member) \
 	({ \
         const typeof(((type *)0)->member) *__mptr = (ptr); \
@@ -62,6 +77,7 @@ void scheduler_resume_svc(struct exception_frame *frame);
 void scheduler_wait_svc(struct scheduler_frame *frame);
 void scheduler_wake_svc(struct exception_frame *frame);
 void scheduler_priority_svc(struct exception_frame *frame);
+void scheduler_requeue_svc(struct exception_frame *frame);
 
 struct scheduler_frame *scheduler_switch(struct scheduler_frame *frame);
 
@@ -72,6 +88,10 @@ extern __weak void scheduler_tick_hook(unsigned long ticks);
 extern __weak void scheduler_tls_init_hook(void *tls);
 extern __weak void scheduler_startup_hook(void);
 extern __weak void scheduler_shutdown_hook(void);
+extern __weak unsigned long scheduler_tick_deadline_hook(void);
+extern __weak void scheduler_edf_overrun_hook(struct task *task, bool missed);
+extern __weak bool scheduler_tickless_enter(unsigned long ticks);
+extern __weak unsigned long scheduler_tickless_exit(void);
 
 extern __weak void scheduler_spin_lock(void);
 extern __weak void scheduler_spin_unlock(void);
@@ -89,6 +109,7 @@ uint32_t scheduler_svc_vector[] =
 	(uint32_t) scheduler_wait_svc,
 	(uint32_t) scheduler_wake_svc,
 	(uint32_t) scheduler_priority_svc,
+	(uint32_t) scheduler_requeue_svc,
 };
 
 struct scheduler *scheduler = 0;
@@ -97,9 +118,14 @@ core_local struct scheduler_frame *scheduler_initial_frame = 0;
 core_local struct task *current_task = 0;
 core_local int slice_expires = INT32_MAX;
 core_local unsigned long ticks = 0;
-core_local atomic_ulong deferred_wake[SCHEDULER_MAX_DEFERED_WAKE];
-core_local atomic_ulong taken_wake_counter = 0;
-core_local atomic_ulong given_wake_counter = 0;
+core_local struct sched_wake_ring deferred_wake;
+core_local struct sched_ready_queue ready_queue;
+#if SCHEDULER_RUNTIME_STATS > 0
+core_local unsigned long long run_start = 0;
+core_local unsigned long long idle_start = 0;
+core_local unsigned long long idle_time = 0;
+core_local bool yielding = false;
+#endif
 
 static inline void sched_list_init(struct sched_list *list)
 {
@@ -107,7 +133,7 @@ static inline void sched_list_init(struct sched_list *list)
 	list->prev = list;
 }
 
-static inline bool sched_list_empty(struct sched_list *list)
+static inline bool sched_list_empty(const struct sched_list *list)
 {
 	assert(list != 0);
 
@@ -237,20 +263,99 @@ static inline struct task *sched_set_current(struct task *task)
 	struct task *prev = cls_datum(current_task);
 	cls_datum(current_task) = task;
 
+#if SCHEDULER_RUNTIME_STATS > 0
+	/* Charge the outgoing task and start the clock on the incoming task */
+	unsigned long long now = timestamp();
+	if (prev)
+		prev->stats.run_time += now - cls_datum(run_start);
+	cls_datum(run_start) = now;
+#endif
+
 	scheduler_switch_hook(task);
 
 	return prev;
 }
 
+static inline unsigned long sched_bitmap_next(const unsigned long *bitmap, unsigned long size, unsigned long start)
+{
+	/* Index 0 is the MSB of the first word so count leading zeros finds the lowest set index */
+	for (unsigned long i = start >> 5; i < (size >> 5); ++i) {
+		unsigned long word = i == (start >> 5) ? bitmap[i] & (0xffffffffUL >> (start & 0x1f)) : bitmap[i];
+		if (word != 0)
+			return (i << 5) + __builtin_clz(word);
+	}
+
+	/* Nothing set */
+	return size;
+}
+
+static inline void sched_bitmap_set(unsigned long *bitmap, unsigned long index)
+{
+	bitmap[index >> 5] |= 0x80000000UL >> (index & 0x1f);
+}
+
+static inline void sched_bitmap_clear(unsigned long *bitmap, unsigned long index)
+{
+	bitmap[index >> 5] &= ~(0x80000000UL >> (index & 0x1f));
+}
+
+static inline bool sched_bitmap_test(const unsigned long *bitmap, unsigned long index)
+{
+	return (bitmap[index >> 5] & (0x80000000UL >> (index & 0x1f))) != 0;
+}
+
+#if SCHEDULER_BITMAP_QUEUE > 0
+static inline unsigned long sched_bitmap_first(const unsigned long *bitmap)
+{
+	/* Priority 0 is the first index */
+	return sched_bitmap_next(bitmap, SCHEDULER_NUM_TASK_PRIORITIES, 0);
+}
+
+#endif
+
+static inline struct sched_queue *sched_ready_queue(unsigned long core)
+{
+	return &cls_datum_core_ptr(core, ready_queue)->queue;
+}
+
+#if SCHEDULER_BITMAP_QUEUE > 0
+static inline struct sched_ready_queue *sched_queue_fifos(struct sched_queue *queue)
+{
+	/* Only the per core ready queues carry priority fifos, anything else is a plain sorted list */
+	return queue->ready;
+}
+#endif
+
 static inline void sched_queue_init(struct sched_queue *queue)
 {
 	assert(queue != 0);
 	sched_list_init(&queue->tasks);
+#if SCHEDULER_BITMAP_QUEUE > 0
+	queue->ready = 0;
+#endif
+}
+
+static inline void sched_ready_queue_init(struct sched_ready_queue *ready)
+{
+	assert(ready != 0);
+
+	sched_queue_init(&ready->queue);
+#if SCHEDULER_BITMAP_QUEUE > 0
+	ready->queue.ready = ready;
+	for (unsigned long i = 0; i < SCHEDULER_NUM_TASK_PRIORITIES; ++i)
+		sched_list_init(&ready->fifos[i]);
+	memset(ready->bitmap, 0, sizeof(ready->bitmap));
+#endif
 }
 
 static inline bool sched_queue_empty(struct sched_queue *queue)
 {
 	assert(queue != 0);
+#if SCHEDULER_BITMAP_QUEUE > 0
+	struct sched_ready_queue *ready = sched_queue_fifos(queue);
+	if (ready)
+		return sched_bitmap_first(ready->bitmap) == SCHEDULER_NUM_TASK_PRIORITIES;
+#endif
 	return sched_list_empty(&queue->tasks);
 }
 
@@ -259,21 +364,75 @@ static inline void sched_queue_remove(struct task *task)
 	assert(task != 0);
 
 	sched_list_remove(&task->queue_node);
+
+#if SCHEDULER_BITMAP_QUEUE > 0
+	/* Clear the priority bit if the fifo is now empty */
+	struct sched_ready_queue *ready = task->current_queue ? sched_queue_fifos(task->current_queue) : 0;
+	if (ready && sched_list_empty(&ready->fifos[task->current_priority]))
+		sched_bitmap_clear(ready->bitmap, task->current_priority);
+#endif
+
 	task->current_queue = 0;
 }
 
+#if SCHEDULER_EDF > 0
+static inline bool sched_edf_active(const struct task *task)
+{
+	/* EDF tasks with budget left run in the EDF priority band */
+	return task->edf.period != 0 && task->current_priority == SCHEDULER_EDF_PRIORITY;
+}
+
+static inline bool sched_edf_precedes(const struct task *task, const struct task *entry)
+{
+	/* Active EDF tasks go ahead of anything else at the same priority and of later deadlines */
+	return sched_edf_active(task) && entry->current_priority == task->current_priority && (!sched_edf_active(entry) || scheduler_edf_before(task->edf.absolute_deadline, entry->edf.absolute_deadline));
+}
+#endif
+
 static void sched_queue_push(struct sched_queue *queue, struct task *task)
 {
 	assert(queue != 0 && task != 0 && task->current_queue == 0);
 
+#if SCHEDULER_BITMAP_QUEUE > 0
+	/* Constant time, just add to the tail of the priority fifo */
+	struct sched_ready_queue *ready = sched_queue_fifos(queue);
+	if (ready) {
+#if SCHEDULER_EDF > 0
+		/* Except EDF tasks which are kept in deadline order */
+		if (sched_edf_active(task)) {
+			struct sched_list *node;
+			sched_list_for_each(node, &ready->fifos[task->current_priority])
+				if (sched_edf_precedes(task, sched_container_of(node, struct task, queue_node)))
+					break;
+			sched_list_insert_before(node, &task->queue_node);
+			sched_bitmap_set(ready->bitmap, task->current_priority);
+			task->current_queue = queue;
+			return;
+		}
+#endif
+		sched_list_push(&ready->fifos[task->current_priority], &task->queue_node);
+		sched_bitmap_set(ready->bitmap, task->current_priority);
+		task->current_queue = queue;
+		return;
+	}
+#endif
+
 	/* Find the insert point */
 	struct task *entry = 0;
 	struct sched_list *node;
-	sched_list_for_each(node, &queue->tasks)
-		if (sched_container_of(node, struct task, queue_node)->current_priority > task->current_priority) {
-			entry = sched_container_of(node, struct task, queue_node);;
+	sched_list_for_each(node, &queue->tasks) {
+		struct task *candidate = sched_container_of(node, struct task, queue_node);
+#if SCHEDULER_EDF > 0
+		if (sched_edf_precedes(task, candidate)) {
+			entry = candidate;
+			break;
+		}
+#endif
+		if (candidate->current_priority > task->current_priority) {
+			entry = candidate;
 			break;
 		}
+	}
 
 	/* Insert at the correct position, which might be the head */
 	if (entry)
@@ -284,37 +443,64 @@ static void sched_queue_push(struct sched_queue *queue, struct task *task)
 	task->current_queue = queue;
 }
 
-static struct task *sched_queue_pop(struct sched_queue *queue, unsigned long core)
+static struct task *sched_queue_peek(struct sched_queue *queue, unsigned long core)
 {
 	struct task *task;
 
 	assert(queue != 0);
 
-	/* Just take the first task */
-	if (core == UINT32_MAX) {
-		task = sched_list_pop_entry(&queue->tasks, struct task, queue_node);
-		if (task)
-			task->current_queue = 0;
-		return task;
+#if SCHEDULER_BITMAP_QUEUE > 0
+	struct sched_ready_queue *ready = sched_queue_fifos(queue);
+	if (ready) {
+
+		/* Work on a copy so fifos holding only tasks with affinity to another core can be skipped */
+		unsigned long bitmap[SCHEDULER_PRIORITY_WORDS];
+		memcpy(bitmap, ready->bitmap, sizeof(bitmap));
+
+		/* Look for the highest priority task which can run on this core */
+		for (unsigned long priority = sched_bitmap_first(bitmap); priority < SCHEDULER_NUM_TASK_PRIORITIES; priority = sched_bitmap_first(bitmap)) {
+			sched_list_for_each_entry(task, &ready->fifos[priority], queue_node)
+				if (core == UINT32_MAX || (task->flags & SCHEDULER_CORE_AFFINITY) == 0 || task->affinity == core)
+					return task;
+			sched_bitmap_clear(bitmap, priority);
+		}
+
+		return 0;
 	}
+#endif
 
 	/* Look for the highest priority task which can run on this core */
-	sched_list_for_each_entry(task, &queue->tasks, queue_node) {
-		if ((task->flags & SCHEDULER_CORE_AFFINITY) == 0 || task->affinity == core) {
-			sched_queue_remove(task);
+	sched_list_for_each_entry(task, &queue->tasks, queue_node)
+		if (core == UINT32_MAX || (task->flags & SCHEDULER_CORE_AFFINITY) == 0 || task->affinity == core)
 			return task;
-		}
-	}
 
 	return 0;
 }
 
+static struct task *sched_queue_pop(struct sched_queue *queue, unsigned long core)
+{
+	assert(queue != 0);
+
+	/* Find and remove the highest priority task, any core if core is UINT32_MAX */
+	struct task *task = sched_queue_peek(queue, core);
+	if (task)
+		sched_queue_remove(task);
+
+	return task;
+}
+
 static inline unsigned long sched_queue_highest_priority(struct sched_queue *queue)
 {
 	unsigned long highest = SCHEDULER_NUM_TASK_PRIORITIES;
 
 	assert(queue != 0);
 
+#if SCHEDULER_BITMAP_QUEUE > 0
+	struct sched_ready_queue *ready = sched_queue_fifos(queue);
+	if (ready)
+		return sched_bitmap_first(ready->bitmap);
+#endif
+
 	if (!sched_queue_empty(queue))
 		highest = sched_list_first_entry(&queue->tasks, struct task, queue_node)->current_priority;
 
@@ -325,12 +511,134 @@ static void sched_queue_reprioritize(struct task *task, unsigned long new_priori
 {
 	assert(task != 0);
 
-	task->current_priority = new_priority;
+	/* Must leave the queue before changing priority, the bitmap queue indexes by priority */
 	struct sched_queue *queue = task->current_queue;
-	if (queue) {
+	if (queue)
 		sched_queue_remove(task);
+	task->current_priority = new_priority;
+	if (queue)
 		sched_queue_push(queue, task);
+}
+
+static unsigned long sched_task_priority(struct task *task)
+{
+	assert(task != 0);
+
+	/* The base priority boosted by the waiters on owned PI futexes and by the ceilings still held */
+	unsigned long highest_priority = task->base_priority;
+	struct futex *owned;
+	sched_list_for_each_entry(owned, &task->owned_futexes, owned) {
+		unsigned long highest_waiter = sched_queue_highest_priority(&owned->waiters);
+		if (highest_waiter < highest_priority)
+			highest_priority = highest_waiter;
+	}
+	if (task->ceiling_priority < highest_priority)
+		highest_priority = task->ceiling_priority;
+
+	return highest_priority;
+}
+
+static void sched_task_recompute(struct task *task)
+{
+	assert(task != 0);
+
+	/* Odd while changing and bumped before reading the inputs, the owner's lockless ceiling path rechecks it */
+	++task->priority_sequence;
+	__DMB();
+	sched_queue_reprioritize(task, sched_task_priority(task));
+	__DMB();
+	++task->priority_sequence;
+}
+
+static void sched_task_boost(struct task *task, unsigned long priority)
+{
+	assert(task != 0);
+
+	/* Same protocol as the recompute, the current priority is only compared once the sequence is odd */
+	++task->priority_sequence;
+	__DMB();
+	if (priority < task->current_priority)
+		sched_queue_reprioritize(task, priority);
+	__DMB();
+	++task->priority_sequence;
+}
+
+static unsigned long sched_ready_core(struct task *task)
+{
+	assert(task != 0);
+
+	/* Pinned tasks always go to the ready queue of their core */
+	if (task->flags & SCHEDULER_CORE_AFFINITY)
+		return task->affinity;
+
+	/* The task giving up this core stays local, it will compete for the core in the coming switch */
+	if (task == cls_datum(current_task))
+		return scheduler_current_core();
+
+	/* Otherwise pick the core running the lowest priority task, an idle core counts as the lowest, ties stay local */
+	unsigned long target = scheduler_current_core();
+	struct task *running = cls_datum_core(target, current_task);
+	unsigned long lowest = running ? running->current_priority : SCHEDULER_NUM_TASK_PRIORITIES;
+	for (unsigned long core = 0; core < scheduler_num_cores() && lowest < SCHEDULER_NUM_TASK_PRIORITIES; ++core) {
+		running = cls_datum_core(core, current_task);
+		unsigned long priority = running ? running->current_priority : SCHEDULER_NUM_TASK_PRIORITIES;
+		if (priority > lowest) {
+			lowest = priority;
+			target = core;
+		}
+	}
+
+	return target;
+}
+
+static void sched_ready_push(struct task *task)
+{
+	assert(task != 0);
+
+	/* Add to the selected core ready queue */
+	unsigned long core = sched_ready_core(task);
+	sched_queue_push(sched_ready_queue(core), task);
+
+	/* Only interrupt the other core if the task should preempt whatever it is running */
+	if (core != scheduler_current_core()) {
+		struct task *running = cls_datum_core(core, current_task);
+		if (!running || task->current_priority < running->current_priority)
+			scheduler_request_switch(core);
+	}
+
+#if SCHEDULER_EDF > 0
+	/* An earlier deadline preempts a running EDF task on any core, priorities alone can not see it */
+	struct task *running = cls_datum_core(core, current_task);
+	if (running && running != task && sched_edf_precedes(task, running))
+		scheduler_request_switch(core);
+#endif
+}
+
+static struct task *sched_ready_pop(unsigned long core)
+{
+	struct sched_queue *queue = sched_ready_queue(core);
+	unsigned long highest = sched_queue_highest_priority(queue);
+
+	/* Steal a higher priority unpinned task from the other cores, this also migrates work when the local queue is empty */
+	struct task *stolen = 0;
+	for (unsigned long other = 0; other < scheduler_num_cores(); ++other) {
+		if (other != core) {
+			struct task *candidate = sched_queue_peek(sched_ready_queue(other), core);
+			if (candidate && candidate->current_priority < highest) {
+				highest = candidate->current_priority;
+				stolen = candidate;
+			}
+		}
 	}
+
+	/* Take the stolen task */
+	if (stolen) {
+		sched_queue_remove(stolen);
+		return stolen;
+	}
+
+	/* Everything on the local queue can run here */
+	return sched_queue_pop(queue, UINT32_MAX);
 }
 
 static inline __always_inline bool is_interrupt_context(void)
@@ -352,68 +660,136 @@ static inline __always_inline bool scheduler_check_stack(struct task *task)
 	return ((task->flags & SCHEDULER_TASK_STACK_CHECK) == 0) || (task->stack_marker[0] == SCHEDULER_STACK_MARKER && task->stack_marker[1] == SCHEDULER_STACK_MARKER);
 }
 
+static void scheduler_timer_remove(struct task *task);
+
 static void scheduler_timer_push(struct task *task, uint32_t delay)
 {
 	assert(task != 0);
 
 	/* Remove any existing timers */
-	sched_list_remove(&task->timer_node);
+	scheduler_timer_remove(task);
 
-	/* Initialize the timer */
+	/* Initialize the timer, a timer behind the sweep position would be missed for a whole wheel revolution */
 	task->timer_expires = scheduler_get_ticks() + delay;
+	if (task->timer_expires < scheduler->timer_position)
+		task->timer_expires = scheduler->timer_position;
 
-	/* Find the insert point */
-	struct task *entry;
-	sched_list_for_each_entry(entry, &scheduler->timers, timer_node)
-		if (entry->timer_expires > task->timer_expires)
-			break;
-
-	/* Insert at the correct position, which might be the head */
-	sched_list_insert_before(&entry->timer_node, &task->timer_node);
+	/* Hash into the wheel slot, kept in expiry order by walking back from the tail so equal expiries append in constant time */
+	unsigned long slot = task->timer_expires & (SCHEDULER_TIMER_WHEEL_SLOTS - 1);
+	struct sched_list *node = scheduler->timers[slot].prev;
+	while (node != &scheduler->timers[slot] && sched_container_of(node, struct task, timer_node)->timer_expires > task->timer_expires)
+		node = node->prev;
+	sched_list_insert_after(node, &task->timer_node);
+	sched_bitmap_set(scheduler->timer_bitmap, slot);
 
 	/* Update the new timer expire */
-	unsigned long closest = sched_list_first_entry(&scheduler->timers, struct task, timer_node)->timer_expires;
+	if (task->timer_expires < scheduler->timer_expires)
+		scheduler->timer_expires = task->timer_expires;
+}
 
-	/* Save it */
-	scheduler->timer_expires = closest;
+static void scheduler_timer_unlink(struct task *task)
+{
+	/* Remove and clear slot bit when empty */
+	sched_list_remove(&task->timer_node);
+	unsigned long slot = task->timer_expires & (SCHEDULER_TIMER_WHEEL_SLOTS - 1);
+	if (sched_list_empty(&scheduler->timers[slot]))
+		sched_bitmap_clear(scheduler->timer_bitmap, slot);
+}
+
+static unsigned long scheduler_timer_next(void)
+{
+	unsigned long closest = UINT32_MAX;
+	unsigned long position = scheduler->timer_position;
+
+	/* Walk the non-empty slots for one revolution starting at the sweep position */
+	for (unsigned long i = 0; i < SCHEDULER_TIMER_WHEEL_SLOTS; ++i) {
+
+		/* Find the next non-empty slot with wrap around */
+		unsigned long start = (position + i) & (SCHEDULER_TIMER_WHEEL_SLOTS - 1);
+		unsigned long slot = sched_bitmap_next(scheduler->timer_bitmap, SCHEDULER_TIMER_WHEEL_SLOTS, start);
+		if (slot == SCHEDULER_TIMER_WHEEL_SLOTS) {
+			slot = sched_bitmap_next(scheduler->timer_bitmap, SCHEDULER_TIMER_WHEEL_SLOTS, 0);
+			if (slot == SCHEDULER_TIMER_WHEEL_SLOTS)
+				break;
+		}
+		i += (slot - start) & (SCHEDULER_TIMER_WHEEL_SLOTS - 1);
+		if (i >= SCHEDULER_TIMER_WHEEL_SLOTS)
+			break;
+
+		/* The slot head is its earliest timer, expiring on this revolution makes it the closest */
+		unsigned long expires = sched_list_first_entry(&scheduler->timers[slot], struct task, timer_node)->timer_expires;
+		if (expires == position + i)
+			return expires;
+		if (expires < closest)
+			closest = expires;
+	}
+
+	return closest;
 }
 
 static void scheduler_timer_remove(struct task *task)
 {
 	assert(task != 0);
 
-	sched_list_remove(&task->timer_node);
-
-	/* Update the new timer expire */
-	unsigned long closest = sched_list_empty(&scheduler->timers) ? UINT_MAX : sched_list_first_entry(&scheduler->timers, struct task, timer_node)->timer_expires;
+	/* Most wake ups have no timer */
+	if (!sched_list_is_linked(&task->timer_node))
+		return;
 
-	/* Save it */
-	scheduler->timer_expires = closest;
+	/* Only removing the earliest timer moves the next expiry, keeps the tick from sweeping for nothing */
+	scheduler_timer_unlink(task);
+	if (task->timer_expires == scheduler->timer_expires)
+		scheduler->timer_expires = scheduler_timer_next();
 }
 
 static struct task *scheduler_timer_pop(void)
 {
-	struct task *task = 0;
+	unsigned long now = scheduler_get_ticks();
 
-	/* Is the timer list empty? */
-	if (!sched_list_empty(&scheduler->timers)) {
+	/* Fast check, nothing can have expired */
+	if (scheduler->timer_expires > now)
+		return 0;
 
-		/* Check for expired timer */
-		task = sched_list_first_entry(&scheduler->timers, struct task, timer_node);
-		if (task->timer_expires <= scheduler_get_ticks())
-			scheduler_timer_remove(task);
-		else
-			task = 0;
+	/* After a long gap, visiting every slot once is enough */
+	if (now >= scheduler->timer_position && now - scheduler->timer_position >= SCHEDULER_TIMER_WHEEL_SLOTS)
+		scheduler->timer_position = now - (SCHEDULER_TIMER_WHEEL_SLOTS - 1);
+
+	/* Sweep the slots up to now */
+	while (scheduler->timer_position <= now) {
+
+		/* Slots are in expiry order, only the head can have expired, entries for future revolutions stay */
+		unsigned long slot = scheduler->timer_position & (SCHEDULER_TIMER_WHEEL_SLOTS - 1);
+		if (sched_bitmap_test(scheduler->timer_bitmap, slot)) {
+			struct task *entry = sched_list_first_entry(&scheduler->timers[slot], struct task, timer_node);
+			if (entry->timer_expires <= now) {
+				scheduler_timer_unlink(entry);
+				return entry;
+			}
+		}
+
+		/* Next slot */
+		++scheduler->timer_position;
 	}
 
-	/* No expired timers */
-	return task;
+	/* Update the new timer expire */
+	scheduler->timer_expires = scheduler_timer_next();
+
+	/* No more expired timers */
+	return 0;
 }
 
 __weak unsigned long scheduler_get_ticks(void)
 {
+#if SCHEDULER_TICKLESS > 0
+	/* Sleeping cores stop counting, the most advanced core is the reference */
+	unsigned long ticks = cls_datum_core(0, ticks);
+	for (unsigned long core = 1; core < scheduler_num_cores(); ++core)
+		if (cls_datum_core(core, ticks) > ticks)
+			ticks = cls_datum_core(core, ticks);
+	return ticks;
+#else
 	/* By default we use the core 0 ticks as the reference */
 	return cls_datum_core(0, ticks);
+#endif
 }
 
 void scheduler_tick(void)
@@ -433,14 +809,73 @@ void scheduler_tick(void)
 	if (timer_expires <= ticks)
 		scheduler_request_switch(scheduler_current_core());
 
-	/* And time slice enabled and expired */
-	if (cls_datum(slice_expires) != INT32_MAX && --cls_datum(slice_expires) == 0)
+	/*
+	 * If time slicing is enabled and the slice has expired, only preempt when a task of the same or higher
+	 * priority is ready on this core, otherwise the task keeps the processor and we check again on the next
+	 * tick. The ready queue is peeked without the kernel lock, a stale read only delays the switch by a tick.
+	 */
+	if (cls_datum(slice_expires) != INT32_MAX && (cls_datum(slice_expires) <= 0 || --cls_datum(slice_expires) == 0)) {
+		struct task *current = sched_get_current();
+		if (current && sched_queue_highest_priority(sched_ready_queue(scheduler_current_core())) <= current->current_priority)
+			scheduler_request_switch(scheduler_current_core());
+	}
+
+#if SCHEDULER_EDF > 0
+	/* Charge the EDF budget, the demotion of an exhausted task happens in the switch under the kernel lock */
+	struct task *current = sched_get_current();
+	if (current && current->edf.period != 0 && scheduler_edf_charge(&current->edf)) {
+		scheduler_edf_overrun_hook(current, false);
 		scheduler_request_switch(scheduler_current_core());
+	}
+#endif
 
 	/* Pass to the hook */
 	scheduler_tick_hook(ticks);
 }
 
+static int sched_handle_alloc(struct task *task)
+{
+	/* Search on from the last slot handed out so a freed slot rests before its next generation */
+	for (unsigned long count = 0; count < SCHEDULER_MAX_TASKS; ++count) {
+		unsigned long slot = (scheduler->task_slot_hint + count) % SCHEDULER_MAX_TASKS;
+		if (scheduler->task_slots[slot] != 0)
+			continue;
+
+		/* Generation zero is never used so a handle is never zero */
+		unsigned short generation = scheduler->task_generations[slot] + 1;
+		if (generation == 0)
+			generation = 1;
+
+		scheduler->task_generations[slot] = generation;
+		scheduler->task_slots[slot] = task;
+		scheduler->task_slot_hint = slot + 1;
+		task->handle = ((unsigned long)generation << SCHEDULER_HANDLE_SLOT_BITS) | slot;
+		return 0;
+	}
+
+	/* Table is full */
+	return -EAGAIN;
+}
+
+static void sched_handle_free(struct task *task)
+{
+	/* The generation stays behind so the old handle keeps failing the lookup */
+	unsigned long slot = task->handle & SCHEDULER_HANDLE_SLOT_MASK;
+	if (slot < SCHEDULER_MAX_TASKS && scheduler->task_slots[slot] == task)
+		scheduler->task_slots[slot] = 0;
+}
+
+static struct task *sched_handle_lookup(unsigned long handle)
+{
+	/* Only the table is touched, a stale or made up handle is never dereferenced */
+	unsigned long slot = handle & SCHEDULER_HANDLE_SLOT_MASK;
+	unsigned long generation = handle >> SCHEDULER_HANDLE_SLOT_BITS;
+	if (slot >= SCHEDULER_MAX_TASKS || generation == 0 || scheduler->task_generations[slot] != generation)
+		return 0;
+
+	return scheduler->task_slots[slot];
+}
+
 void scheduler_create_svc(struct exception_frame *frame)
 {
 	assert(frame->r0 != 0 && scheduler != 0);
@@ -451,6 +886,13 @@ void scheduler_create_svc(struct exception_frame *frame)
 
 	assert(task->marker == SCHEDULER_TASK_MARKER);
 
+	/* Hand out a handle, a full table fails the create */
+	if (sched_handle_alloc(task) < 0) {
+		frame->r0 = 0;
+		scheduler_spin_unlock();
+		return;
+	}
+
 	/* Add the task the scheduler list */
 	sched_list_push(&scheduler->tasks, &task->scheduler_node);
 
@@ -459,7 +901,7 @@ void scheduler_create_svc(struct exception_frame *frame)
 
 		/* Ready the task */
 		task->state = TASK_READY;
-		sched_queue_push(&scheduler->ready_queue, task);
+		sched_ready_push(task);
 
 		/* Since we pushed the task onto the ready queue, do a context switch and return the new task */
 		if (scheduler_is_running() && task->current_priority < sched_get_current()->current_priority)
@@ -475,38 +917,46 @@ void scheduler_create_svc(struct exception_frame *frame)
 
 void scheduler_yield_svc(struct exception_frame *frame)
 {
+#if SCHEDULER_RUNTIME_STATS > 0
+	/* Giving up the processor is not a preemption */
+	cls_datum(yielding) = true;
+#endif
+
 	/* Pend the context switch to switch to the next task */
 	scheduler_request_switch(scheduler_current_core());
 }
 
-static int scheduler_task_alive(const struct task *task)
+static struct task *scheduler_task_alive(unsigned long handle)
 {
-	if (task != 0) {
-		struct sched_list *current = 0;
-		sched_list_for_each(current , &scheduler->tasks)
-			if (&task->scheduler_node == current)
-				return 0;
-	}
+	/*
+	 * The handle generation must match the slot, so a handle to a terminated task fails even
+	 * when its memory has been reused by a new task. This keeps the check constant time no
+	 * matter how many tasks exist.
+	 */
+	struct task *task = sched_handle_lookup(handle);
+	if (task != 0 && task->state != TASK_TERMINATED && !sched_list_empty(&task->scheduler_node))
+		return task;
 
 	/* Not alive */
-	return -ESRCH;
+	return 0;
 }
 
 void scheduler_suspend_svc(struct scheduler_frame *frame)
 {
 	struct task *current = sched_get_current();
-	struct task *task = (struct task *)frame->r0;
 	unsigned long ticks = frame->r1;
 
 	/* Close the dog house door */
 	scheduler_spin_lock();
 
 	/* Make sure the task is alive */
-	frame->r0 = scheduler_task_alive(task);
-	if (frame->r0 != 0) {
+	struct task *task = scheduler_task_alive(frame->r0);
+	if (!task) {
+		frame->r0 = -ESRCH;
 		scheduler_spin_unlock();
 		return;
 	}
+	frame->r0 = 0;
 
 	/* Who are we suspending */
 	if (task != current) {
@@ -521,7 +971,7 @@ void scheduler_suspend_svc(struct scheduler_frame *frame)
 
 		/* Since a scheduler frame was create we always need a context switch */
 		current->state = TASK_READY;
-		sched_queue_push(&scheduler->ready_queue, current);
+		sched_ready_push(current);
 
 	} else {
 
@@ -535,6 +985,7 @@ void scheduler_suspend_svc(struct scheduler_frame *frame)
 		scheduler_timer_push(task, ticks);
 
 	/* We need a context switch */
+	trace_event(TRACE_SWITCH_OUT, current->state, current);
 	current->psp = frame;
 	sched_set_current(0);
 	scheduler_request_switch(scheduler_current_core());
@@ -545,20 +996,19 @@ void scheduler_suspend_svc(struct scheduler_frame *frame)
 
 void scheduler_resume_svc(struct exception_frame *frame)
 {
-	struct task *task = (struct task *)frame->r0;
-
-	/* We should be could */
-	frame->r0 = 0;
-
 	scheduler_spin_lock();
 
 	/* Make sure the task is alive */
-	frame->r0 = scheduler_task_alive(task);
-	if (frame->r0 != 0) {
+	struct task *task = scheduler_task_alive(frame->r0);
+	if (!task) {
+		frame->r0 = -ESRCH;
 		scheduler_spin_unlock();
 		return;
 	}
 
+	/* We should be could */
+	frame->r0 = 0;
+
 	assert(task != 0 && task->marker == SCHEDULER_TASK_MARKER);
 
 	/* Wake up suspended, sleeping and blocked tasks only */
@@ -577,7 +1027,7 @@ void scheduler_resume_svc(struct exception_frame *frame)
 
 		/* Push on the ready queue */
 		task->state = TASK_READY;
-		sched_queue_push(&scheduler->ready_queue, task);
+		sched_ready_push(task);
 
 	} else
 		frame->r0 = -EINVAL;
@@ -605,6 +1055,11 @@ void scheduler_wait_svc(struct scheduler_frame *frame)
 	/* Should we block? The second clause prevents a wakeup when the futex becomes contended while on the way into the wait */
 	if (atomic_compare_exchange_strong(futex->value, &expected, value) || expected == value) {
 
+#if SCHEDULER_RUNTIME_STATS > 0
+		++current->stats.futex_waits;
+#endif
+		trace_event(TRACE_FUTEX_WAIT, 0, futex);
+
 		/* Add a timeout if requested */
 		if (ticks < SCHEDULER_WAIT_FOREVER)
 			scheduler_timer_push(current, ticks);
@@ -626,20 +1081,19 @@ void scheduler_wait_svc(struct scheduler_frame *frame)
 				sched_list_add(&owner->owned_futexes, &futex->owned);
 
 			/* Do we need to boost the priority of the futex owner? */
-			unsigned long highest_priority = sched_queue_highest_priority(&futex->waiters);
-			if (highest_priority < owner->current_priority)
-				sched_queue_reprioritize(owner, highest_priority);
+			sched_task_boost(owner, sched_queue_highest_priority(&futex->waiters));
 		}
 
 	} else {
 
 		/* Futex already triggered, we will need a need to complete for the processor */
 		current->state = TASK_READY;
-		sched_queue_push(&scheduler->ready_queue, current);
+		sched_ready_push(current);
 	}
 
 
 	/* Always perform a context switch  */
+	trace_event(TRACE_SWITCH_OUT, current->state, current);
 	current->psp = frame;
 	sched_set_current(0);
 	scheduler_request_switch(scheduler_current_core());
@@ -662,17 +1116,8 @@ static int scheduler_wake_futex(struct futex *futex, bool all)
 		/* Remove the this futex from the owned list */
 		sched_list_remove(&futex->owned);
 
-		/* Now find the highest priority of remaining owned PI futexes */
-		unsigned long highest_priority = owner->base_priority;
-		struct futex *owned;
-		sched_list_for_each_entry(owned, &owner->owned_futexes, owned) {
-			unsigned long highest_waiter = sched_queue_highest_priority(&owned->waiters);
-			if (highest_waiter < highest_priority)
-				highest_priority = highest_waiter;
-		}
-
-		/* Re-prioritize the task */
-		sched_queue_reprioritize(owner, highest_priority);
+		/* Re-prioritize the task from whatever still boosts it */
+		sched_task_recompute(owner);
 	}
 
 	/* Wake up the waiters */
@@ -690,14 +1135,14 @@ static int scheduler_wake_futex(struct futex *futex, bool all)
 			/* Add the futex to the list of owned, contented futexes */
 			sched_list_add(&task->owned_futexes, &futex->owned);
 
-			/* Adjust the priority of the new owner */
-			sched_queue_reprioritize(task, sched_queue_highest_priority(&futex->waiters));
+			/* Adjust the priority of the new owner, never below what it already runs at */
+			sched_task_boost(task, sched_queue_highest_priority(&futex->waiters));
 		}
 
 		/* Adjust queue */
 		scheduler_timer_remove(task);
 		task->state = TASK_READY;
-		sched_queue_push(&scheduler->ready_queue, task);
+		sched_ready_push(task);
 
 		/* Continue waking more tasks? */
 		++woken;
@@ -705,6 +1150,8 @@ static int scheduler_wake_futex(struct futex *futex, bool all)
 			break;
 	}
 
+	trace_event(TRACE_FUTEX_WAKE, woken, futex);
+
 	/* Update the contention tracking if requested */
 	if (futex->flags & SCHEDULER_FUTEX_CONTENTION_TRACKING) {
 		if (sched_queue_empty(&futex->waiters))
@@ -717,6 +1164,95 @@ static int scheduler_wake_futex(struct futex *futex, bool all)
 	return woken;
 }
 
+static void scheduler_drain_wakes(struct sched_wake_ring *ring)
+{
+	/* Only interrupts on this core produce and they can not be part way through an enqueue while we run, so every slot before the head is filled */
+	unsigned long head;
+	while ((head = atomic_load(&ring->head)) != ring->tail) {
+		while (ring->tail != head) {
+
+			/* Consume the slot, it may have been abandoned by a producer who lost a coalescing race */
+			unsigned long slot = ring->tail & (SCHEDULER_MAX_DEFERED_WAKE - 1);
+			struct futex *futex = ring->slots[slot];
+			ring->slots[slot] = 0;
+			++ring->tail;
+			if (!futex)
+				continue;
+
+			/* Claim the pending wake, anything coalesced before this point is included */
+			unsigned long pending = atomic_exchange(&futex->deferred, 0);
+			scheduler_wake_futex(futex, (pending & SCHEDULER_WAKE_ALL) != 0);
+		}
+	}
+}
+
+static int scheduler_defer_wake(struct futex *futex, bool all)
+{
+	struct sched_wake_ring *ring = cls_datum_ptr(deferred_wake);
+	unsigned long core = scheduler_current_core();
+	unsigned long wakeup = SCHEDULER_WAKE_QUEUED | (all ? SCHEDULER_WAKE_ALL : 0) | (core << SCHEDULER_WAKE_CORE_SHIFT);
+	bool reserved = false;
+	unsigned long slot = 0;
+
+	while (true) {
+
+		/* Coalesce with a wake already pending on any core, upgrading it to wake all if needed */
+		unsigned long pending = atomic_load(&futex->deferred);
+		if (pending & SCHEDULER_WAKE_QUEUED) {
+			if (!atomic_compare_exchange_strong(&futex->deferred, &pending, pending | (wakeup & SCHEDULER_WAKE_ALL)))
+				continue;
+			atomic_fetch_add(&ring->stats.coalesced, 1);
+			scheduler_request_switch(pending >> SCHEDULER_WAKE_CORE_SHIFT);
+			return 0;
+		}
+
+		/* Reserve a slot, the consumer only runs once we are done and skips the slot if we end up coalescing */
+		if (!reserved) {
+			unsigned long head = atomic_load(&ring->head);
+			do {
+				if (head - ring->tail >= SCHEDULER_MAX_DEFERED_WAKE) {
+					atomic_fetch_add(&ring->stats.overflows, 1);
+					return -ENOSPC;
+				}
+			} while (!atomic_compare_exchange_weak(&ring->head, &head, head + 1));
+			slot = head & (SCHEDULER_MAX_DEFERED_WAKE - 1);
+			reserved = true;
+
+			/* Track the high water mark */
+			unsigned long used = head + 1 - ring->tail;
+			unsigned long high_water = atomic_load(&ring->stats.high_water);
+			while (used > high_water && !atomic_compare_exchange_weak(&ring->stats.high_water, &high_water, used));
+		}
+
+		/* Mark the futex as queued on this core, losing means someone else queued it first so go coalesce */
+		if (atomic_compare_exchange_strong(&futex->deferred, &pending, wakeup)) {
+			ring->slots[slot] = futex;
+			atomic_fetch_add(&ring->stats.deferred, 1);
+			trace_event(TRACE_DEFERRED_WAKE, all, futex);
+			scheduler_request_switch(core);
+			return 0;
+		}
+	}
+}
+
+void scheduler_get_wake_stats(unsigned long core, struct scheduler_wake_stats *stats)
+{
+	assert(core < scheduler_num_cores() && stats != 0);
+
+	memcpy(stats, &cls_datum_core_ptr(core, deferred_wake)->stats, sizeof(struct scheduler_wake_stats));
+}
+
+void scheduler_reset_wake_stats(void)
+{
+	for (unsigned long core = 0; core < scheduler_num_cores(); ++core) {
+		struct scheduler_wake_stats *stats = &cls_datum_core_ptr(core, deferred_wake)->stats;
+		stats->high_water = 0;
+		stats->deferred = 0;
+		stats->coalesced = 0;
+		stats->overflows = 0;
+	}
+}
+
 void scheduler_wake_svc(struct exception_frame *frame)
 {
 	struct futex *futex = (struct futex *)frame->r0;
@@ -738,19 +1274,109 @@ void scheduler_wake_svc(struct exception_frame *frame)
 	scheduler_spin_unlock();
 }
 
+static bool scheduler_requeue_prepare(struct futex *futex)
+{
+	/* Not owner tracked, waiters will be woken by the next wake */
+	if ((futex->flags & SCHEDULER_FUTEX_OWNER_TRACKING) == 0) {
+		if (futex->flags & SCHEDULER_FUTEX_CONTENTION_TRACKING)
+			atomic_fetch_or(futex->value, SCHEDULER_FUTEX_CONTENTION_TRACKING);
+		return true;
+	}
+
+	/* Without contention tracking the owner could release without ever entering the kernel */
+	if ((futex->flags & SCHEDULER_FUTEX_CONTENTION_TRACKING) == 0)
+		return false;
+
+	/* Must have an owner which is forced through the wake on release, otherwise nobody would wake the requeued waiters */
+	long expected = atomic_load(futex->value);
+	do {
+		if ((expected & ~SCHEDULER_FUTEX_CONTENTION_TRACKING) == 0)
+			return false;
+	} while (!atomic_compare_exchange_weak(futex->value, &expected, expected | SCHEDULER_FUTEX_CONTENTION_TRACKING));
+
+	return true;
+}
+
+void scheduler_requeue_svc(struct exception_frame *frame)
+{
+	struct futex *from = (struct futex *)frame->r0;
+	struct futex *to = (struct futex *)frame->r1;
+	unsigned long nr_wake = frame->r2;
+	unsigned long nr_requeue = frame->r3;
+	unsigned long woken = 0;
+	unsigned long requeued = 0;
+	struct task *task;
+
+	/* Both queues must be stable */
+	scheduler_spin_lock();
+
+	assert(from != 0 && from->marker == SCHEDULER_FUTEX_MARKER && to != 0 && to->marker == SCHEDULER_FUTEX_MARKER);
+
+	/* Waiters which can not be requeued are woken instead so they are never stranded */
+	if (!sched_queue_empty(&from->waiters) && nr_requeue > 0 && !scheduler_requeue_prepare(to)) {
+		nr_wake = nr_wake + nr_requeue < nr_wake ? UINT32_MAX : nr_wake + nr_requeue;
+		nr_requeue = 0;
+	}
+
+	/* Wake the requested number of waiters */
+	while (woken < nr_wake && (task = sched_queue_pop(&from->waiters, UINT32_MAX)) != 0) {
+		assert(task->marker == SCHEDULER_TASK_MARKER);
+		scheduler_timer_remove(task);
+		task->state = TASK_READY;
+		sched_ready_push(task);
+		++woken;
+	}
+
+	/* Move the next waiters without waking them, any timeouts stay armed */
+	while (requeued < nr_requeue && (task = sched_queue_pop(&from->waiters, UINT32_MAX)) != 0) {
+		assert(task->marker == SCHEDULER_TASK_MARKER);
+		sched_queue_push(&to->waiters, task);
+		++requeued;
+	}
+
+	/* Boost the owner of a priority inheritance futex just like a wait would */
+	if (requeued > 0 && (to->flags & (SCHEDULER_FUTEX_PI | SCHEDULER_FUTEX_OWNER_TRACKING)) == (SCHEDULER_FUTEX_PI | SCHEDULER_FUTEX_OWNER_TRACKING)) {
+
+		struct task *owner = (struct task *)(*to->value & ~SCHEDULER_FUTEX_CONTENTION_TRACKING);
+		assert(owner->marker == SCHEDULER_TASK_MARKER);
+
+		if (!sched_list_is_linked(&to->owned))
+			sched_list_add(&owner->owned_futexes, &to->owned);
+
+		sched_task_boost(owner, sched_queue_highest_priority(&to->waiters));
+	}
+
+	trace_event(TRACE_FUTEX_WAKE, woken, from);
+
+	/* Update the contention tracking of the source */
+	if ((from->flags & SCHEDULER_FUTEX_CONTENTION_TRACKING) && sched_queue_empty(&from->waiters))
+		atomic_fetch_and(from->value, ~SCHEDULER_FUTEX_CONTENTION_TRACKING);
+
+	/* Return the number of woken and requeued waiters */
+	frame->r0 = woken + requeued;
+
+	/* Request a context switch if we woke anyone */
+	if (woken > 0)
+		scheduler_request_switch(scheduler_current_core());
+
+	/* Release the hounds */
+	scheduler_spin_unlock();
+}
+
 void scheduler_terminate_svc(struct exception_frame *frame)
 {
 	struct task *current = sched_get_current();
-	struct task *task = (struct task *)frame->r0;
 
 	scheduler_spin_lock();
 
 	/* Make sure the task is alive */
-	frame->r0 = scheduler_task_alive(task);
-	if (frame->r0 != 0) {
+	struct task *task = scheduler_task_alive(frame->r0);
+	if (!task) {
+		frame->r0 = -ESRCH;
 		scheduler_spin_unlock();
 		return;
 	}
+	frame->r0 = 0;
 
 	/* Clean up the task */
 	task->state = TASK_TERMINATED;
@@ -758,12 +1384,15 @@ void scheduler_terminate_svc(struct exception_frame *frame)
 	sched_queue_remove(task);
 	scheduler_timer_remove(task);
 	sched_list_remove(&task->scheduler_node);
+	if ((task->flags & SCHEDULER_RETAIN_HANDLE) == 0)
+		sched_handle_free(task);
 
 	/* Forward to the termination handler */
 	scheduler_terminated_hook(task);
 
 	/* if we are terminating ourselves we need a context switch */
 	if (task == current) {
+		trace_event(TRACE_SWITCH_OUT, TASK_TERMINATED, current);
 		sched_set_current(0);
 		scheduler_request_switch(scheduler_current_core());
 	}
@@ -774,23 +1403,24 @@ void scheduler_terminate_svc(struct exception_frame *frame)
 
 void scheduler_priority_svc(struct exception_frame *frame)
 {
-	struct task *task = (struct task *)frame->r0;
 	unsigned long priority = frame->r1;
 
 	scheduler_spin_lock();
 
 	/* Make sure the task is alive */
-	frame->r0 = scheduler_task_alive(task);
-	if (frame->r0 != 0) {
+	struct task *task = scheduler_task_alive(frame->r0);
+	if (!task) {
+		frame->r0 = -ESRCH;
 		scheduler_spin_unlock();
 		return;
 	}
+	frame->r0 = 0;
 
 	assert(task->marker == SCHEDULER_TASK_MARKER);
 
+	/* Keep any inheritance or ceiling boost */
 	task->base_priority = priority;
-	/* if (task->base_priority < task->current_priority) Will the cause a priority inheritance problem????? */
-	sched_queue_reprioritize(task, priority);
+	sched_task_recompute(task);
 
 	/* Let the context switcher sort this out */
 	scheduler_request_switch(scheduler_current_core());
@@ -825,13 +1455,51 @@ __weak void scheduler_terminated_hook(struct task *task)
 
 struct task *debug_tasks[25];
 
+__weak unsigned long scheduler_tick_deadline_hook(void)
+{
+	/* No tick users outside of the scheduler */
+	return UINT32_MAX;
+}
+
+__weak bool scheduler_tickless_enter(unsigned long ticks)
+{
+	/* No hardware support, keep ticking */
+	return false;
+}
+
+__weak unsigned long scheduler_tickless_exit(void)
+{
+	return 0;
+}
+
 __weak void scheduler_idle_hook(void)
 {
+#if SCHEDULER_TICKLESS > 0
+	/* Find the closest tick deadline of the scheduler timers and any other tick users */
+	unsigned long now = scheduler_get_ticks();
+	unsigned long deadline = scheduler_tick_deadline_hook();
+	if (scheduler->timer_expires < deadline)
+		deadline = scheduler->timer_expires;
+
+	/* Only stop the tick if we will sleep long enough to be worth it */
+	bool tickless = false;
+	if (deadline > now && deadline - now >= SCHEDULER_TICKLESS_MIN_TICKS)
+		tickless = scheduler_tickless_enter(deadline - now);
+#endif
+
 	scheduler_spin_unlock();
 
 	/* Wait for some indication of work */
 	__WFI();
 
+#if SCHEDULER_TICKLESS > 0
+	/* Catch up on the ticks we slept through and let the tick users see them */
+	if (tickless) {
+		cls_datum(ticks) += scheduler_tickless_exit();
+		scheduler_tick_hook(scheduler_get_ticks());
+	}
+#endif
+
 	/*
 	 * This might have been a some kind of scheduler request, since we are already
 	 * inside the PendSV handler we need to ensure it is cleared to prevent double
@@ -867,6 +1535,72 @@ __weak void scheduler_request_switch(unsigned long core)
 	__DSB();
 }
 
+__weak void scheduler_core_call(unsigned long core, struct scheduler_core_call *call)
+{
+	assert(call != 0 && call->func != 0);
+
+	/* Only one core, run it here the way the other core would, with our interrupts off */
+	uint32_t state = disable_interrupts();
+	call->func(call);
+	++call->sequence;
+	enable_interrupts(state);
+}
+
+__weak void scheduler_get_lock_stats(unsigned long core, struct scheduler_lock_stats *stats)
+{
+	assert(stats != 0);
+
+	/* No other cores, no contention */
+	memset(stats, 0, sizeof(struct scheduler_lock_stats));
+}
+
+__weak void scheduler_reset_lock_stats(void)
+{
+}
+
+int scheduler_get_task_stats(struct task *task, struct task_stats *stats)
+{
+	assert(stats != 0);
+
+	/* Use the current task if needed */
+	if (!task)
+		task = scheduler_task();
+
+	assert(task != 0 && task->marker == SCHEDULER_TASK_MARKER);
+
+#if SCHEDULER_RUNTIME_STATS > 0
+	/* Take a consistent snapshot, running tasks are charged up to now */
+	unsigned long state = scheduler_enter_critical();
+	*stats = task->stats;
+	if (task->state == TASK_RUNNING)
+		stats->run_time += timestamp() - cls_datum_core(task->core, run_start);
+	scheduler_exit_critical(state);
+
+	return 0;
+#else
+	memset(stats, 0, sizeof(struct task_stats));
+	return -ENOTSUP;
+#endif
+}
+
+unsigned long long scheduler_get_idle_time(unsigned long core)
+{
+	unsigned long long idle = 0;
+
+	assert(core < scheduler_num_cores());
+
+#if SCHEDULER_RUNTIME_STATS > 0
+	/* Include any idle period in progress */
+	unsigned long state = scheduler_enter_critical();
+	idle = cls_datum_core(core, idle_time);
+	if (cls_datum_core(core, idle_start) != 0)
+		idle += timestamp() - cls_datum_core(core, idle_start);
+	scheduler_exit_critical(state);
+#endif
+
+	return idle;
+}
+
 struct scheduler_frame *scheduler_switch(struct scheduler_frame *frame)
 {
 	struct task *expired;
@@ -884,6 +1618,15 @@ struct scheduler_frame *scheduler_switch(struct scheduler_frame *frame)
 
 		assert(task->marker == SCHEDULER_TASK_MARKER && task->state == TASK_RUNNING);
 
+#if SCHEDULER_EDF > 0
+		/* An exhausted EDF task drops to its fallback priority until its next job, keeping any boosts */
+		if (task->edf.exhausted) {
+			task->edf.exhausted = false;
+			task->base_priority = task->edf.priority;
+			sched_task_recompute(task);
+		}
+#endif
+
 		/* No switch if scheduler is locked */
 		if (scheduler->locked < 0) {
 			sched_set_current(task);
@@ -892,28 +1635,24 @@ struct scheduler_frame *scheduler_switch(struct scheduler_frame *frame)
 		}
 
 		/* Force the running task to complete for the processor */
+		trace_event(TRACE_SWITCH_OUT, TASK_READY, task);
 		task->state = TASK_READY;
 		task->core = UINT32_MAX;
 		task->psp = frame;
-		sched_queue_push(&scheduler->ready_queue, task);
+		sched_ready_push(task);
 	}
 
 	/* Try to get the next task */
 	while (true) {
 
 		/* Check for deferred wake ups */
-		for (int i = 0; (cls_datum(taken_wake_counter) ^ cls_datum(given_wake_counter)) != 0 && i < SCHEDULER_MAX_DEFERED_WAKE; ++i) {
-			unsigned long wakeup = atomic_exchange(&cls_datum(deferred_wake)[i], 0);
-			if (wakeup != 0) {
-				scheduler_wake_futex((struct futex *)(wakeup & ~0x00000001), wakeup & 0x00000001);
-				++cls_datum(taken_wake_counter);
-			}
-		}
+		scheduler_drain_wakes(cls_datum_ptr(deferred_wake));
 
 		/* Ready any expired timers */
 		while((expired = scheduler_timer_pop()) != 0) {
 
 			assert(expired->marker == SCHEDULER_TASK_MARKER);
+			trace_event(TRACE_TIMER_EXPIRED, 0, expired);
 
 			/* Remove from any wait queue */
 			sched_queue_remove(expired);
@@ -923,11 +1662,11 @@ struct scheduler_frame *scheduler_switch(struct scheduler_frame *frame)
 			expired->psp->r0 = (uint32_t)-ETIMEDOUT;
 
 			/* Add to the ready queue */
-			sched_queue_push(&scheduler->ready_queue, expired);
+			sched_ready_push(expired);
 		}
 
 		/* Try to get highest priority ready task */
-		task = sched_queue_pop(&scheduler->ready_queue, scheduler_current_core());
+		task = sched_ready_pop(scheduler_current_core());
 		if (task) {
 
 			assert(task->marker == SCHEDULER_TASK_MARKER);
@@ -940,8 +1679,10 @@ struct scheduler_frame *scheduler_switch(struct scheduler_frame *frame)
 			task->state = TASK_TERMINATED;
 			task->psp->r0 = (uint32_t)-EFAULT;
 			sched_queue_remove(task);
-			sched_list_remove(&task->timer_node);
+			scheduler_timer_remove(task);
 			sched_list_remove(&task->scheduler_node);
+			if ((task->flags & SCHEDULER_RETAIN_HANDLE) == 0)
+				sched_handle_free(task);
 			scheduler_terminated_hook(task);
 		}
 
@@ -959,7 +1700,15 @@ struct scheduler_frame *scheduler_switch(struct scheduler_frame *frame)
 		}
 
 		/* Call the idle hook if present */
+		trace_event(TRACE_IDLE, 0, 0);
+#if SCHEDULER_RUNTIME_STATS > 0
+		cls_datum(idle_start) = timestamp();
 		scheduler_idle_hook();
+		cls_datum(idle_time) += timestamp() - cls_datum(idle_start);
+		cls_datum(idle_start) = 0;
+#else
+		scheduler_idle_hook();
+#endif
 	}
 
 	/* Mark the task as running and return its scheduler frame */
@@ -967,16 +1716,28 @@ struct scheduler_frame *scheduler_switch(struct scheduler_frame *frame)
 	task->state = TASK_RUNNING;
 	task->core = scheduler_current_core();
 
-	/* Update the slice expires if needed */
-	if (task != last_task || cls_datum(slice_expires) < 0)
-		cls_datum(slice_expires) = scheduler->slice_duration;
+	/* Start a new quantum if the task changed or the last one expired */
+	if (task != last_task || cls_datum(slice_expires) <= 0)
+		cls_datum(slice_expires) = task->quantum;
+
+#if SCHEDULER_RUNTIME_STATS > 0
+	/* Count the switch, the last task was preempted if it was still ready and did not yield */
+	if (task != last_task) {
+		++task->stats.switches;
+		if (last_task && last_task->state == TASK_READY && !cls_datum(yielding))
+			++last_task->stats.preemptions;
+	}
+	cls_datum(yielding) = false;
+#endif
 
 	/* Update the current task */
+	trace_event(TRACE_SWITCH_IN, 0, task);
 	if (sched_set_current(task) != 0)
 		abort();
 
-	/* If there are still more ready tasks, kick other cores if need to ensure high priority tasks run */
-	if (!sched_queue_empty(&scheduler->ready_queue)) {
+	/* If there are still more local ready tasks, kick other cores running lower priority tasks so they can steal them */
+	struct sched_queue *queue = sched_ready_queue(scheduler_current_core());
+	if (!sched_queue_empty(queue)) {
 
 		/* Check other cores */
 		for (unsigned long core = 0; core < scheduler_num_cores(); ++core) {
@@ -984,19 +1745,12 @@ struct scheduler_frame *scheduler_switch(struct scheduler_frame *frame)
 			/* Other cores */
 			if (core != scheduler_current_core()) {
 
-				/* Only kick the other core if there is a higher priority task to run */
+				/* Only kick the other core if there is a higher priority task it can run */
 				struct task *core_task = cls_datum_core(core, current_task);
 				if (core_task) {
-
-					/* Well check the priority taking into account core affinity */
-					struct task *cursor;
-					sched_list_for_each_entry(cursor, &scheduler->ready_queue.tasks, queue_node) {
-						if ((cursor->flags & SCHEDULER_CORE_AFFINITY) == 0 || cursor->affinity == core) {
-							if (cursor->current_priority < core_task->current_priority)
-								scheduler_request_switch(core);
-							break;
-						}
-					}
+					struct task *cursor = sched_queue_peek(queue, core);
+					if (cursor && cursor->current_priority < core_task->current_priority)
+						scheduler_request_switch(core);
 				}
 			}
 		}
@@ -1017,8 +1771,8 @@ struct task *scheduler_create(void *stack, size_t stack_size, const struct task_
 		return 0;
 	}
 
-	/* Initialize the stack for simple stack consumption measurements */
-	if (descriptor->flags & SCHEDULER_TASK_STACK_CHECK) {
+	/* Initialize the stack for simple stack consumption measurements, unless the caller has already done it */
+	if ((descriptor->flags & (SCHEDULER_TASK_STACK_CHECK | SCHEDULER_STACK_PREMARKED)) == SCHEDULER_TASK_STACK_CHECK) {
 		unsigned long *pos = stack;
 		unsigned long *end = (void *)(stack + stack_size);
 		while (pos < end)
@@ -1032,15 +1786,41 @@ struct task *scheduler_create(void *stack, size_t stack_size, const struct task_
 	sched_list_init(&task->scheduler_node);
 	sched_list_init(&task->queue_node);
 	sched_list_init(&task->owned_futexes);
+	sched_list_init(&task->held_ceilings);
+	task->ceiling_priority = SCHEDULER_NUM_TASK_PRIORITIES;
+	task->priority_sequence = 0;
 	task->current_queue = 0;
 	task->timer_expires = UINT32_MAX;
 	task->base_priority = descriptor->priority;
 	task->current_priority = descriptor->priority;
+	memset(&task->stats, 0, sizeof(task->stats));
+	task->quantum = descriptor->quantum > 0 && descriptor->quantum < INT32_MAX ? descriptor->quantum : scheduler->slice_duration;
+
+	/* Setup the EDF parameters, EDF tasks are partitioned so they stay on their core and are never sliced */
+	memset(&task->edf, 0, sizeof(task->edf));
+#if SCHEDULER_EDF > 0
+	if (descriptor->period != 0) {
+		task->edf.period = descriptor->period;
+		task->edf.deadline = descriptor->deadline != 0 ? descriptor->deadline : descriptor->period;
+		task->edf.budget = descriptor->budget;
+		task->edf.priority = descriptor->priority;
+		scheduler_edf_release(&task->edf, scheduler_get_ticks());
+		task->base_priority = SCHEDULER_EDF_PRIORITY;
+		task->current_priority = SCHEDULER_EDF_PRIORITY;
+		task->quantum = INT32_MAX;
+	}
+#endif
 	task->exit_handler = descriptor->exit_handler;
 	task->flags = descriptor->flags;
 	task->context = descriptor->context;
 	task->core = UINT32_MAX;
 	task->affinity = descriptor->flags & SCHEDULER_CORE_AFFINITY ? descriptor->affinity : UINT32_MAX;
+#if SCHEDULER_EDF > 0
+	if (task->edf.period != 0 && (task->flags & SCHEDULER_CORE_AFFINITY) == 0) {
+		task->flags |= SCHEDULER_CORE_AFFINITY;
+		task->affinity = scheduler_current_core();
+	}
+#endif
 
 	/* Build the scheduler frame to use the PSP and run in privileged mode */
 	if ((descriptor->flags & SCHEDULER_NO_FRAME_INIT) == 0) {
@@ -1087,6 +1867,12 @@ struct task *scheduler_create(void *stack, size_t stack_size, const struct task_
 	/* Handle primordial task specially, very hacky to support threads and pthreads initialization */
 	if (descriptor->flags & SCHEDULER_PRIMORDIAL_TASK) {
 
+		/* Nothing else is running yet so the handle table needs no lock */
+		if (sched_handle_alloc(task) < 0) {
+			errno = EAGAIN;
+			return 0;
+		}
+
 		/* Add the task the scheduler list */
 		sched_list_push(&scheduler->tasks, &task->scheduler_node);
 
@@ -1108,7 +1894,11 @@ struct task *scheduler_create(void *stack, size_t stack_size, const struct task_
 	}
 
 	/* Ask scheduler to add the new task */
-	return (struct task *)svc_call1(SCHEDULER_CREATE_SVC, (uint32_t)task);
+	task = (struct task *)svc_call1(SCHEDULER_CREATE_SVC, (uint32_t)task);
+	if (!task)
+		errno = EAGAIN;
+
+	return task;
 }
 
 int scheduler_init(struct scheduler *new_scheduler, size_t tls_size)
@@ -1136,8 +1926,8 @@ int scheduler_init(struct scheduler *new_scheduler, size_t tls_size)
 	new_scheduler->timer_expires = UINT32_MAX;
 	new_scheduler->critical = UINT32_MAX;
 	new_scheduler->critical_counter = 0;
-	sched_queue_init(&new_scheduler->ready_queue);
-	sched_list_init(&new_scheduler->timers);
+	for (unsigned long slot = 0; slot < SCHEDULER_TIMER_WHEEL_SLOTS; ++slot)
+		sched_list_init(&new_scheduler->timers[slot]);
 	sched_list_init(&new_scheduler->tasks);
 
 	/* Initialize the all core local data */
@@ -1146,7 +1936,9 @@ int scheduler_init(struct scheduler *new_scheduler, size_t tls_size)
 		cls_datum_core(core, current_task) = 0;
 		cls_datum_core(core, slice_expires) = INT32_MAX;
 		cls_datum_core(core, ticks) = 0;
-		memset(cls_datum_core_ptr(core, deferred_wake), 0, sizeof(deferred_wake));
+		memset(cls_datum_core_ptr(core, deferred_wake), 0, sizeof(struct sched_wake_ring));
+		cls_datum_core(core, deferred_wake).stats.capacity = SCHEDULER_MAX_DEFERED_WAKE;
+		sched_ready_queue_init(cls_datum_core_ptr(core, ready_queue));
 	}
 
 	/* Save a scheduler singleton */
@@ -1281,6 +2073,52 @@ struct task *scheduler_task(void)
 	return scheduler != 0 ? sched_get_current() : 0;
 }
 
+unsigned long scheduler_task_handle(struct task *task)
+{
+	/* Use the current task if needed */
+	if (!task)
+		task = scheduler_task();
+
+	assert(task != 0 && task->marker == SCHEDULER_TASK_MARKER);
+
+	return task->handle;
+}
+
+struct task *scheduler_task_lookup(unsigned long handle)
+{
+	/* Before the scheduler runs there is nobody to race with */
+	if (!scheduler)
+		return 0;
+	if (!scheduler_is_running())
+		return sched_handle_lookup(handle);
+
+	/* A lookup racing a release must see either the old task or nothing */
+	unsigned long state = scheduler_enter_critical();
+	struct task *task = sched_handle_lookup(handle);
+	scheduler_exit_critical(state);
+
+	return task;
+}
+
+void scheduler_release_handle(struct task *task)
+{
+	assert(task != 0 && task->marker == SCHEDULER_TASK_MARKER);
+
+	/* Only retained handles outlive the task, the others went at termination */
+	if ((task->flags & SCHEDULER_RETAIN_HANDLE) == 0)
+		return;
+
+	/* Before the scheduler runs there is nobody to race with */
+	if (!scheduler_is_running()) {
+		sched_handle_free(task);
+		return;
+	}
+
+	unsigned long state = scheduler_enter_critical();
+	sched_handle_free(task);
+	scheduler_exit_critical(state);
+}
+
 int scheduler_sleep(unsigned long ticks)
 {
 	/* Msecs should be greater 0, just yield otherwise */
@@ -1290,7 +2128,7 @@ int scheduler_sleep(unsigned long ticks)
 	}
 
 	/* We are timed suspending ourselves */
-	int status = svc_call2(SCHEDULER_SUSPEND_SVC, (uint32_t)scheduler_task(), ticks);
+	int status = svc_call2(SCHEDULER_SUSPEND_SVC, scheduler_task()->handle, ticks);
 	if (status < 0 && status != -ETIMEDOUT) {
 		errno = -status;
 		return status;
@@ -1300,19 +2138,50 @@ int scheduler_sleep(unsigned long ticks)
 	return 0;
 }
 
-int scheduler_suspend(struct task *task)
+int scheduler_edf_wait(void)
+{
+	struct task *task = scheduler_task();
+
+	assert(task != 0 && task->marker == SCHEDULER_TASK_MARKER);
+
+	/* Only for EDF tasks */
+	if (task->edf.period == 0) {
+		errno = EINVAL;
+		return -EINVAL;
+	}
+
+	/* Complete the job and setup the next one, back in the EDF band with a full budget */
+	unsigned long state = scheduler_enter_critical();
+	unsigned long now = scheduler_get_ticks();
+	bool missed = scheduler_edf_complete(&task->edf, now);
+	if (task->current_priority == task->base_priority)
+		task->current_priority = SCHEDULER_EDF_PRIORITY;
+	task->base_priority = SCHEDULER_EDF_PRIORITY;
+	unsigned long delay = task->edf.release - now;
+	scheduler_exit_critical(state);
+
+	/* Report any deadline miss */
+	if (missed)
+		scheduler_edf_overrun_hook(task, true);
+
+	/* Sleep until the release, when running late start right away */
+	return scheduler_edf_before(now, task->edf.release) ? scheduler_sleep(delay) : 0;
+}
+
+int scheduler_suspend(unsigned long handle)
 {
 	/* Are we suspending ourselves? */
-	if (!task)
-		task = scheduler_task();
+	unsigned long current = scheduler_task()->handle;
+	if (!handle)
+		handle = current;
 
-	if (scheduler_num_cores() > 1 && task != scheduler_task()) {
+	if (scheduler_num_cores() > 1 && handle != current) {
 		errno = EINVAL;
 		return -errno;
 	}
 
-	/* Suspend it */
-	int status = svc_call2(SCHEDULER_SUSPEND_SVC, (uint32_t)task, SCHEDULER_WAIT_FOREVER);
+	/* Suspend it, the service checks the handle is still alive */
+	int status = svc_call2(SCHEDULER_SUSPEND_SVC, handle, SCHEDULER_WAIT_FOREVER);
 	if (status < 0) {
 		errno = -status;
 		return status;
@@ -1322,12 +2191,12 @@ int scheduler_suspend(struct task *task)
 	return 0;
 }
 
-int scheduler_resume(struct task *task)
+int scheduler_resume(unsigned long handle)
 {
-	assert(task != 0);
+	assert(handle != 0);
 
-	/* Make the task ready to run */
-	int status = svc_call1(SCHEDULER_RESUME_SVC, (uint32_t)task);
+	/* Make the task ready to run, the service checks the handle is still alive */
+	int status = svc_call1(SCHEDULER_RESUME_SVC, handle);
 	if (status < 0)
 		errno = -status;
 
@@ -1335,19 +2204,20 @@ int scheduler_resume(struct task *task)
 	return status;
 }
 
-int scheduler_terminate(struct task *task)
+int scheduler_terminate(unsigned long handle)
 {
 	/* Use the current task if needed */
-	if (!task)
-		task = scheduler_task();
+	unsigned long current = scheduler_task()->handle;
+	if (!handle)
+		handle = current;
 
-	if (scheduler_num_cores() > 1 && task != scheduler_task()) {
+	if (scheduler_num_cores() > 1 && handle != current) {
 		errno = EINVAL;
 		return -errno;
 	}
 
-	/* Forward */
-	int status = svc_call1(SCHEDULER_TERMINATE_SVC, (uint32_t)task);
+	/* Forward, the service checks the handle is still alive */
+	int status = svc_call1(SCHEDULER_TERMINATE_SVC, handle);
 	if (status < 0) {
 		errno = -status;
 		return status;
@@ -1363,6 +2233,7 @@ void scheduler_futex_init(struct futex *futex, long *value, unsigned long flags)
 	futex->marker = SCHEDULER_FUTEX_MARKER;
 	futex->value = value;
 	futex->flags = flags;
+	futex->deferred = 0;
 	sched_queue_init(&futex->waiters);
 	sched_list_init(&futex->owned);
 }
@@ -1391,25 +2262,11 @@ int scheduler_futex_wake(struct futex *futex, bool all)
 			return -EINVAL;
 		}
 
-		/* Find an empty slot */
-		unsigned long expected = 0;
-		unsigned long wakeup = (unsigned long)futex | all;
-		for (int i = 0; i < SCHEDULER_MAX_DEFERED_WAKE; ++i) {
-			/* The second clause protects from multiple wakeups against the same futex */
-			if (atomic_compare_exchange_strong(&cls_datum(deferred_wake)[i], &expected, wakeup)) {
-				++cls_datum(given_wake_counter);
-				scheduler_request_switch(scheduler_current_core());
-				return 0;
-			} else if (expected == wakeup)
-				return 0;
-
-			/* Get ready to try the next slot */
-			expected = 0;
-		}
-
-		/* Very bad, resource exhausted */
-		errno = ENOSPC;
-		return -ENOSPC;
+		/* Queue on the deferred wake ring, very bad if resource exhausted */
+		int status = scheduler_defer_wake(futex, all);
+		if (status < 0)
+			errno = -status;
+		return status;
 	}
 
 	/* Send to the wake service */
@@ -1420,7 +2277,29 @@ int scheduler_futex_wake(struct futex *futex, bool all)
 	return status;
 }
 
-int scheduler_set_priority(struct task *task, unsigned long priority)
+int scheduler_futex_requeue(struct futex *from, struct futex *to, unsigned long nr_wake, unsigned long nr_requeue)
+{
+	assert(from != 0 && from->marker == SCHEDULER_FUTEX_MARKER && to != 0 && to->marker == SCHEDULER_FUTEX_MARKER);
+
+	/* Ownership can not be moved between futexes */
+	if ((from->flags & (SCHEDULER_FUTEX_PI | SCHEDULER_FUTEX_OWNER_TRACKING)) != 0 || from == to) {
+		errno = EINVAL;
+		return -EINVAL;
+	}
+
+	/* Both wait queues must be locked, from an interrupt fall back to a deferred wake */
+	if (is_interrupt_context())
+		return scheduler_futex_wake(from, nr_wake + nr_requeue > 1);
+
+	/* Send to the requeue service */
+	int status = svc_call4(SCHEDULER_REQUEUE_SVC, (uint32_t)from, (uint32_t)to, nr_wake, nr_requeue);
+	if (status < 0)
+		errno = -status;
+
+	return status;
+}
+
+int scheduler_set_priority(unsigned long handle, unsigned long priority)
 {
 	/* Range check the new priority */
 	if (priority > SCHEDULER_MIN_TASK_PRIORITY) {
@@ -1429,20 +2308,145 @@ int scheduler_set_priority(struct task *task, unsigned long priority)
 	}
 
 	/* Use the current task if needed */
-	if (!task)
-		task = scheduler_task();
+	if (!handle)
+		handle = scheduler_task()->handle;
 
-	/* Forward to the service handler */
-	return svc_call2(SCHEDULER_PRIORITY_SVC, (uint32_t)task, priority);
+	/* Forward to the service handler, which checks the handle is still alive */
+	return svc_call2(SCHEDULER_PRIORITY_SVC, handle, priority);
 }
 
-unsigned long scheduler_get_priority(struct task *task)
+unsigned long scheduler_get_priority(unsigned long handle)
 {
 	/* Use the current task if needed */
-	if (!task)
-		task = scheduler_task();
+	if (!handle)
+		return scheduler_task()->current_priority;
+
+	/* Read it while the handle can not be released */
+	unsigned long priority = UINT32_MAX;
+	unsigned long state = scheduler_enter_critical();
+	struct task *task = scheduler_task_alive(handle);
+	if (task)
+		priority = task->current_priority;
+	scheduler_exit_critical(state);
+
+	return priority;
+}
+
+static bool sched_ceiling_update(struct task *task)
+{
+	assert(task != 0 && task == scheduler_task());
+
+	/* Inheritance boosts live under the kernel lock, as does any write already in flight from the other core */
+	__DMB();
+	unsigned long sequence = task->priority_sequence;
+	if ((sequence & 1) || !sched_list_empty(&task->owned_futexes))
+		return false;
+
+	/* The running task is in no queue, a plain write will do */
+	task->current_priority = task->ceiling_priority < task->base_priority ? task->ceiling_priority : task->base_priority;
+
+	/* A remote write after this point sees our priority, one before it means the kernel lock must sort it out */
+	__DMB();
+	return task->priority_sequence == sequence;
+}
+
+static void sched_ceiling_settle(struct task *task, bool updated, unsigned long previous)
+{
+	bool preempt = false;
+
+	/* Lost a race with a remote priority change, recompute everything under the kernel lock */
+	if (!updated) {
+		unsigned long state = scheduler_enter_critical();
+		sched_task_recompute(task);
+		preempt = sched_queue_highest_priority(sched_ready_queue(scheduler_current_core())) < task->current_priority;
+		scheduler_exit_critical(state);
+
+	/* Only a drop can let a ready task in, the fifo bitmap can be peeked at without the kernel lock */
+	} else if (task->current_priority > previous) {
+#if SCHEDULER_BITMAP_QUEUE > 0
+		preempt = sched_queue_highest_priority(sched_ready_queue(scheduler_current_core())) < task->current_priority;
+#else
+		unsigned long state = scheduler_enter_critical();
+		preempt = sched_queue_highest_priority(sched_ready_queue(scheduler_current_core())) < task->current_priority;
+		scheduler_exit_critical(state);
+#endif
+	}
+
+	/* Preempt if something we held off is now ready */
+	if (preempt)
+		scheduler_request_switch(scheduler_current_core());
+}
+
+static void sched_ceiling_drop(struct task *task, struct sched_ceiling *ceiling)
+{
+	assert(task != 0 && ceiling != 0);
+
+	/* Recompute the highest ceiling still held */
+	sched_list_remove(&ceiling->node);
+	ceiling->task = 0;
+	unsigned long ceiling_priority = SCHEDULER_NUM_TASK_PRIORITIES;
+	struct sched_ceiling *held;
+	sched_list_for_each_entry(held, &task->held_ceilings, node)
+		if (held->priority < ceiling_priority)
+			ceiling_priority = held->priority;
+	task->ceiling_priority = ceiling_priority;
+}
+
+void scheduler_raise_priority(struct sched_ceiling *ceiling)
+{
+	assert(ceiling != 0);
+
+	/* Only the owner ever touches its ceilings, masking interrupts on this core is enough */
+	struct task *task = scheduler_task();
+	uint32_t state = disable_interrupts();
+	ceiling->task = task;
+	sched_list_add(&task->held_ceilings, &ceiling->node);
+	if (ceiling->priority < task->ceiling_priority)
+		task->ceiling_priority = ceiling->priority;
+	unsigned long previous = task->current_priority;
+	bool updated = sched_ceiling_update(task);
+	enable_interrupts(state);
+
+	/* A raise never preempts, this only catches a lost race */
+	sched_ceiling_settle(task, updated, previous);
+}
+
+void scheduler_move_ceiling(struct sched_ceiling *from, struct sched_ceiling *to)
+{
+	assert(from != 0 && to != 0 && from->priority == to->priority);
+
+	/* Same task and same priority, only the node tracking it changes */
+	uint32_t state = disable_interrupts();
+	to->task = from->task;
+	from->task = 0;
+	sched_list_remove(&from->node);
+	sched_list_add(&to->task->held_ceilings, &to->node);
+	enable_interrupts(state);
+}
+
+void scheduler_restore_priority(struct sched_ceiling *ceiling)
+{
+	assert(ceiling != 0 && ceiling->task != 0);
+
+	/* A robust release takes the ceiling off a dead owner, only the kernel lock covers someone else's ceilings */
+	struct task *task = ceiling->task;
+	if (task != scheduler_task()) {
+		unsigned long state = scheduler_enter_critical();
+		sched_ceiling_drop(task, ceiling);
+		sched_task_recompute(task);
+		scheduler_exit_critical(state);
+		return;
+	}
+
+	/* Drop our own ceiling locally, other ceilings may still apply so never restore a snapshot */
+	uint32_t state = disable_interrupts();
+	sched_ceiling_drop(task, ceiling);
+	unsigned long previous = task->current_priority;
+	bool updated = sched_ceiling_update(task);
+	enable_interrupts(state);
 
-	return task->current_priority;
+	/* Inheritance boosts are kept by the locked recompute */
+	sched_ceiling_settle(task, updated, previous);
 }
 
 void scheduler_set_flags(struct task *task, unsigned long mask)
@@ -125,7 +125,13 @@ static int _cnd_wait(cnd_t *cnd, mtx_t *mtx, unsigned long msec)
 
 	mtx_unlock(cnd->mutex);
 	int status = scheduler_futex_wait(&cnd->futex, sequence, msec);
-	mtx_lock(cnd->mutex);
+
+	/* A broadcast may have requeued us onto the mutex, in which case the unlock already handed it to us */
+	if ((long)scheduler_task() == (long)(cnd->mutex->value & ~SCHEDULER_FUTEX_CONTENTION_TRACKING)) {
+		if (cnd->mutex->type & mtx_recursive)
+			cnd->mutex->count = 1;
+	} else
+		mtx_lock(cnd->mutex);
 
 	/* Did we timeout or have an error */
 	if (status < 0) {
@@ -162,8 +168,12 @@ static int _cnd_wakeup(struct cnd *cnd, bool all)
 	/* We are waking someone up */
 	atomic_fetch_add(&cnd->sequence, 1);
 
-	/* Wake some waiters */
-	scheduler_futex_wake(&cnd->futex, all);
+	/* Move broadcast waiters straight to the mutex, each unlock then hands it to the next waiter */
+	struct mtx *mutex = cnd->mutex;
+	if (all && mutex)
+		scheduler_futex_requeue(&cnd->futex, &mutex->futex, 0, UINT32_MAX);
+	else
+		scheduler_futex_wake(&cnd->futex, all);
 
 	/* March on */
 	return thrd_success;
@@ -493,6 +503,10 @@ int	_thrd_create(thrd_t *thrd, int (*func)(void *), void *arg, thrd_attr_t *attr
 	desc.flags = attr->flags;
 	desc.priority = attr->priority;
 	desc.affinity = attr->affinity;
+	desc.quantum = 0;
+	desc.period = 0;
+	desc.deadline = 0;
+	desc.budget = 0;
 
 	/* Carefully add to the threads list for clean up */
 	if (mtx_lock(&thrds_lock) != thrd_success)
@@ -5,13 +5,16 @@
  *      Author: Stephen Street (stephen@redrocketcomputing.com)
  */
 
+#include <assert.h>
 #include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 #include <compiler.h>
 #include <config.h>
 
 #include <cmsis/rp2040.h>
+#include <sys/atomic-locks.h>
 
 #if ATOMIC_IN_RAM == 0
 #undef __fast_section
@@ -20,25 +23,63 @@
 
 /* Must be powers of 2 */
 #define ATOMIC_STRIPE 4UL
-#define ATOMIC_HW_LOCKS 32UL
+#define ATOMIC_PINNED_SLOT 8UL
+
+/* Fibonacci hashing constant, 2^32 / golden ratio */
+#define ATOMIC_LOCK_HASH 0x9e3779b1UL
 
-#define ATOMIC_HW_LOCK_INDEX 0UL
 #define ATOMIC_LOCK_IDX_Pos (32 - __builtin_clz(ATOMIC_STRIPE - 1))
-#define ATOMIC_LOCK_IDX_Msk (ATOMIC_HW_LOCKS - 1UL)
+#define ATOMIC_PINNED_IDX_Pos (32 - __builtin_clz(ATOMIC_PINNED_SLOT - 1))
 
-#define HW_LOCK_PTR(addr) (locks + ((((uintptr_t)addr) >> ATOMIC_LOCK_IDX_Pos) & ATOMIC_LOCK_IDX_Msk))
+#define HW_LOCK_PTR(addr) (locks + __atomic_lock_index(addr))
 
 void __atomic_init(void);
 
+extern char __atomic_pinned_start__[];
+extern char __atomic_pinned_end__[];
+
 static volatile uint32_t *locks = &SIO->SPINLOCK0 + ATOMIC_HW_LOCK_INDEX;
 
+#if ATOMIC_STATS > 0
+static struct atomic_lock_stats lock_stats[ATOMIC_LOCK_COUNT];
+#endif
+
+static __optimize __always_inline inline unsigned int __atomic_lock_index(const volatile void *mem)
+{
+#if ATOMIC_PINNED_LOCKS > 0
+	/* Pinned objects use the lock matching their slot, a single unsigned compare covers both ends */
+	uintptr_t offset = (uintptr_t)mem - (uintptr_t)__atomic_pinned_start__;
+	if (unlikely(offset < (uintptr_t)(__atomic_pinned_end__ - __atomic_pinned_start__)))
+		return ATOMIC_HW_LOCKS + (offset >> ATOMIC_PINNED_IDX_Pos);
+#endif
+
+	/* Everything else is hashed and then scaled into the striped locks, two single cycle multiplies */
+	uint32_t hash = ((uint32_t)((uintptr_t)mem >> ATOMIC_LOCK_IDX_Pos) * ATOMIC_LOCK_HASH) >> 16;
+	return (hash * ATOMIC_HW_LOCKS) >> 16;
+}
+
 static __optimize __always_inline inline uint32_t __atomic_lock(const volatile void *mem)
 {
 	volatile uint32_t *const hw_lock = HW_LOCK_PTR(mem);
 
 	uint32_t state = disable_interrupts();
+#if ATOMIC_STATS > 0
+	/* The counters are protected by the lock they count */
+	unsigned long spins = 0;
+	while (unlikely(*hw_lock == 0))
+		++spins;
+	__DMB();
+
+	struct atomic_lock_stats *stats = &lock_stats[__atomic_lock_index(mem)];
+	++stats->acquired;
+	if (spins) {
+		++stats->contended;
+		stats->spins += spins;
+	}
+#else
 	while (unlikely(*hw_lock == 0));
 	__DMB();
+#endif
 
 	return state;
 }
@@ -352,8 +393,38 @@ __fast_section __optimize void __atomic_store_8(volatile void *mem, uint64_t val
 //	__DMB();
 //}
 
+unsigned int atomic_lock_index(const volatile void *obj)
+{
+	return __atomic_lock_index(obj);
+}
+
+void atomic_get_lock_stats(unsigned int lock, struct atomic_lock_stats *stats)
+{
+	assert(lock < ATOMIC_LOCK_COUNT && stats != 0);
+
+#if ATOMIC_STATS > 0
+	/* A snapshot is good enough */
+	memcpy(stats, &lock_stats[lock], sizeof(struct atomic_lock_stats));
+#else
+	memset(stats, 0, sizeof(struct atomic_lock_stats));
+#endif
+}
+
+void atomic_reset_lock_stats(void)
+{
+#if ATOMIC_STATS > 0
+	memset(lock_stats, 0, sizeof(lock_stats));
+#endif
+}
+
 void __atomic_init(void)
 {
-	for (size_t i = ATOMIC_HW_LOCK_INDEX; i < ATOMIC_HW_LOCKS; ++i)
-		locks[i] = 0;
+	static_assert(ATOMIC_HW_LOCKS > 0 && ATOMIC_HW_LOCKS <= ATOMIC_SIO_LOCKS, "no hardware locks left to stripe");
+
+	/* Hand sections.ld the size of the pinned area so its check follows ATOMIC_PINNED_LOCKS */
+	__asm__ volatile (".global __atomic_pinned_size__\n\t.equ __atomic_pinned_size__, %c0" : : "i" (ATOMIC_PINNED_LOCKS * ATOMIC_PINNED_SLOT));
+
+	/* The hardware locks survive a core reset, release all of them including the ones handed out by sys/spinlock.h */
+	for (size_t i = 0; i < 32UL; ++i)
+		(&SIO->SPINLOCK0)[i] = 0;
 }
@@ -36,6 +36,11 @@
 #define LOGGER_STACK_SIZE 1024
 #endif
 
+/* How often the task looks for deferred binary syslog records, in kernel ticks */
+#ifndef LOGGER_BINARY_POLL
+#define LOGGER_BINARY_POLL 10
+#endif
+
 struct logger_msg
 {
 	size_t count;
@@ -166,10 +171,20 @@ static void logger_task(void *context)
 	/* While still running */
 	while (logger->run) {
 
+		uint32_t timeout = osWaitForever;
+
+#if SYSLOG_BINARY > 0
+		/* Format deferred records while there are message buffers for them, the text comes back through the queue */
+		unsigned int space = osMemoryPoolGetSpace(logger->msg_pool);
+		if (space > 1)
+			syslog_binary_drain(stddiag, space / 2);
+		timeout = LOGGER_BINARY_POLL;
+#endif
+
 		/* Wait for msg */
-		osStatus_t os_status = osDequeGetFront(logger->msg_queue, &msg, osWaitForever);
+		osStatus_t os_status = osDequeGetFront(logger->msg_queue, &msg, timeout);
 		if (os_status != osOK) {
-			if (os_status == osErrorResource)
+			if (os_status == osErrorResource || os_status == osErrorTimeout)
 				continue;
 			syslog_fatal("unknown failure getting message from queue: %d\n", os_status);
 		}
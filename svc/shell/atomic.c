@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * atomic.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+
+#include <compiler.h>
+#include <sys/atomic-locks.h>
+
+#include <svc/shell.h>
+
+static int atomic_main(int argc, char **argv)
+{
+	char c;
+	int opt_index = 0;
+	bool reset = false;
+
+	struct option long_options[] =
+	{
+		{
+			.name = "reset",
+			.has_arg = no_argument,
+			.flag = 0,
+			.val = 'r',
+		},
+	};
+
+	optind = 0;
+	while ((c = getopt_long(argc, argv, ":r", long_options, &opt_index)) != -1) {
+
+		switch (c) {
+			case 'r':
+				reset = true;
+				break;
+			default: {
+				printf("unknown options\n");
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	/* Nothing to show */
+	if (ATOMIC_STATS == 0) {
+		printf("build with ATOMIC_STATS=1 for atomic lock statistics\n");
+		return EXIT_SUCCESS;
+	}
+
+	/* Only the locks which have been used */
+	printf("%-4s %-7s %10s %10s %12s\n", "LOCK", "KIND", "ACQUIRED", "CONTENDED", "SPINS");
+	for (unsigned int i = 0; i < ATOMIC_LOCK_COUNT; ++i) {
+		struct atomic_lock_stats stats;
+		atomic_get_lock_stats(i, &stats);
+		if (stats.acquired == 0)
+			continue;
+		printf("%-4u %-7s %10lu %10lu %12lu\n", i, i < ATOMIC_HW_LOCKS ? "striped" : "pinned", stats.acquired, stats.contended, stats.spins);
+	}
+
+	/* Start over if asked */
+	if (reset)
+		atomic_reset_lock_stats();
+
+	return EXIT_SUCCESS;
+}
+
+static __shell_command const struct shell_command atomic_cmd =
+{
+	.name = "atomic",
+	.usage = "[-r,--reset]",
+	.func = atomic_main,
+};
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * heap.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <compiler.h>
+#include <sys/heap.h>
+
+#include <svc/shell.h>
+
+static const char *const arena_names[HEAP_ARENA_COUNT] =
+{
+	[HEAP_ARENA_CORE0] = "core0",
+	[HEAP_ARENA_CORE1] = "core1",
+	[HEAP_ARENA_SHARED] = "shared",
+};
+
+static int heap_main(int argc, char **argv)
+{
+	struct tlsf_stats stats;
+
+	if (heap_get_stats(&stats) < 0) {
+		printf("heap statistics not available\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("total:         %lu\n", (unsigned long)stats.total);
+	printf("used:          %lu in %lu blocks\n", (unsigned long)stats.used, (unsigned long)stats.used_blocks);
+	printf("free:          %lu in %lu blocks\n", (unsigned long)stats.free, (unsigned long)stats.free_blocks);
+	printf("peak used:     %lu\n", (unsigned long)stats.peak_used);
+	printf("largest free:  %lu\n", (unsigned long)stats.largest_free);
+	printf("fragmentation: %u%%\n", stats.fragmentation);
+
+	printf("\n%-8s %8s %8s %8s %8s %8s %5s\n", "ARENA", "TOTAL", "USED", "FREE", "PEAK", "LARGEST", "FRAG");
+	for (unsigned int i = 0; i < HEAP_ARENA_COUNT; ++i) {
+		if (heap_get_arena_stats(i, &stats) < 0)
+			continue;
+		printf("%-8s %8lu %8lu %8lu %8lu %8lu %4u%%\n", arena_names[i], (unsigned long)stats.total, (unsigned long)stats.used, (unsigned long)stats.free, (unsigned long)stats.peak_used, (unsigned long)stats.largest_free, stats.fragmentation);
+	}
+
+	return EXIT_SUCCESS;
+}
+
+static __shell_command const struct shell_command heap_cmd =
+{
+	.name = "heap",
+	.usage = "",
+	.func = heap_main,
+};
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * top.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+
+#include <compiler.h>
+#include <rtos/rtos.h>
+#include <sys/timestamp.h>
+
+#include <svc/shell.h>
+
+#define TOP_DEFAULT_DELAY 1000UL
+
+struct top_sample
+{
+	osThreadId_t id;
+	bool valid;
+	osThreadStats_t first;
+	osThreadStats_t second;
+};
+
+static const char *top_state_str(osThreadState_t state)
+{
+	switch (state) {
+		case osThreadReady:
+			return "ready";
+		case osThreadRunning:
+			return "run";
+		case osThreadBlocked:
+			return "block";
+		case osThreadTerminated:
+			return "term";
+		default:
+			return "?";
+	}
+}
+
+static unsigned long top_permille(uint64_t part, uint64_t whole)
+{
+	return whole > 0 ? (unsigned long)((part * 1000ULL) / whole) : 0;
+}
+
+static int top_main(int argc, char **argv)
+{
+	char c;
+	int opt_index = 0;
+	unsigned long delay = TOP_DEFAULT_DELAY;
+	uint64_t idle[SystemNumCores];
+
+	struct option long_options[] =
+	{
+		{
+			.name = "delay",
+			.has_arg = required_argument,
+			.flag = 0,
+			.val = 'd',
+		},
+	};
+
+	optind = 0;
+	while ((c = getopt_long(argc, argv, ":d:", long_options, &opt_index)) != -1) {
+
+		switch (c) {
+			case 'd': {
+				errno = 0;
+				char *end;
+				delay = strtoul(optarg, &end, 0);
+				if (errno != 0 || end == optarg || delay == 0) {
+					printf("bad delay: '%s'\n", optarg);
+					return EXIT_FAILURE;
+				}
+				break;
+			}
+			default: {
+				printf("unknown options\n");
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	/* The statistics are only kept when the scheduler is built with SCHEDULER_RUNTIME_STATS */
+	osThreadStats_t probe;
+	if (osThreadGetStats(osThreadGetId(), &probe) != osOK) {
+		printf("runtime statistics not enabled\n");
+		return EXIT_FAILURE;
+	}
+
+	/* Capture the threads */
+	uint32_t count = osThreadGetCount();
+	struct top_sample *samples = calloc(count, sizeof(struct top_sample));
+	osThreadId_t *ids = calloc(count, sizeof(osThreadId_t));
+	if (!samples || !ids) {
+		printf("out of memory\n");
+		free(ids);
+		free(samples);
+		return EXIT_FAILURE;
+	}
+	count = osThreadEnumerate(ids, count);
+
+	/* First sample */
+	for (uint32_t i = 0; i < count; ++i) {
+		samples[i].id = ids[i];
+		samples[i].valid = osThreadGetStats(ids[i], &samples[i].first) == osOK;
+	}
+	for (uint32_t core = 0; core < SystemNumCores; ++core)
+		idle[core] = osKernelGetIdleTime(core);
+	uint64_t start = timestamp();
+
+	/* Let things run */
+	osDelay(delay * osKernelGetTickFreq() / 1000UL);
+
+	/* Second sample, threads which have gone away are dropped */
+	for (uint32_t i = 0; i < count; ++i)
+		if (samples[i].valid)
+			samples[i].valid = osThreadGetStats(samples[i].id, &samples[i].second) == osOK;
+	uint64_t elapsed = timestamp() - start;
+
+	/* Report the cores */
+	for (uint32_t core = 0; core < SystemNumCores; ++core) {
+		unsigned long permille = top_permille(osKernelGetIdleTime(core) - idle[core], elapsed);
+		printf("core %lu: idle %lu.%lu%%\n", (unsigned long)core, permille / 10, permille % 10);
+	}
+
+	/* Then the threads, cpu is the share of a single core over the sample */
+	printf("%-20s %-5s %4s %6s %10s %8s %8s %8s\n", "NAME", "STATE", "PRIO", "CPU%", "TIME(ms)", "SWITCH", "PREEMPT", "WAIT");
+	for (uint32_t i = 0; i < count; ++i) {
+
+		if (!samples[i].valid)
+			continue;
+
+		osThreadStats_t *first = &samples[i].first;
+		osThreadStats_t *second = &samples[i].second;
+		unsigned long permille = top_permille(second->run_time - first->run_time, elapsed);
+
+		printf("%-20.20s %-5s %4d %4lu.%lu %10lu %8lu %8lu %8lu\n",
+			osThreadGetName(samples[i].id), top_state_str(osThreadGetState(samples[i].id)), osThreadGetPriority(samples[i].id),
+			permille / 10, permille % 10, (unsigned long)(second->run_time / 1000ULL),
+			(unsigned long)(second->switches - first->switches), (unsigned long)(second->preemptions - first->preemptions),
+			(unsigned long)(second->futex_waits - first->futex_waits));
+	}
+
+	/* All done */
+	free(ids);
+	free(samples);
+	return EXIT_SUCCESS;
+}
+
+static __shell_command const struct shell_command top_cmd =
+{
+	.name = "top",
+	.usage = "[-d,--delay <msec>]",
+	.func = top_main,
+};
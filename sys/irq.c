@@ -5,6 +5,7 @@
 #include <compiler.h>
 #include <init/init-sections.h>
 #include <sys/irq.h>
+#include <sys/trace.h>
 
 struct irq_entry
 {
@@ -18,6 +19,18 @@ static __isr_section __optimize void irq_default_handler(IRQn_Type irq, void *co
 
 struct irq_entry irq_dispatch[IRQ_NUM] = { [0 ... IRQ_NUM - 1] = { .handler = irq_default_handler, .context = 0 } };
 
+#if SYS_TRACE > 0
+void trace_irq_dispatch(IRQn_Type irq, void *context, irq_handler_t handler);
+
+/* The vector default handler comes through here instead of jumping straight to the handler */
+__isr_section void trace_irq_dispatch(IRQn_Type irq, void *context, irq_handler_t handler)
+{
+	trace_event(TRACE_IRQ_ENTER, irq + 16, handler);
+	handler(irq, context);
+	trace_event(TRACE_IRQ_EXIT, irq + 16, handler);
+}
+#endif
+
 __weak void irq_register(IRQn_Type irq, uint32_t priority, irq_handler_t handler, void *context)
 {
 	assert(irq <= __LAST_IRQN);
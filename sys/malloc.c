@@ -0,0 +1,343 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * malloc.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ */
+
+#include <errno.h>
+#include <malloc.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/heap.h>
+#include <sys/spinlock.h>
+
+#if HEAP_TLSF > 0
+
+extern uintptr_t __heap_end;
+
+#if HEAP_PER_CORE_ARENAS > 0
+extern uintptr_t __heap_0_start;
+extern uintptr_t __heap_0_end;
+extern uintptr_t __heap_1_start;
+extern uintptr_t __heap_1_end;
+#endif
+
+struct heap_remote
+{
+	struct heap_remote *next;
+};
+
+struct heap_arena
+{
+	struct tlsf tlsf;
+	spinlock_t lock;
+	atomic_uintptr_t remote;
+	uintptr_t start;
+	uintptr_t end;
+};
+
+static struct heap_arena heap_arenas[HEAP_ARENA_COUNT];
+static atomic_int heap_state = 0;
+
+static void heap_arena_init(struct heap_arena *arena, void *start, size_t size)
+{
+	/* A missing or tiny bank just leaves the arena disabled */
+	if (tlsf_init(&arena->tlsf, start, size) < 0)
+		return;
+
+	arena->start = (uintptr_t)start;
+	arena->end = (uintptr_t)start + size;
+}
+
+static void heap_init(void)
+{
+	/* All ready done */
+	if (atomic_load(&heap_state) == 2)
+		return;
+
+	/* Try to claim the initializer, the loser waits for it to finish */
+	int expected = 0;
+	if (!atomic_compare_exchange_strong(&heap_state, &expected, 1)) {
+		while (atomic_load(&heap_state) != 2);
+		return;
+	}
+
+	/* Claim whatever sbrk has not handed out yet so the two never overlap */
+	void *start = sbrk(0);
+	if (start == (void *)-1)
+		abort();
+	size_t size = ((uintptr_t)&__heap_end - (uintptr_t)start) & ~7UL;
+	if (sbrk(size) == (void *)-1)
+		abort();
+	heap_arena_init(&heap_arenas[HEAP_ARENA_SHARED], start, size);
+	if (!heap_arenas[HEAP_ARENA_SHARED].end)
+		abort();
+
+#if HEAP_PER_CORE_ARENAS > 0
+	/* The core arenas own their banks outright */
+	heap_arena_init(&heap_arenas[HEAP_ARENA_CORE0], &__heap_0_start, ((uintptr_t)&__heap_0_end - (uintptr_t)&__heap_0_start) & ~7UL);
+	heap_arena_init(&heap_arenas[HEAP_ARENA_CORE1], &__heap_1_start, ((uintptr_t)&__heap_1_end - (uintptr_t)&__heap_1_start) & ~7UL);
+#endif
+
+	/* Ready */
+	atomic_store(&heap_state, 2);
+}
+
+static struct heap_arena *heap_arena_of(const void *ptr)
+{
+	for (unsigned int i = 0; i < HEAP_ARENA_COUNT; ++i)
+		if ((uintptr_t)ptr >= heap_arenas[i].start && (uintptr_t)ptr < heap_arenas[i].end)
+			return &heap_arenas[i];
+	return 0;
+}
+
+static bool heap_arena_is_local(const struct heap_arena *arena)
+{
+	/* Must be called with the interrupts disabled so the answer does not change under us */
+	return arena == &heap_arenas[HEAP_ARENA_SHARED] || arena == &heap_arenas[SIO->CPUID];
+}
+
+static void heap_arena_drain(struct heap_arena *arena)
+{
+	/* Cheap check first, the exchange takes a hardware lock */
+	if (!atomic_load(&arena->remote))
+		return;
+
+	/* Take the whole list at once and give the blocks back to the arena */
+	struct heap_remote *block = (struct heap_remote *)atomic_exchange(&arena->remote, 0);
+	while (block) {
+		struct heap_remote *next = block->next;
+		tlsf_free(&arena->tlsf, block);
+		block = next;
+	}
+}
+
+static void heap_arena_remote_free(struct heap_arena *arena, void *ptr)
+{
+	/* Push onto the owners list, it is drained the next time the owner allocates */
+	struct heap_remote *block = ptr;
+	uintptr_t head = atomic_load(&arena->remote);
+	do {
+		block->next = (struct heap_remote *)head;
+	} while (!atomic_compare_exchange_weak(&arena->remote, &head, (uintptr_t)block));
+}
+
+static void *heap_alloc(size_t alignment, size_t size)
+{
+	heap_init();
+
+	/* Try this cores arena first, the interrupts are disabled before looking up the core so we can not migrate */
+	void *ptr = 0;
+	unsigned int state = disable_interrupts();
+	struct heap_arena *arena = &heap_arenas[SIO->CPUID];
+	if (arena->end) {
+
+		/* Only the statistics ever contend for the arena lock */
+		spin_lock(&arena->lock);
+		heap_arena_drain(arena);
+		ptr = alignment ? tlsf_memalign(&arena->tlsf, alignment, size) : tlsf_malloc(&arena->tlsf, size);
+		spin_unlock(&arena->lock);
+	}
+	enable_interrupts(state);
+	if (ptr)
+		return ptr;
+
+	/* Fall back to the shared heap, every TLSF operation is bounded so the interrupts are only held off briefly */
+	arena = &heap_arenas[HEAP_ARENA_SHARED];
+	state = spin_lock_irqsave(&arena->lock);
+	ptr = alignment ? tlsf_memalign(&arena->tlsf, alignment, size) : tlsf_malloc(&arena->tlsf, size);
+	spin_unlock_irqrestore(&arena->lock, state);
+
+	if (!ptr)
+		errno = ENOMEM;
+	return ptr;
+}
+
+void *malloc(size_t size)
+{
+	return heap_alloc(0, size);
+}
+
+void free(void *ptr)
+{
+	if (!ptr)
+		return;
+
+	/* Not one of ours */
+	struct heap_arena *arena = heap_arena_of(ptr);
+	if (!arena)
+		abort();
+
+	/* Release directly into our own arena or the shared heap, hand blocks from the other core back to it */
+	unsigned int state = disable_interrupts();
+	if (heap_arena_is_local(arena)) {
+		spin_lock(&arena->lock);
+		tlsf_free(&arena->tlsf, ptr);
+		spin_unlock(&arena->lock);
+	} else
+		heap_arena_remote_free(arena, ptr);
+	enable_interrupts(state);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+	/* Check for overflow */
+	size_t total;
+	if (__builtin_mul_overflow(nmemb, size, &total)) {
+		errno = ENOMEM;
+		return 0;
+	}
+
+	/* Clear outside of the lock */
+	void *ptr = malloc(total);
+	if (ptr)
+		memset(ptr, 0, total);
+	return ptr;
+}
+
+void *realloc(void *ptr, size_t size)
+{
+	/* The edge cases */
+	if (!ptr)
+		return malloc(size);
+	if (size == 0) {
+		free(ptr);
+		return 0;
+	}
+
+	/* Not one of ours */
+	struct heap_arena *arena = heap_arena_of(ptr);
+	if (!arena)
+		abort();
+
+	/* Try in place first, only possible when we own the arena */
+	void *new_ptr = 0;
+	unsigned int state = disable_interrupts();
+	if (heap_arena_is_local(arena)) {
+		spin_lock(&arena->lock);
+		new_ptr = tlsf_resize(&arena->tlsf, ptr, size);
+		spin_unlock(&arena->lock);
+	}
+	enable_interrupts(state);
+	if (new_ptr)
+		return new_ptr;
+
+	/* Move it, copying outside of the lock */
+	new_ptr = malloc(size);
+	if (!new_ptr)
+		return 0;
+	size_t current = tlsf_usable_size(ptr);
+	memcpy(new_ptr, ptr, current < size ? current : size);
+	free(ptr);
+
+	return new_ptr;
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+	return heap_alloc(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+	return memalign(alignment, size);
+}
+
+int posix_memalign(void **memptr, size_t alignment, size_t size)
+{
+	/* Must be a power of two multiple of a pointer */
+	if (alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0)
+		return EINVAL;
+
+	void *ptr = memalign(alignment, size);
+	if (!ptr)
+		return ENOMEM;
+
+	*memptr = ptr;
+	return 0;
+}
+
+size_t malloc_usable_size(void *ptr)
+{
+	return tlsf_usable_size(ptr);
+}
+
+int heap_get_arena_stats(unsigned int arena, struct tlsf_stats *stats)
+{
+	if (arena >= HEAP_ARENA_COUNT || !stats) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	heap_init();
+
+	/* Disabled arena */
+	if (!heap_arenas[arena].end) {
+		errno = ENOENT;
+		return -1;
+	}
+
+	/* Blocks waiting on the remote list are still counted as used */
+	unsigned int state = spin_lock_irqsave(&heap_arenas[arena].lock);
+	tlsf_get_stats(&heap_arenas[arena].tlsf, stats);
+	spin_unlock_irqrestore(&heap_arenas[arena].lock, state);
+
+	return 0;
+}
+
+int heap_get_stats(struct tlsf_stats *stats)
+{
+	if (!stats) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* Combine all the enabled arenas, the peak is the sum of the arena peaks */
+	memset(stats, 0, sizeof(*stats));
+	for (unsigned int i = 0; i < HEAP_ARENA_COUNT; ++i) {
+
+		struct tlsf_stats arena_stats;
+		if (heap_get_arena_stats(i, &arena_stats) < 0)
+			continue;
+
+		stats->total += arena_stats.total;
+		stats->used += arena_stats.used;
+		stats->free += arena_stats.free;
+		stats->peak_used += arena_stats.peak_used;
+		stats->used_blocks += arena_stats.used_blocks;
+		stats->free_blocks += arena_stats.free_blocks;
+		if (arena_stats.largest_free > stats->largest_free)
+			stats->largest_free = arena_stats.largest_free;
+	}
+	stats->fragmentation = stats->free ? 100 - (unsigned int)((uint64_t)stats->largest_free * 100 / stats->free) : 0;
+
+	return 0;
+}
+
+#else
+
+int heap_get_arena_stats(unsigned int arena, struct tlsf_stats *stats)
+{
+	errno = ENOSYS;
+	return -1;
+}
+
+int heap_get_stats(struct tlsf_stats *stats)
+{
+	errno = ENOSYS;
+	return -1;
+}
+
+#endif
@@ -1,7 +1,16 @@
 #include <compiler.h>
+#include <assert.h>
+#include <stdarg.h>
+#include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
+
+#include <config.h>
+#include <init/init-sections.h>
+#include <cmsis/cmsis.h>
 
 #include <sys/backtrace.h>
+#include <sys/timestamp.h>
 #include <diag/diag.h>
 
 #include <sys/syslog.h>
@@ -47,3 +56,378 @@ __weak void syslog(int level, const char *fmt, ...)
 	/* All done */
 	va_end(args);
 }
+
+#if SYSLOG_BINARY > 0
+
+static_assert((SYSLOG_BINARY_WORDS & (SYSLOG_BINARY_WORDS - 1)) == 0, "SYSLOG_BINARY_WORDS must be a power of 2");
+
+#define SYSLOG_RECORD_HEADER_WORDS (sizeof(struct syslog_record) / sizeof(uint32_t))
+
+/* What a conversion takes from the argument list, host-tools/syslog-decode follows the same rules */
+enum syslog_arg
+{
+	SYSLOG_ARG_NONE,
+	SYSLOG_ARG_WORD,
+	SYSLOG_ARG_DWORD,
+	SYSLOG_ARG_DOUBLE,
+	SYSLOG_ARG_POINTER,
+	SYSLOG_ARG_STRING,
+};
+
+struct syslog_spec
+{
+	enum syslog_arg arg;
+	unsigned int stars;
+	char text[16];
+};
+
+extern const char __syslog_fmt_start__[];
+extern const char __syslog_fmt_end__[];
+
+static struct syslog_ring syslog_rings[SystemNumCores];
+static uint32_t syslog_reported[SystemNumCores];
+
+/* Parse the conversion following a '%', returns the character after it or 0 when it is not supported */
+static __fast_section const char *syslog_parse_spec(const char *fmt, struct syslog_spec *spec)
+{
+	unsigned int len = 0;
+	bool dword = false;
+
+	spec->text[len++] = '%';
+	spec->stars = 0;
+
+	/* Flags, width and precision are kept as is */
+	while (*fmt != 0 && strchr("-+ #0123456789.*", *fmt) != 0) {
+		if (len >= sizeof(spec->text) - 4)
+			return 0;
+		if (*fmt == '*')
+			++spec->stars;
+		spec->text[len++] = *fmt++;
+	}
+
+	/* Arguments are promoted to words, only the 64 bit length modifiers change what is recorded */
+	while (*fmt != 0 && strchr("hlLqjzt", *fmt) != 0) {
+		if (*fmt == 'h' && len < sizeof(spec->text) - 4)
+			spec->text[len++] = 'h';
+		else if ((*fmt == 'l' && fmt[1] == 'l') || *fmt == 'q' || *fmt == 'j')
+			dword = true;
+		fmt += *fmt == 'l' && fmt[1] == 'l' ? 2 : 1;
+	}
+	if (dword) {
+		spec->text[len++] = 'l';
+		spec->text[len++] = 'l';
+	}
+
+	switch (*fmt) {
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+		case 'c':
+			spec->arg = dword ? SYSLOG_ARG_DWORD : SYSLOG_ARG_WORD;
+			break;
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			spec->arg = SYSLOG_ARG_DOUBLE;
+			break;
+		case 'p':
+			spec->arg = SYSLOG_ARG_POINTER;
+			break;
+		case 's':
+			spec->arg = SYSLOG_ARG_STRING;
+			break;
+		case '%':
+			spec->arg = SYSLOG_ARG_NONE;
+			break;
+		default:
+			return 0;
+	}
+	spec->text[len++] = *fmt++;
+	spec->text[len] = 0;
+
+	return fmt;
+}
+
+/* Copy the arguments as raw words, strings are copied in and padded to a word, stops when the payload is full */
+static __fast_section unsigned int syslog_binary_pack(uint32_t *payload, const char *fmt, va_list args)
+{
+	struct syslog_spec spec;
+	unsigned int count = 0;
+
+	while ((fmt = strchr(fmt, '%')) != 0) {
+
+		fmt = syslog_parse_spec(fmt + 1, &spec);
+		if (!fmt)
+			break;
+
+		/* Star arguments come before the value */
+		for (unsigned int i = 0; i < spec.stars; ++i) {
+			if (count == SYSLOG_BINARY_MAX_PAYLOAD)
+				return count;
+			payload[count++] = va_arg(args, int);
+		}
+
+		switch (spec.arg) {
+			case SYSLOG_ARG_WORD:
+			case SYSLOG_ARG_POINTER: {
+				if (count == SYSLOG_BINARY_MAX_PAYLOAD)
+					return count;
+				payload[count++] = spec.arg == SYSLOG_ARG_WORD ? va_arg(args, unsigned int) : (uintptr_t)va_arg(args, void *);
+				break;
+			}
+			case SYSLOG_ARG_DWORD:
+			case SYSLOG_ARG_DOUBLE: {
+				if (count + 2 > SYSLOG_BINARY_MAX_PAYLOAD)
+					return count;
+				if (spec.arg == SYSLOG_ARG_DWORD) {
+					unsigned long long value = va_arg(args, unsigned long long);
+					memcpy(&payload[count], &value, sizeof(value));
+				} else {
+					double value = va_arg(args, double);
+					memcpy(&payload[count], &value, sizeof(value));
+				}
+				count += 2;
+				break;
+			}
+			case SYSLOG_ARG_STRING: {
+				const char *str = va_arg(args, const char *);
+				if (!str)
+					str = "(null)";
+				size_t len = strnlen(str, SYSLOG_BINARY_MAX_STRING);
+				unsigned int words = len / sizeof(uint32_t) + 1;
+				if (count + words > SYSLOG_BINARY_MAX_PAYLOAD)
+					return count;
+				payload[count + words - 1] = 0;
+				memcpy(&payload[count], str, len);
+				count += words;
+				break;
+			}
+			case SYSLOG_ARG_NONE:
+				break;
+		}
+	}
+
+	return count;
+}
+
+__fast_section void syslog_binary(int level, const char *fmt, ...)
+{
+	uint32_t payload[SYSLOG_BINARY_MAX_PAYLOAD];
+	uint32_t pc = (uint32_t)__builtin_return_address(0);
+
+	/* Pack the arguments before masking interrupts */
+	va_list args;
+	va_start(args, fmt);
+	unsigned int count = syslog_binary_pack(payload, fmt, args);
+	va_end(args);
+	uint32_t words = SYSLOG_RECORD_HEADER_WORDS + count;
+
+	/* Each core only writes into its own ring, pick it with interrupts masked so we can not migrate */
+	uint32_t state = disable_interrupts();
+	struct syslog_ring *ring = &syslog_rings[SystemCurrentCore];
+	uint32_t head = ring->head;
+
+	/* The reader can be on the other core, so drop rather than overwrite */
+	if (ring->size - (head - ring->tail) < words) {
+		ring->dropped = ring->dropped + 1;
+		enable_interrupts(state);
+		return;
+	}
+
+	ring->data[head++ & (SYSLOG_BINARY_WORDS - 1)] = SYSLOG_RECORD_HEADER(words, level);
+	ring->data[head++ & (SYSLOG_BINARY_WORDS - 1)] = (uintptr_t)fmt;
+	ring->data[head++ & (SYSLOG_BINARY_WORDS - 1)] = pc;
+	ring->data[head++ & (SYSLOG_BINARY_WORDS - 1)] = timestamp_usec();
+	for (unsigned int i = 0; i < count; ++i)
+		ring->data[head++ & (SYSLOG_BINARY_WORDS - 1)] = payload[i];
+
+	/* Publish the complete record */
+	__DMB();
+	ring->head = head;
+	enable_interrupts(state);
+}
+
+/* Expand the star arguments into the conversion text, false if the payload ran out */
+static bool syslog_binary_expand(const struct syslog_spec *spec, char *text, size_t size, const uint32_t *payload, unsigned int *index, unsigned int count)
+{
+	size_t len = 0;
+
+	for (const char *c = spec->text; *c != 0 && len < size - 1; ++c) {
+		if (*c != '*') {
+			text[len++] = *c;
+			continue;
+		}
+		if (*index == count)
+			return false;
+		int written = snprintf(text + len, size - len, "%d", (int)payload[(*index)++]);
+		if (written < 0 || (size_t)written >= size - len)
+			return false;
+		len += written;
+	}
+	text[len] = 0;
+
+	return true;
+}
+
+static void syslog_binary_format(FILE *file, const struct syslog_record *record, unsigned int count)
+{
+	const char *fmt = (const char *)record->fmt;
+	unsigned int level = SYSLOG_RECORD_LEVEL(record->header);
+	unsigned int index = 0;
+	struct syslog_spec spec;
+	char text[32];
+
+	/* Only trust format strings placed by the syslog macros */
+	if (fmt < __syslog_fmt_start__ || fmt >= __syslog_fmt_end__ || level > SYSLOG_TRACE) {
+		fprintf(file, "%s syslog - bad binary record from 0x%08lx\n", syslog_level_str[SYSLOG_WARN], (unsigned long)record->pc);
+		return;
+	}
+
+	if (level != SYSLOG_NONE)
+		fprintf(file, "%s %s - ", syslog_level_str[level], backtrace_function_name(record->pc));
+
+	while (*fmt != 0) {
+
+		/* Literal text up to the next conversion */
+		const char *next = strchr(fmt, '%');
+		fwrite(fmt, 1, next ? (size_t)(next - fmt) : strlen(fmt), file);
+		if (!next)
+			return;
+
+		/* Unsupported conversions are shown as is */
+		fmt = syslog_parse_spec(next + 1, &spec);
+		if (!fmt) {
+			fputs(next, file);
+			return;
+		}
+
+		if (!syslog_binary_expand(&spec, text, sizeof(text), record->payload, &index, count))
+			goto truncated;
+
+		switch (spec.arg) {
+			case SYSLOG_ARG_NONE:
+				fputc('%', file);
+				break;
+			case SYSLOG_ARG_WORD:
+				if (index == count)
+					goto truncated;
+				fprintf(file, text, record->payload[index++]);
+				break;
+			case SYSLOG_ARG_POINTER:
+				if (index == count)
+					goto truncated;
+				fprintf(file, text, (void *)record->payload[index++]);
+				break;
+			case SYSLOG_ARG_DWORD: {
+				unsigned long long value;
+				if (index + 2 > count)
+					goto truncated;
+				memcpy(&value, &record->payload[index], sizeof(value));
+				fprintf(file, text, value);
+				index += 2;
+				break;
+			}
+			case SYSLOG_ARG_DOUBLE: {
+				double value;
+				if (index + 2 > count)
+					goto truncated;
+				memcpy(&value, &record->payload[index], sizeof(value));
+				fprintf(file, text, value);
+				index += 2;
+				break;
+			}
+			case SYSLOG_ARG_STRING: {
+				if (index == count)
+					goto truncated;
+				const char *str = (const char *)&record->payload[index];
+				size_t len = strnlen(str, (count - index) * sizeof(uint32_t));
+				if (len == (count - index) * sizeof(uint32_t))
+					goto truncated;
+				fprintf(file, text, str);
+				index += len / sizeof(uint32_t) + 1;
+				break;
+			}
+		}
+	}
+
+	return;
+
+truncated:
+	fputs("...\n", file);
+}
+
+unsigned int syslog_binary_drain(FILE *file, unsigned int max)
+{
+	assert(file != 0);
+
+	uint32_t buffer[SYSLOG_RECORD_HEADER_WORDS + SYSLOG_BINARY_MAX_PAYLOAD];
+	struct syslog_record *record = (struct syslog_record *)buffer;
+	unsigned int drained = 0;
+
+	/* Only one drainer at a time, the writers never touch the tail */
+	for (unsigned long core = 0; core < SystemNumCores && drained < max; ++core) {
+		struct syslog_ring *ring = &syslog_rings[core];
+
+		/* Let the reader know records went missing */
+		uint32_t dropped = ring->dropped;
+		if (dropped != syslog_reported[core]) {
+			fprintf(file, "%s syslog - dropped %lu binary records on core %lu\n", syslog_level_str[SYSLOG_WARN], (unsigned long)(dropped - syslog_reported[core]), core);
+			syslog_reported[core] = dropped;
+		}
+
+		uint32_t head = ring->head;
+		__DMB();
+		while (drained < max && ring->tail != head) {
+
+			/* Never trust a header which does not fit */
+			uint32_t tail = ring->tail;
+			uint32_t words = SYSLOG_RECORD_WORDS(ring->data[tail & (SYSLOG_BINARY_WORDS - 1)]);
+			if (words < SYSLOG_RECORD_HEADER_WORDS || words > array_sizeof(buffer) || words > head - tail) {
+				ring->tail = head;
+				break;
+			}
+
+			/* Copy the record out and release the space before the slow formatting */
+			for (uint32_t i = 0; i < words; ++i)
+				buffer[i] = ring->data[(tail + i) & (SYSLOG_BINARY_WORDS - 1)];
+			__DMB();
+			ring->tail = tail + words;
+
+			syslog_binary_format(file, record, words - SYSLOG_RECORD_HEADER_WORDS);
+			++drained;
+		}
+	}
+
+	return drained;
+}
+
+struct syslog_ring *syslog_binary_get_ring(unsigned long core)
+{
+	assert(core < SystemNumCores);
+
+	return &syslog_rings[core];
+}
+
+static void syslog_binary_init(void)
+{
+	/* Mark the rings so the decoder can find them in a memory dump */
+	for (unsigned long core = 0; core < SystemNumCores; ++core) {
+		syslog_rings[core].magic = SYSLOG_BINARY_MAGIC;
+		syslog_rings[core].core = core;
+		syslog_rings[core].size = SYSLOG_BINARY_WORDS;
+		syslog_rings[core].head = 0;
+		syslog_rings[core].tail = 0;
+		syslog_rings[core].dropped = 0;
+	}
+}
+PREINIT_SYSINIT_WITH_PRIORITY(syslog_binary_init, SYSLOG_SYSTEM_INIT_PRIORITY);
+
+#endif
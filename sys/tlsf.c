@@ -0,0 +1,494 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * tlsf.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include <tlsf.h>
+
+#define TLSF_BLOCK_FREE 0x1UL
+#define TLSF_BLOCK_FLAGS (TLSF_ALIGN - 1)
+
+struct tlsf_block
+{
+	size_t size;
+	struct tlsf_block *prev_phys;
+
+	/* Only valid while the block is free */
+	struct tlsf_block *next_free;
+	struct tlsf_block *prev_free;
+};
+
+/* Allocated blocks only carry the size and physical link, two words */
+#define TLSF_BLOCK_OVERHEAD offsetof(struct tlsf_block, next_free)
+#define TLSF_MIN_PAYLOAD (sizeof(struct tlsf_block) - TLSF_BLOCK_OVERHEAD)
+#define TLSF_MIN_BLOCK sizeof(struct tlsf_block)
+#define TLSF_MAX_PAYLOAD (((1UL << (TLSF_FL_MAX + 1)) - 1) & ~TLSF_BLOCK_FLAGS)
+
+static inline unsigned int tlsf_fls(size_t value)
+{
+	return 31 - __builtin_clz((uint32_t)value);
+}
+
+static inline unsigned int tlsf_ffs(uint32_t value)
+{
+	return __builtin_ctz(value);
+}
+
+static inline size_t tlsf_align_up(size_t value, size_t align)
+{
+	return (value + align - 1) & ~(align - 1);
+}
+
+static inline size_t block_size(const struct tlsf_block *block)
+{
+	return block->size & ~TLSF_BLOCK_FLAGS;
+}
+
+static inline bool block_is_free(const struct tlsf_block *block)
+{
+	return (block->size & TLSF_BLOCK_FREE) != 0;
+}
+
+static inline void *block_payload(const struct tlsf_block *block)
+{
+	return (char *)block + TLSF_BLOCK_OVERHEAD;
+}
+
+static inline struct tlsf_block *block_from_payload(const void *ptr)
+{
+	return (struct tlsf_block *)((char *)ptr - TLSF_BLOCK_OVERHEAD);
+}
+
+static inline struct tlsf_block *block_next(const struct tlsf_block *block)
+{
+	return (struct tlsf_block *)((char *)block_payload(block) + block_size(block));
+}
+
+static inline void mapping_insert(size_t size, unsigned int *fl, unsigned int *sl)
+{
+	/* Small blocks are spread linearly over the first row */
+	if (size < TLSF_SMALL_BLOCK) {
+		*fl = 0;
+		*sl = size >> TLSF_ALIGN_LOG2;
+		return;
+	}
+
+	/* Power of two row, linear column within it */
+	unsigned int bit = tlsf_fls(size);
+	*sl = (size >> (bit - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+	*fl = bit - TLSF_FL_SHIFT + 1;
+}
+
+static inline void mapping_search(size_t size, unsigned int *fl, unsigned int *sl)
+{
+	/* Round up to the next list so any block found is large enough */
+	if (size >= TLSF_SMALL_BLOCK)
+		size += (1UL << (tlsf_fls(size) - TLSF_SL_LOG2)) - 1;
+	mapping_insert(size, fl, sl);
+}
+
+static struct tlsf_block *find_suitable(struct tlsf *tlsf, unsigned int fl, unsigned int sl)
+{
+	if (fl >= TLSF_FL_COUNT)
+		return 0;
+
+	/* Anything left in this row? If not, the next non empty row */
+	uint32_t sl_map = tlsf->sl_bitmap[fl] & (~0UL << sl);
+	if (!sl_map) {
+		uint32_t fl_map = tlsf->fl_bitmap & (~0UL << (fl + 1));
+		if (!fl_map)
+			return 0;
+		fl = tlsf_ffs(fl_map);
+		sl_map = tlsf->sl_bitmap[fl];
+	}
+
+	return tlsf->blocks[fl][tlsf_ffs(sl_map)];
+}
+
+static void insert_free(struct tlsf *tlsf, struct tlsf_block *block)
+{
+	unsigned int fl, sl;
+	mapping_insert(block_size(block), &fl, &sl);
+
+	/* Push on the list head and mark the list as populated */
+	struct tlsf_block *head = tlsf->blocks[fl][sl];
+	block->next_free = head;
+	block->prev_free = 0;
+	if (head)
+		head->prev_free = block;
+	tlsf->blocks[fl][sl] = block;
+	tlsf->sl_bitmap[fl] |= 1UL << sl;
+	tlsf->fl_bitmap |= 1UL << fl;
+
+	block->size |= TLSF_BLOCK_FREE;
+	tlsf->free += block_size(block);
+	++tlsf->free_blocks;
+}
+
+static void remove_free(struct tlsf *tlsf, struct tlsf_block *block)
+{
+	unsigned int fl, sl;
+	mapping_insert(block_size(block), &fl, &sl);
+
+	/* Unlink, clearing the bitmaps when the list empties */
+	if (block->next_free)
+		block->next_free->prev_free = block->prev_free;
+	if (block->prev_free)
+		block->prev_free->next_free = block->next_free;
+	else {
+		tlsf->blocks[fl][sl] = block->next_free;
+		if (!block->next_free) {
+			tlsf->sl_bitmap[fl] &= ~(1UL << sl);
+			if (!tlsf->sl_bitmap[fl])
+				tlsf->fl_bitmap &= ~(1UL << fl);
+		}
+	}
+
+	block->size &= ~TLSF_BLOCK_FREE;
+	tlsf->free -= block_size(block);
+	--tlsf->free_blocks;
+}
+
+static struct tlsf_block *block_split(struct tlsf_block *block, size_t size)
+{
+	/* Only worth it when the remainder can hold a free block */
+	if (block_size(block) < size + TLSF_MIN_BLOCK)
+		return 0;
+
+	struct tlsf_block *remainder = (struct tlsf_block *)((char *)block_payload(block) + size);
+	remainder->size = block_size(block) - size - TLSF_BLOCK_OVERHEAD;
+	remainder->prev_phys = block;
+	block_next(remainder)->prev_phys = remainder;
+	block->size = size | (block->size & TLSF_BLOCK_FLAGS);
+
+	return remainder;
+}
+
+static struct tlsf_block *block_coalesce(struct tlsf *tlsf, struct tlsf_block *block)
+{
+	/* Absorb into a free previous block */
+	struct tlsf_block *prev = block->prev_phys;
+	if (prev && block_is_free(prev)) {
+		remove_free(tlsf, prev);
+		prev->size += TLSF_BLOCK_OVERHEAD + block_size(block);
+		block = prev;
+	}
+
+	/* Absorb a free next block, the end sentinel is never free */
+	struct tlsf_block *next = block_next(block);
+	if (block_is_free(next)) {
+		remove_free(tlsf, next);
+		block->size += TLSF_BLOCK_OVERHEAD + block_size(next);
+	}
+
+	/* Fix up the physical link */
+	block_next(block)->prev_phys = block;
+
+	return block;
+}
+
+static void block_trim_used(struct tlsf *tlsf, struct tlsf_block *block, size_t size)
+{
+	/* Give the tail of an allocated block back */
+	size_t before = block_size(block);
+	struct tlsf_block *remainder = block_split(block, size);
+	if (remainder) {
+		tlsf->used -= before - block_size(block);
+		insert_free(tlsf, block_coalesce(tlsf, remainder));
+	}
+}
+
+static size_t adjust_size(size_t size)
+{
+	/* Never smaller than the free list links, always a multiple of the alignment */
+	if (size > TLSF_MAX_PAYLOAD)
+		return 0;
+	if (size < TLSF_MIN_PAYLOAD)
+		size = TLSF_MIN_PAYLOAD;
+	return tlsf_align_up(size, TLSF_ALIGN);
+}
+
+static inline void account_used(struct tlsf *tlsf, size_t size)
+{
+	tlsf->used += size;
+	if (tlsf->used > tlsf->peak_used)
+		tlsf->peak_used = tlsf->used;
+}
+
+int tlsf_init(struct tlsf *tlsf, void *mem, size_t size)
+{
+	if (!tlsf || !mem)
+		return -1;
+
+	memset(tlsf, 0, sizeof(struct tlsf));
+
+	/* Trim the region to the alignment */
+	uintptr_t start = tlsf_align_up((uintptr_t)mem, TLSF_ALIGN);
+	uintptr_t end = ((uintptr_t)mem + size) & ~TLSF_BLOCK_FLAGS;
+	if (end <= start || end - start < TLSF_MIN_BLOCK + TLSF_BLOCK_OVERHEAD)
+		return -1;
+
+	/* One free block followed by a zero sized allocated sentinel, anything beyond the largest block is ignored */
+	size_t payload = end - start - 2 * TLSF_BLOCK_OVERHEAD;
+	if (payload > TLSF_MAX_PAYLOAD)
+		payload = TLSF_MAX_PAYLOAD;
+	struct tlsf_block *block = (struct tlsf_block *)start;
+	block->size = payload;
+	block->prev_phys = 0;
+	struct tlsf_block *sentinel = block_next(block);
+	sentinel->size = 0;
+	sentinel->prev_phys = block;
+
+	tlsf->first = block;
+	tlsf->total = payload;
+	insert_free(tlsf, block);
+
+	return 0;
+}
+
+void *tlsf_malloc(struct tlsf *tlsf, size_t size)
+{
+	size_t adjusted = adjust_size(size);
+	if (!adjusted)
+		return 0;
+
+	/* Find a list holding blocks at least as large as needed */
+	unsigned int fl, sl;
+	mapping_search(adjusted, &fl, &sl);
+	struct tlsf_block *block = find_suitable(tlsf, fl, sl);
+	if (!block)
+		return 0;
+	remove_free(tlsf, block);
+
+	/* Return the excess, its physical neighbours are both allocated so no merging is needed */
+	struct tlsf_block *remainder = block_split(block, adjusted);
+	if (remainder)
+		insert_free(tlsf, remainder);
+
+	account_used(tlsf, block_size(block));
+	++tlsf->used_blocks;
+
+	return block_payload(block);
+}
+
+void *tlsf_memalign(struct tlsf *tlsf, size_t alignment, size_t size)
+{
+	/* Natural alignment is all most callers want */
+	if (alignment <= TLSF_ALIGN)
+		return tlsf_malloc(tlsf, size);
+	if ((alignment & (alignment - 1)) != 0)
+		return 0;
+
+	size_t adjusted = adjust_size(size);
+	if (!adjusted || adjusted + alignment + TLSF_MIN_BLOCK > TLSF_MAX_PAYLOAD)
+		return 0;
+
+	/* Over allocate so the leading gap can always become a free block */
+	char *ptr = tlsf_malloc(tlsf, adjusted + alignment + TLSF_MIN_BLOCK);
+	if (!ptr)
+		return 0;
+
+	/* Release the leading gap */
+	char *aligned = (char *)tlsf_align_up((uintptr_t)ptr, alignment);
+	if (aligned != ptr) {
+		if ((size_t)(aligned - ptr) < TLSF_MIN_BLOCK)
+			aligned = (char *)tlsf_align_up((uintptr_t)ptr + TLSF_MIN_BLOCK, alignment);
+		size_t gap = aligned - ptr;
+
+		/* Split the front off as a second allocated block and free it through the normal path */
+		struct tlsf_block *front = block_from_payload(ptr);
+		struct tlsf_block *block = block_from_payload(aligned);
+		block->size = block_size(front) - gap;
+		block->prev_phys = front;
+		block_next(block)->prev_phys = block;
+		front->size = gap - TLSF_BLOCK_OVERHEAD;
+		tlsf->used -= TLSF_BLOCK_OVERHEAD;
+		++tlsf->used_blocks;
+		tlsf_free(tlsf, ptr);
+	}
+
+	/* And the trailing excess */
+	block_trim_used(tlsf, block_from_payload(aligned), adjusted);
+
+	return aligned;
+}
+
+void *tlsf_resize(struct tlsf *tlsf, void *ptr, size_t size)
+{
+	size_t adjusted = adjust_size(size);
+	if (!ptr || !adjusted)
+		return 0;
+
+	/* Shrinking is always in place */
+	struct tlsf_block *block = block_from_payload(ptr);
+	size_t current = block_size(block);
+	if (adjusted <= current) {
+		block_trim_used(tlsf, block, adjusted);
+		return ptr;
+	}
+
+	/* Grow into a free next block when it is large enough */
+	struct tlsf_block *next = block_next(block);
+	if (block_is_free(next) && current + TLSF_BLOCK_OVERHEAD + block_size(next) >= adjusted) {
+		remove_free(tlsf, next);
+		block->size += TLSF_BLOCK_OVERHEAD + block_size(next);
+		block_next(block)->prev_phys = block;
+		account_used(tlsf, block_size(block) - current);
+		block_trim_used(tlsf, block, adjusted);
+		return ptr;
+	}
+
+	/* It would have to move */
+	return 0;
+}
+
+void *tlsf_realloc(struct tlsf *tlsf, void *ptr, size_t size)
+{
+	/* The edge cases */
+	if (!ptr)
+		return tlsf_malloc(tlsf, size);
+	if (size == 0) {
+		tlsf_free(tlsf, ptr);
+		return 0;
+	}
+
+	/* In place if possible */
+	void *new_ptr = tlsf_resize(tlsf, ptr, size);
+	if (new_ptr)
+		return new_ptr;
+
+	/* Otherwise move it */
+	new_ptr = tlsf_malloc(tlsf, size);
+	if (!new_ptr)
+		return 0;
+	memcpy(new_ptr, ptr, tlsf_usable_size(ptr));
+	tlsf_free(tlsf, ptr);
+
+	return new_ptr;
+}
+
+void tlsf_free(struct tlsf *tlsf, void *ptr)
+{
+	if (!ptr)
+		return;
+
+	/* Ignore obvious double frees */
+	struct tlsf_block *block = block_from_payload(ptr);
+	if (block_is_free(block))
+		return;
+
+	tlsf->used -= block_size(block);
+	--tlsf->used_blocks;
+
+	insert_free(tlsf, block_coalesce(tlsf, block));
+}
+
+size_t tlsf_usable_size(const void *ptr)
+{
+	if (!ptr)
+		return 0;
+
+	return block_size(block_from_payload(ptr));
+}
+
+void tlsf_get_stats(const struct tlsf *tlsf, struct tlsf_stats *stats)
+{
+	stats->total = tlsf->total;
+	stats->used = tlsf->used;
+	stats->free = tlsf->free;
+	stats->peak_used = tlsf->peak_used;
+	stats->used_blocks = tlsf->used_blocks;
+	stats->free_blocks = tlsf->free_blocks;
+
+	/* The largest free block lives in the highest populated list */
+	stats->largest_free = 0;
+	if (tlsf->fl_bitmap) {
+		unsigned int fl = tlsf_fls(tlsf->fl_bitmap);
+		unsigned int sl = tlsf_fls(tlsf->sl_bitmap[fl]);
+		for (const struct tlsf_block *block = tlsf->blocks[fl][sl]; block; block = block->next_free)
+			if (block_size(block) > stats->largest_free)
+				stats->largest_free = block_size(block);
+	}
+
+	/* Percentage of the free space not usable by a single allocation */
+	stats->fragmentation = stats->free ? 100 - (unsigned int)((uint64_t)stats->largest_free * 100 / stats->free) : 0;
+}
+
+static bool check_listed(const struct tlsf *tlsf, const struct tlsf_block *block)
+{
+	unsigned int fl, sl;
+	mapping_insert(block_size(block), &fl, &sl);
+	for (const struct tlsf_block *entry = tlsf->blocks[fl][sl]; entry; entry = entry->next_free)
+		if (entry == block)
+			return true;
+	return false;
+}
+
+int tlsf_check(const struct tlsf *tlsf)
+{
+	size_t used = 0;
+	size_t free = 0;
+	size_t used_blocks = 0;
+	size_t free_blocks = 0;
+
+	/* Walk the physical blocks up to the sentinel */
+	const struct tlsf_block *prev = 0;
+	const struct tlsf_block *block = tlsf->first;
+	while (block_size(block) != 0 || block_is_free(block)) {
+
+		if (block->prev_phys != prev)
+			return -1;
+		if ((block_size(block) & TLSF_BLOCK_FLAGS) != 0 || block_size(block) < TLSF_MIN_PAYLOAD)
+			return -2;
+
+		if (block_is_free(block)) {
+			if (prev && block_is_free(prev))
+				return -3;
+			if (!check_listed(tlsf, block))
+				return -4;
+			free += block_size(block);
+			++free_blocks;
+		} else {
+			used += block_size(block);
+			++used_blocks;
+		}
+
+		prev = block;
+		block = block_next(block);
+	}
+	if (block->prev_phys != prev)
+		return -1;
+
+	/* Every list entry must be free and agree with the bitmaps */
+	for (unsigned int fl = 0; fl < TLSF_FL_COUNT; ++fl) {
+		if (((tlsf->fl_bitmap >> fl) & 1) != (tlsf->sl_bitmap[fl] != 0))
+			return -5;
+		for (unsigned int sl = 0; sl < TLSF_SL_COUNT; ++sl) {
+			if (((tlsf->sl_bitmap[fl] >> sl) & 1) != (tlsf->blocks[fl][sl] != 0))
+				return -5;
+			for (const struct tlsf_block *entry = tlsf->blocks[fl][sl]; entry; entry = entry->next_free) {
+				unsigned int entry_fl, entry_sl;
+				mapping_insert(block_size(entry), &entry_fl, &entry_sl);
+				if (!block_is_free(entry) || entry_fl != fl || entry_sl != sl)
+					return -6;
+			}
+		}
+	}
+
+	/* And the counters must match */
+	if (used != tlsf->used || free != tlsf->free || used_blocks != tlsf->used_blocks || free_blocks != tlsf->free_blocks)
+		return -7;
+
+	return 0;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * trace.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ */
+
+#include <assert.h>
+
+#include <config.h>
+#include <compiler.h>
+
+#include <init/init-sections.h>
+#include <cmsis/cmsis.h>
+
+#include <sys/timestamp.h>
+#include <sys/trace.h>
+
+#if SYS_TRACE > 0
+
+static_assert((SYS_TRACE_ENTRIES & (SYS_TRACE_ENTRIES - 1)) == 0, "SYS_TRACE_ENTRIES must be a power of 2");
+
+static volatile bool trace_enabled = false;
+static struct trace_buffer trace_buffers[SystemNumCores];
+
+__fast_section void trace_record(unsigned int event, unsigned int arg, uint32_t data)
+{
+	/* Drop if stopped, this preserves the events leading up to the stop */
+	if (!trace_enabled)
+		return;
+
+	/* Each core only writes into its own ring, masking interrupts keeps nested handlers out of the slot */
+	struct trace_buffer *buffer = &trace_buffers[SystemCurrentCore];
+	uint32_t state = disable_interrupts();
+	struct trace_record *record = &buffer->records[buffer->head & (SYS_TRACE_ENTRIES - 1)];
+	record->timestamp = timestamp_usec();
+	record->data = data;
+	record->event = event;
+	record->arg = arg;
+	buffer->head = buffer->head + 1;
+	enable_interrupts(state);
+}
+
+void trace_start(void)
+{
+	trace_enabled = true;
+}
+
+void trace_stop(void)
+{
+	trace_enabled = false;
+}
+
+struct trace_buffer *trace_get_buffer(unsigned long core)
+{
+	assert(core < SystemNumCores);
+
+	return &trace_buffers[core];
+}
+
+static void trace_init(void)
+{
+	/* Mark the buffers so the decoder can find them in a memory dump */
+	for (unsigned long core = 0; core < SystemNumCores; ++core) {
+		trace_buffers[core].magic = TRACE_MAGIC;
+		trace_buffers[core].core = core;
+		trace_buffers[core].size = SYS_TRACE_ENTRIES;
+		trace_buffers[core].head = 0;
+	}
+
+	/* Start tracing right away */
+	trace_enabled = true;
+}
+PREINIT_SYSINIT_WITH_PRIORITY(trace_init, TRACE_SYSTEM_INIT_PRIORITY);
+
+#endif
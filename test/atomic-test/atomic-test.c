@@ -6,13 +6,11 @@
 
 #include <cmsis/cmsis.h>
 
-#define ATOMIC_STRIPE 4
-#define ATOMIC_HW_LOCKS 32
-#define ATOMIC_HW_LOCK_INDEX 0
-#define ATOMIC_LOCK_IDX_Pos (ATOMIC_STRIPE / 2)
-#define ATOMIC_LOCK_IDX_Msk (ATOMIC_HW_LOCKS - 1)
+#include <sys/async.h>
+#include <sys/atomic-locks.h>
+#include <sys/timestamp.h>
 
-#define LOCK_IDX(addr) ((((uintptr_t)addr) >> ATOMIC_LOCK_IDX_Pos) & ATOMIC_LOCK_IDX_Msk)
+#define BENCH_OPERATIONS 100000UL
 
 typedef struct spin_lock
 {
@@ -86,6 +84,118 @@ static bool atomic_flag_test(void)
 	return result;
 }
 
+enum bench_op
+{
+	BENCH_FETCH_ADD,
+	BENCH_CAS,
+};
+
+struct bench_run
+{
+	atomic_ulong *counter;
+	enum bench_op op;
+};
+
+static atomic_ulong shared_counter;
+static atomic_ulong striped_counters[ATOMIC_SIO_LOCKS * 2];
+static atomic_ulong pinned_counter_0 __atomic_pinned;
+static atomic_ulong pinned_counter_1 __atomic_pinned;
+
+static void bench_loop(struct bench_run *run)
+{
+	switch (run->op) {
+		case BENCH_FETCH_ADD:
+			for (unsigned long i = 0; i < BENCH_OPERATIONS; ++i)
+				atomic_fetch_add(run->counter, 1);
+			break;
+
+		case BENCH_CAS:
+			for (unsigned long i = 0; i < BENCH_OPERATIONS; ++i) {
+				unsigned long expected = atomic_load(run->counter);
+				while (!atomic_compare_exchange_weak(run->counter, &expected, expected + 1));
+			}
+			break;
+	}
+}
+
+static void bench_core1(struct async *async)
+{
+	bench_loop(async->context);
+}
+
+static void bench_report_lock(const char *name, atomic_ulong *counter)
+{
+	struct atomic_lock_stats stats;
+	unsigned int lock = atomic_lock_index(counter);
+
+	atomic_get_lock_stats(lock, &stats);
+	printf("\t%s lock %u: acquired %lu contended %lu spins %lu\n", name, lock, stats.acquired, stats.contended, stats.spins);
+}
+
+static bool bench_run(const char *title, enum bench_op op, atomic_ulong *core0_counter, atomic_ulong *core1_counter)
+{
+	static struct async async;
+	struct bench_run runs[2] = { { .counter = core0_counter, .op = op }, { .counter = core1_counter, .op = op } };
+	unsigned long cores = core1_counter ? 2 : 1;
+
+	*core0_counter = 0;
+	if (core1_counter)
+		*core1_counter = 0;
+	atomic_reset_lock_stats();
+
+	/* Run the same loop on both cores at once */
+	unsigned long start = timestamp_usec();
+	if (core1_counter)
+		async_run(&async, bench_core1, &runs[1]);
+	bench_loop(&runs[0]);
+	if (core1_counter)
+		async_wait(&async);
+	unsigned long elapsed = timestamp_usec() - start;
+
+	/* Every operation must have landed */
+	unsigned long expected = core1_counter == core0_counter ? BENCH_OPERATIONS * 2 : BENCH_OPERATIONS;
+	bool passed = *core0_counter == expected && (!core1_counter || *core1_counter == expected);
+
+	printf("%-36s %8lu usec %8lu ops/msec %s\n", title, elapsed, elapsed > 0 ? (unsigned long)((BENCH_OPERATIONS * cores * 1000ULL) / elapsed) : 0, passed ? "PASS" : "FAIL");
+	if (ATOMIC_STATS > 0) {
+		bench_report_lock("core0", core0_counter);
+		if (core1_counter && core1_counter != core0_counter)
+			bench_report_lock("core1", core1_counter);
+	}
+
+	return passed;
+}
+
+static bool atomic_bench(void)
+{
+	bool passed = true;
+
+	/* Find a striped counter hashing to the same lock as the first, which is exactly the collision pinning avoids */
+	atomic_ulong *colliding = &striped_counters[1];
+	for (size_t i = 1; i < array_sizeof(striped_counters); ++i)
+		if (atomic_lock_index(&striped_counters[i]) == atomic_lock_index(&striped_counters[0])) {
+			colliding = &striped_counters[i];
+			break;
+		}
+	if (atomic_lock_index(colliding) != atomic_lock_index(&striped_counters[0]))
+		printf("striped counters do not collide: %u %u\n", atomic_lock_index(&striped_counters[0]), atomic_lock_index(colliding));
+
+	passed &= bench_run("fetch_add one core", BENCH_FETCH_ADD, &shared_counter, 0);
+	passed &= bench_run("fetch_add shared counter", BENCH_FETCH_ADD, &shared_counter, &shared_counter);
+	passed &= bench_run("fetch_add colliding stripe", BENCH_FETCH_ADD, &striped_counters[0], colliding);
+	passed &= bench_run("fetch_add pinned", BENCH_FETCH_ADD, &pinned_counter_0, &pinned_counter_1);
+
+	passed &= bench_run("cas one core", BENCH_CAS, &shared_counter, 0);
+	passed &= bench_run("cas shared counter", BENCH_CAS, &shared_counter, &shared_counter);
+	passed &= bench_run("cas colliding stripe", BENCH_CAS, &striped_counters[0], colliding);
+	passed &= bench_run("cas pinned", BENCH_CAS, &pinned_counter_0, &pinned_counter_1);
+
+	if (ATOMIC_STATS == 0)
+		printf("build with ATOMIC_STATS=1 for atomic lock contention data\n");
+
+	return passed;
+}
+
 int main(int argc, char **argv)
 {
 
@@ -109,5 +219,5 @@ int main(int argc, char **argv)
 	for (size_t i = 0; i < array_sizeof(locks); ++i)
 		spin_unlock(&locks[i]);
 
+	printf("%s\n", atomic_bench() ? "PASSED" : "FAILED");
 }
-
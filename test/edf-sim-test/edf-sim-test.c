@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * edf-sim-test.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ *
+ * Host tick simulation of the earliest deadline first policy helpers in
+ * include/rtos/rtos-toolkit/scheduler-edf.h, exits with failure if any case fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <limits.h>
+
+#include <rtos/rtos-toolkit/scheduler-edf.h>
+
+#define SIM_MAX_TASKS 8
+
+struct sim_task
+{
+	unsigned long cost;
+	unsigned long period;
+	unsigned long budget;
+	struct task_edf edf;
+	unsigned long work;
+	bool pending;
+	bool demoted;
+};
+
+static struct sim_task *sim_pick(struct sim_task *tasks, unsigned int count, bool edf)
+{
+	struct sim_task *best = 0;
+
+	/* Ready jobs with budget left first, by deadline for EDF and by period for rate monotonic */
+	for (unsigned int i = 0; i < count; ++i) {
+		struct sim_task *task = &tasks[i];
+		if (!task->pending || task->demoted)
+			continue;
+		if (!best)
+			best = task;
+		else if (edf && scheduler_edf_before(task->edf.absolute_deadline, best->edf.absolute_deadline))
+			best = task;
+		else if (!edf && task->period < best->period)
+			best = task;
+	}
+
+	/* Then demoted jobs in the background */
+	if (!best)
+		for (unsigned int i = 0; i < count; ++i)
+			if (tasks[i].pending) {
+				best = &tasks[i];
+				break;
+			}
+
+	return best;
+}
+
+static unsigned long sim_run(struct sim_task *tasks, unsigned int count, unsigned long start, unsigned long ticks, bool edf, unsigned long *overruns)
+{
+	unsigned long misses = 0;
+
+	/* Release everything at the start */
+	for (unsigned int i = 0; i < count; ++i) {
+		struct sim_task *task = &tasks[i];
+		task->edf = (struct task_edf){ .period = task->period, .deadline = task->period, .budget = task->budget };
+		scheduler_edf_release(&task->edf, start);
+		task->work = task->cost;
+		task->pending = true;
+		task->demoted = false;
+	}
+
+	for (unsigned long now = start; now != start + ticks; ++now) {
+
+		/* Release new jobs, an unfinished job is forced to complete and counted */
+		for (unsigned int i = 0; i < count; ++i) {
+			struct sim_task *task = &tasks[i];
+			if (scheduler_edf_before(now, task->edf.release))
+				continue;
+			if (!task->pending) {
+				task->pending = true;
+				task->demoted = false;
+				task->work = task->cost;
+			} else if (!scheduler_edf_before(now, task->edf.release + task->period)) {
+				misses += scheduler_edf_complete(&task->edf, now + 1);
+				task->demoted = false;
+				task->work = task->cost;
+			}
+		}
+
+		/* Run one tick, like the scheduler tick only a job still running at the end of the tick is charged */
+		struct sim_task *task = sim_pick(tasks, count, edf);
+		if (!task)
+			continue;
+		if (--task->work == 0) {
+			misses += scheduler_edf_complete(&task->edf, now + 1);
+			task->pending = false;
+		} else if (scheduler_edf_charge(&task->edf))
+			task->demoted = true;
+	}
+
+	/* Report overruns */
+	if (overruns) {
+		*overruns = 0;
+		for (unsigned int i = 0; i < count; ++i)
+			*overruns += tasks[i].edf.overruns;
+	}
+
+	return misses;
+}
+
+static int check(const char *name, bool condition)
+{
+	printf("%-50s %s\n", name, condition ? "PASS" : "FAIL");
+	return condition ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+	int failures = 0;
+	unsigned long overruns;
+
+	/* U = 2/5 + 4/7 = 0.97, not rate monotonic schedulable but fine under EDF */
+	struct sim_task feasible[] = {
+		{ .cost = 2, .period = 5 },
+		{ .cost = 4, .period = 7 },
+	};
+	failures += check("rate monotonic misses at U=0.97", sim_run(feasible, 2, 0, 35 * 100, false, 0) > 0);
+	failures += check("edf meets every deadline at U=0.97", sim_run(feasible, 2, 0, 35 * 100, true, 0) == 0);
+
+	/* U = 3/5 + 4/7 = 1.17 */
+	struct sim_task overload[] = {
+		{ .cost = 3, .period = 5 },
+		{ .cost = 4, .period = 7 },
+	};
+	failures += check("edf misses deadlines at U=1.17", sim_run(overload, 2, 0, 35 * 100, true, 0) > 0);
+
+	/* A task asking for 5 ticks with a 2 tick budget must not hurt the others */
+	struct sim_task enforced[] = {
+		{ .cost = 2, .period = 5, .budget = 2 },
+		{ .cost = 2, .period = 10, .budget = 2 },
+		{ .cost = 5, .period = 10, .budget = 2 },
+	};
+	unsigned long misses = sim_run(enforced, 3, 0, 10 * 100, true, &overruns);
+	failures += check("budget overrun detected", overruns == 100 && enforced[2].edf.overruns == 100);
+	failures += check("budget enforcement protects the other tasks", enforced[0].edf.misses == 0 && enforced[1].edf.misses == 0);
+	failures += check("only the overrunning task misses deadlines", misses == enforced[2].edf.misses);
+
+	/* The same feasible set again across the tick counter wrap */
+	failures += check("edf deadline compare wraps", scheduler_edf_before(ULONG_MAX - 1, 2) && !scheduler_edf_before(2, ULONG_MAX - 1));
+	failures += check("edf meets every deadline across the tick wrap", sim_run(feasible, 2, ULONG_MAX - 35 * 10, 35 * 20, true, 0) == 0);
+
+	printf("%s\n", failures ? "FAILED" : "PASSED");
+
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,29 @@
+ARCH_CROSS := host
+BOARD_TYPE := host
+BUILD_ROOT := ${OUTPUT_ROOT}$(if ${BOARD_TYPE},/${BOARD_TYPE},)$(if ${BUILD_TYPE},/${BUILD_TYPE},)
+INSTALL_ROOT := ${PROJECT_ROOT}/local/bin
+BUILD_TYPE := debug
+
+ifeq ($(findstring ${BUILD_ROOT},${CURDIR}),)
+
+include ${PROJECT_ROOT}/tools/makefiles/target.mk
+
+else
+
+EXTRA_DEPS := ${SOURCE_DIR}/edf-sim-test.mk ${PROJECT_ROOT}/include/rtos/rtos-toolkit/scheduler-edf.h
+EXTRA_CLEAN := ${INSTALL_ROOT}/edf-sim-test
+
+include ${PROJECT_ROOT}/tools/makefiles/project.mk
+
+CPPFLAGS += -I${PROJECT_ROOT}/include
+CFLAGS := -pipe -O0 -g3 -fno-move-loop-invariants -feliminate-unused-debug-types -fmessage-length=0 -fsigned-char -ffunction-sections -fdata-sections -Wall -Wunused -Wuninitialized -Wmissing-declarations -Werror -std=gnu11 -funwind-tables
+
+all: ${INSTALL_ROOT}/edf-sim-test
+
+${INSTALL_ROOT}/edf-sim-test: ${CURDIR}/edf-sim-test.elf
+	@echo "INSTALLING ${@}"
+	$(INSTALL) -m 770 -D ${<} ${@}
+	@echo "RUNNING ${@}"
+	${@}
+
+endif
@@ -56,6 +56,10 @@ int _main(int argc, char **argv)
 	main_task_descriptor.context = &args;
 	main_task_descriptor.flags = 0;
 	main_task_descriptor.priority = SCHEDULER_MAX_TASK_PRIORITY;
+	main_task_descriptor.quantum = 0;
+	main_task_descriptor.period = 0;
+	main_task_descriptor.deadline = 0;
+	main_task_descriptor.budget = 0;
 	struct task *main_task = scheduler_create(sbrk(SCHEDULER_MAIN_STACK_SIZE), SCHEDULER_MAIN_STACK_SIZE, &main_task_descriptor);
 	if (!main_task) {
 		errno = EINVAL;
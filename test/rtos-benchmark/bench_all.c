@@ -9,8 +9,13 @@ extern void bench_mutex_lock_unlock_test(void *arg);
 extern void bench_sem_context_switch_init(void *arg);
 extern void bench_sem_signal_release_init(void *arg);
 extern void bench_thread_yield(void *arg);
+extern void bench_ready_queue(void *arg);
+extern void bench_suspend_resume(void *arg);
 extern void bench_malloc_free(void *arg);
 extern void bench_message_queue_init(void *arg);
+extern void bench_condvar_broadcast_test(void *arg);
+extern void bench_batch_queue_test(void *arg);
+extern void bench_thread_spawn_test(void *arg);
 
 void bench_all(void *arg)
 {
@@ -21,8 +26,13 @@ void bench_all(void *arg)
 	bench_sem_context_switch_init(arg);
 	bench_sem_signal_release_init(arg);
 	bench_thread_yield(arg);
+	bench_ready_queue(arg);
+	bench_suspend_resume(arg);
 	bench_malloc_free(arg);
 	bench_message_queue_init(arg);
+	bench_condvar_broadcast_test(arg);
+	bench_batch_queue_test(arg);
+	bench_thread_spawn_test(arg);
 
 	/* This should be the last test as it can muck with the timer */
 
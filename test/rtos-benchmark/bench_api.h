@@ -111,6 +111,31 @@ void bench_thread_suspend(int thread_id);
  */
 void bench_thread_abort(int thread_id);
 
+/**
+ * @brief Spawn (create and start) a joinable thread with a given stack size
+ *
+ * This routine creates a joinable thread which must be reclaimed with
+ * \ref bench_thread_join. It is immediately made available to schedule to run.
+ *
+ * @param thread_id       Handle for thread.
+ * @param thread_name     Name of thread.
+ * @param priority        Thread priority.
+ * @param stack_size      Stack size in bytes, 0 for the default.
+ * @param entry_function  Thread entry function.
+ * @param args            Entry point parameter representing arguments.
+ *
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_thread_spawn_joinable(int thread_id, const char *thread_name, int priority,
+	uint32_t stack_size, void (*entry_function)(void *), void *args);
+
+/**
+ * @brief Wait for a joinable thread to exit and reclaim it
+ *
+ * @param thread_id Handle of thread
+ */
+void bench_thread_join(int thread_id);
+
 /**
  * @brief Exits from a thread
  *
@@ -210,6 +235,16 @@ void bench_sem_give(int sem_id);
  */
 void bench_sem_give_from_isr(int sem_id);
 
+/**
+ * @brief Give a semaphore and always enter the kernel
+ *
+ * This routine gives the semaphore and then issues the futex wake unconditionally, the way every
+ * give did before the waiter bit. Used to compare the fast path against the kernel path in one run.
+ *
+ * @param sem_id ID of semaphore
+ */
+void bench_sem_give_forced_wake(int sem_id);
+
 /**
  * @brief Take a semaphore
  *
@@ -221,6 +256,43 @@ void bench_sem_give_from_isr(int sem_id);
  */
 int bench_sem_take(int sem_id);
 
+/**
+ * @brief Create an event flags object
+ *
+ * This routine creates an event flags object with all flags clear, prior to its first use.
+ *
+ * @param event_id ID of event flags (to be used with other routines)
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_event_create(int event_id);
+
+/**
+ * @brief Set event flags
+ *
+ * @param event_id ID of event flags
+ * @param flags Flags to set
+ */
+void bench_event_set(int event_id, uint32_t flags);
+
+/**
+ * @brief Set event flags and always enter the kernel
+ *
+ * This routine sets the flags and then issues the futex wake unconditionally, the way every set did
+ * before the waiter bit. Used to compare the fast path against the kernel path in one run.
+ *
+ * @param event_id ID of event flags
+ * @param flags Flags to set
+ */
+void bench_event_set_forced_wake(int event_id, uint32_t flags);
+
+/**
+ * @brief Clear event flags
+ *
+ * @param event_id ID of event flags
+ * @param flags Flags to clear
+ */
+void bench_event_clear(int event_id, uint32_t flags);
+
 /**
  * @brief Create a mutex
  *
@@ -251,6 +323,52 @@ int bench_mutex_lock(int mutex_id);
  */
 int bench_mutex_unlock(int mutex_id);
 
+/**
+ * @brief Create a condition variable
+ *
+ * This routine creates a condition variable and the mutex protecting it,
+ * prior to their first use.
+ *
+ * @param condvar_id ID of condition variable (to be used with other routines)
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_condvar_create(int condvar_id);
+
+/**
+ * @brief Lock the mutex of a condition variable
+ *
+ * @param condvar_id ID of condition variable
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_condvar_lock(int condvar_id);
+
+/**
+ * @brief Unlock the mutex of a condition variable
+ *
+ * @param condvar_id ID of condition variable
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_condvar_unlock(int condvar_id);
+
+/**
+ * @brief Wait on a condition variable
+ *
+ * This routine atomically releases the mutex of the condition variable,
+ * waits for a signal or broadcast and then reacquires the mutex.
+ *
+ * @param condvar_id ID of condition variable
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_condvar_wait(int condvar_id);
+
+/**
+ * @brief Wake all waiters of a condition variable
+ *
+ * @param condvar_id ID of condition variable
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_condvar_broadcast(int condvar_id);
+
 /**
  * @brief Allocate memory from the heap.
  *
@@ -266,6 +384,39 @@ void *bench_malloc(size_t size);
  */
 void bench_free(void *ptr);
 
+/**
+ * @brief Create a fixed block memory pool
+ *
+ * @param pool_id ID of pool (to be used with other routines)
+ * @param block_count Number of blocks in the pool
+ * @param block_size Size of each block
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_pool_create(int pool_id, uint32_t block_count, uint32_t block_size);
+
+/**
+ * @brief Allocate a block from a memory pool without waiting
+ *
+ * @param pool_id ID of pool
+ * @return block allocated or NULL if the pool is empty
+ */
+void *bench_pool_alloc(int pool_id);
+
+/**
+ * @brief Return a block to a memory pool
+ *
+ * @param pool_id ID of pool
+ * @param block Block allocated with bench_pool_alloc()
+ */
+void bench_pool_free(int pool_id, void *block);
+
+/**
+ * @brief Delete a memory pool
+ *
+ * @param pool_id ID of pool
+ */
+void bench_pool_delete(int pool_id);
+
 /**
  * @brief Create a message queue
  *
@@ -308,6 +459,70 @@ int bench_message_queue_send(int mq_id, char *msg_ptr, size_t msg_len);
  */
 int bench_message_queue_receive(int mq_id, char *msg_ptr, size_t msg_len);
 
+/**
+ * @brief Allocate a message buffer from a message queue to be filled in place.
+ * If the message queue is full, the routine will wait forever or until space
+ * becomes available.
+ *
+ * @param mq_id           ID of message queue
+ * @return buffer to fill or NULL in case of error
+ */
+char *bench_message_queue_alloc(int mq_id);
+
+/**
+ * @brief Queue a message buffer from bench_message_queue_alloc() without copying it.
+ *
+ * @param mq_id           ID of message queue
+ * @param msg_ptr         Buffer from bench_message_queue_alloc()
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_message_queue_commit(int mq_id, char *msg_ptr);
+
+/**
+ * @brief Receive a message buffer from a message queue without copying it.
+ * If no message is available, the routine will wait forever or until a message
+ * is enqueued on the message queue.
+ *
+ * @param mq_id           ID of message queue
+ * @return message buffer, to be returned with bench_message_queue_release(), or NULL in case of error
+ */
+char *bench_message_queue_receive_ref(int mq_id);
+
+/**
+ * @brief Return a message buffer from bench_message_queue_receive_ref() to the message queue.
+ *
+ * @param mq_id           ID of message queue
+ * @param msg_ptr         Buffer from bench_message_queue_receive_ref()
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_message_queue_release(int mq_id, char *msg_ptr);
+
+/**
+ * @brief Send a batch of messages to a message queue without any timeout period.
+ * Each call to the RTOS moves as many messages as fit, the routine waits
+ * forever or until space becomes available for the rest.
+ *
+ * @param mq_id           ID of message queue
+ * @param msg_ptrs        Pointer to the messages to be sent, packed back to back
+ * @param msg_len         Length of each message
+ * @param count           Number of messages to send
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_message_queue_send_many(int mq_id, char *msg_ptrs, size_t msg_len, size_t count);
+
+/**
+ * @brief Receive a batch of messages from a message queue without any timeout period.
+ * Each call to the RTOS moves as many messages as are queued, the routine waits
+ * forever or until the rest are enqueued.
+ *
+ * @param mq_id           ID of message queue
+ * @param msg_ptrs        Pointer to the buffer to save the messages, packed back to back
+ * @param msg_len         Length of each message
+ * @param count           Number of messages to receive
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_message_queue_receive_many(int mq_id, char *msg_ptrs, size_t msg_len, size_t count);
+
 /**
  * @brief Delete a message queue
  *
@@ -319,6 +534,101 @@ int bench_message_queue_receive(int mq_id, char *msg_ptr, size_t msg_len);
  */
 int bench_message_queue_delete(int mq_id, const char *mq_name);
 
+/**
+ * @brief Create a double ended queue
+ *
+ * @param dq_id           ID of deque (to be used with other routines)
+ * @param element_count   Number of elements, must be a power of two
+ * @param element_size    Size of each element in bytes
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_deque_create(int dq_id, size_t element_count, size_t element_size);
+
+/**
+ * @brief Put an element on the back of a deque, waiting forever for space.
+ *
+ * @param dq_id           ID of deque
+ * @param element         Pointer to the element
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_deque_put_back(int dq_id, const void *element);
+
+/**
+ * @brief Get an element from the front of a deque, waiting forever for data.
+ *
+ * @param dq_id           ID of deque
+ * @param element         Pointer to the buffer to save the element
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_deque_get_front(int dq_id, void *element);
+
+/**
+ * @brief Put a batch of elements on the back of a deque, waiting forever for space.
+ *
+ * @param dq_id           ID of deque
+ * @param elements        Pointer to the elements, packed back to back
+ * @param element_size    Size of each element in bytes
+ * @param count           Number of elements
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_deque_put_back_many(int dq_id, const void *elements, size_t element_size, size_t count);
+
+/**
+ * @brief Get a batch of elements from the front of a deque, waiting forever for data.
+ *
+ * @param dq_id           ID of deque
+ * @param elements        Pointer to the buffer to save the elements
+ * @param element_size    Size of each element in bytes
+ * @param count           Number of elements
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_deque_get_front_many(int dq_id, void *elements, size_t element_size, size_t count);
+
+/**
+ * @brief Delete a deque
+ *
+ * @param dq_id           ID of deque
+ */
+void bench_deque_delete(int dq_id);
+
+/**
+ * @brief Create an executor running work items on a set of pooled worker threads
+ *
+ * @param executor_id     ID of executor (to be used with other routines)
+ * @param workers         Number of worker threads
+ * @param priority        Priority of the worker threads
+ *
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_executor_create(int executor_id, uint32_t workers, int priority);
+
+/**
+ * @brief Queue a work item on an executor, waiting forever for queue space
+ *
+ * @param executor_id     ID of executor
+ * @param work_function   Function to run on a worker thread
+ * @param args            Parameter passed to the work function
+ *
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_executor_submit(int executor_id, void (*work_function)(void *), void *args);
+
+/**
+ * @brief Wait until every work item queued on an executor has run
+ *
+ * @param executor_id     ID of executor
+ *
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_executor_wait(int executor_id);
+
+/**
+ * @brief Delete an executor once its outstanding work has run
+ *
+ * @param executor_id     ID of executor
+ */
+void bench_executor_delete(int executor_id);
+
 /**
  * @brief Get a pointer to the system tick handler
  *
@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file
+ *
+ * @brief Measure the per element cost of batched deque and message queue transfers
+ *
+ * This module fills and drains a deque and a message queue in batches of 1, 8
+ * and 32 elements from a single thread and reports the cost per element. A
+ * batch of 1 goes through the single element calls, the larger batches through
+ * the many variants which take the lock and kick the waiters once per batch.
+ *
+ * This test assumes a uniprocessor system.
+ */
+
+#include "bench_api.h"
+#include "bench_utils.h"
+#include <stdio.h>
+
+#define MAIN_PRIORITY   (BENCH_LAST_PRIORITY - 2)
+
+#define DEQUE_ID        0
+#define DEQUE_SIZE      64
+#define MQ_ID           2
+#define MQ_NAME         "bench_batch_queue"
+#define ELEMENT_SIZE    4
+#define MAX_BATCH       32
+
+static const uint32_t batches[] = { 1, 8, MAX_BATCH };
+
+static uint32_t send_buf[MAX_BATCH];
+static uint32_t rcv_buf[MAX_BATCH];
+
+static struct bench_stats put_times;
+static struct bench_stats get_times;
+
+/**
+ * @brief Move @a batch elements through the deque, one call per element when the batch is 1
+ */
+static void gather_deque_stats(uint32_t iteration, uint32_t batch)
+{
+	bench_time_t  start;
+	bench_time_t  mid;
+	bench_time_t  end;
+
+	start = bench_timing_counter_get();
+	if (batch == 1)
+		bench_deque_put_back(DEQUE_ID, send_buf);
+	else
+		bench_deque_put_back_many(DEQUE_ID, send_buf, ELEMENT_SIZE, batch);
+	mid = bench_timing_counter_get();
+	if (batch == 1)
+		bench_deque_get_front(DEQUE_ID, rcv_buf);
+	else
+		bench_deque_get_front_many(DEQUE_ID, rcv_buf, ELEMENT_SIZE, batch);
+	end = bench_timing_counter_get();
+
+	bench_stats_update(&put_times, bench_timing_cycles_get(&start, &mid) / batch, iteration);
+	bench_stats_update(&get_times, bench_timing_cycles_get(&mid, &end) / batch, iteration);
+}
+
+/**
+ * @brief Move @a batch messages through the message queue, one call per message when the batch is 1
+ */
+static void gather_message_queue_stats(uint32_t iteration, uint32_t batch)
+{
+	bench_time_t  start;
+	bench_time_t  mid;
+	bench_time_t  end;
+
+	start = bench_timing_counter_get();
+	if (batch == 1)
+		bench_message_queue_send(MQ_ID, (char *)send_buf, ELEMENT_SIZE);
+	else
+		bench_message_queue_send_many(MQ_ID, (char *)send_buf, ELEMENT_SIZE, batch);
+	mid = bench_timing_counter_get();
+	if (batch == 1)
+		bench_message_queue_receive(MQ_ID, (char *)rcv_buf, ELEMENT_SIZE);
+	else
+		bench_message_queue_receive_many(MQ_ID, (char *)rcv_buf, ELEMENT_SIZE, batch);
+	end = bench_timing_counter_get();
+
+	bench_stats_update(&put_times, bench_timing_cycles_get(&start, &mid) / batch, iteration);
+	bench_stats_update(&get_times, bench_timing_cycles_get(&mid, &end) / batch, iteration);
+}
+
+/**
+ * @brief Test for the batched transfer benchmarking
+ */
+void bench_batch_queue_test(void *arg)
+{
+	char  description[60];
+	uint32_t  batch;
+	uint32_t  i;
+	size_t  j;
+
+	bench_timing_init();
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	for (i = 0; i < MAX_BATCH; i++)
+		send_buf[i] = i;
+
+	bench_deque_create(DEQUE_ID, DEQUE_SIZE, ELEMENT_SIZE);
+	bench_message_queue_create(MQ_ID, MQ_NAME, MAX_BATCH, ELEMENT_SIZE);
+
+	bench_stats_report_title("Batched queue transfer stats (per element)");
+
+	bench_timing_start();
+
+	for (j = 0; j < sizeof(batches) / sizeof(batches[0]); j++) {
+		batch = batches[j];
+
+		bench_stats_reset(&put_times);
+		bench_stats_reset(&get_times);
+		for (i = 1; i <= ITERATIONS; i++)
+			gather_deque_stats(i, batch);
+
+		snprintf(description, sizeof(description), "Deque put back (batch %lu)", (unsigned long)batch);
+		bench_stats_report_line(description, &put_times);
+		snprintf(description, sizeof(description), "Deque get front (batch %lu)", (unsigned long)batch);
+		bench_stats_report_line(description, &get_times);
+
+		bench_stats_reset(&put_times);
+		bench_stats_reset(&get_times);
+		for (i = 1; i <= ITERATIONS; i++)
+			gather_message_queue_stats(i, batch);
+
+		snprintf(description, sizeof(description), "Message queue put (batch %lu)", (unsigned long)batch);
+		bench_stats_report_line(description, &put_times);
+		snprintf(description, sizeof(description), "Message queue get (batch %lu)", (unsigned long)batch);
+		bench_stats_report_line(description, &get_times);
+	}
+
+	bench_timing_stop();
+
+	bench_message_queue_delete(MQ_ID, MQ_NAME);
+	bench_deque_delete(DEQUE_ID);
+}
+
+#ifdef RUN_BATCH_QUEUE
+int main(void)
+{
+	PRINTF("\n\r *** Starting! ***\n\n\r");
+
+	bench_test_init(bench_batch_queue_test);
+
+	PRINTF("\n\r *** Done! ***\n\r");
+
+	return 0;
+}
+#endif
@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file
+ *
+ * @brief Measure the cost of a condition variable broadcast
+ *
+ * This module measures the time to broadcast a condition variable with 1 to
+ * 16 higher priority threads waiting on it, and the time until every waiter
+ * has reacquired the mutex and is waiting again. The broadcast is made with
+ * the mutex held so the waiters can be moved onto the mutex wait queue rather
+ * than all being woken to fight over the mutex.
+ *
+ * This test assumes a uniprocessor system.
+ */
+
+#include "bench_api.h"
+#include "bench_utils.h"
+#include <stdio.h>
+
+#define CONDVAR_ID      0
+
+#define MAIN_PRIORITY   (BENCH_LAST_PRIORITY - 2)
+#define MAX_WAITERS     16
+
+static volatile bool waiters_running;
+static volatile uint32_t generation;
+static volatile uint32_t woken;
+
+static struct bench_stats time_to_broadcast;
+static struct bench_stats time_to_handoff;
+
+/**
+ * @brief Entry point of the waiter threads, count every broadcast until told to exit
+ */
+static void bench_condvar_waiter(void *args)
+{
+	ARG_UNUSED(args);
+
+	bench_condvar_lock(CONDVAR_ID);
+	while (waiters_running) {
+		uint32_t seen = generation;
+		while (generation == seen)
+			bench_condvar_wait(CONDVAR_ID);
+		++woken;
+	}
+	bench_condvar_unlock(CONDVAR_ID);
+
+	bench_thread_exit();
+}
+
+/**
+ * @brief Measure the broadcast with @a num_waiters threads waiting
+ */
+static void gather_stats(int priority, uint32_t num_waiters)
+{
+	bench_time_t  start;
+	bench_time_t  broadcast;
+	bench_time_t  end;
+	uint32_t  i;
+
+	/* Start the higher priority waiters, they run until they block on the condition variable */
+	waiters_running = true;
+	for (i = 0; i < num_waiters; i++) {
+		bench_thread_create(i, "condvar_waiter", priority - 1, bench_condvar_waiter, NULL);
+		bench_thread_start(i);
+	}
+
+	for (i = 1; i <= ITERATIONS; i++) {
+
+		woken = 0;
+
+		/* Broadcast with the mutex held, the unlock lets the waiters run */
+		bench_condvar_lock(CONDVAR_ID);
+		++generation;
+		start = bench_timing_counter_get();
+		bench_condvar_broadcast(CONDVAR_ID);
+		broadcast = bench_timing_counter_get();
+		bench_condvar_unlock(CONDVAR_ID);
+		end = bench_timing_counter_get();
+
+		if (woken != num_waiters)
+			PRINTF(" ** only %u of %u waiters woken\n", (unsigned int)woken, (unsigned int)num_waiters);
+
+		bench_stats_update(&time_to_broadcast, bench_timing_cycles_get(&start, &broadcast), i);
+		bench_stats_update(&time_to_handoff, bench_timing_cycles_get(&start, &end), i);
+	}
+
+	/* Done, release the waiters and let them exit */
+	bench_condvar_lock(CONDVAR_ID);
+	waiters_running = false;
+	++generation;
+	bench_condvar_broadcast(CONDVAR_ID);
+	bench_condvar_unlock(CONDVAR_ID);
+}
+
+/**
+ * @brief Test for the condition variable broadcast benchmarking
+ */
+void bench_condvar_broadcast_test(void *arg)
+{
+	char  description[60];
+	uint32_t  num_waiters;
+
+	bench_timing_init();
+
+	/* Lower main test thread priority */
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	bench_condvar_create(CONDVAR_ID);
+
+	bench_stats_report_title("Condition variable broadcast stats");
+
+	bench_timing_start();
+
+	for (num_waiters = 1; num_waiters <= MAX_WAITERS; num_waiters <<= 1) {
+
+		bench_stats_reset(&time_to_broadcast);
+		bench_stats_reset(&time_to_handoff);
+
+		gather_stats(MAIN_PRIORITY, num_waiters);
+		bench_collect_resources();
+
+		snprintf(description, sizeof(description), "Broadcast (%lu waiters)", (unsigned long)num_waiters);
+		bench_stats_report_line(description, &time_to_broadcast);
+		snprintf(description, sizeof(description), "Broadcast until all reacquired (%lu waiters)", (unsigned long)num_waiters);
+		bench_stats_report_line(description, &time_to_handoff);
+	}
+
+	bench_timing_stop();
+}
+
+#ifdef RUN_CONDVAR_BROADCAST
+int main(void)
+{
+	PRINTF("\n\r *** Starting! ***\n\n\r");
+
+	bench_test_init(bench_condvar_broadcast_test);
+
+	PRINTF("\n\r *** Done! ***\n\r");
+
+	return 0;
+}
+#endif
@@ -4,16 +4,37 @@
  * @file Measuring malloc and free times
  *
  * This test module measures the system usage of
- * malloc and free usage time.
+ * malloc and free usage time, and the same for a fixed
+ * block memory pool, both one block at a time and in
+ * bursts larger than the per core pool caches.
+ *
+ * Malloc and free are also measured with mixed sizes on
+ * a heap fragmented by a set of live allocations, where
+ * the worst case matters more than the average. Build
+ * with HEAP_TLSF=0 to compare against the libc allocator.
  */
 
 #include "bench_api.h"
 #include "bench_utils.h"
 
 #define TEST_SIZE 128
+#define POOL_ID 0
+#define POOL_BLOCKS 64
+#define POOL_BURST 16
+#define FRAGMENT_BLOCKS 32
+#define FRAGMENT_SIZES 5
+
+static const size_t fragment_sizes[FRAGMENT_SIZES] = { 24, 72, 200, 520, 1100 };
+static void *fragments[FRAGMENT_BLOCKS];
 
 static struct bench_stats time_to_malloc;  /* time to malloc*/
 static struct bench_stats time_to_free;    /* time to free */
+static struct bench_stats time_to_pool_alloc;  /* time to allocate a pool block */
+static struct bench_stats time_to_pool_free;   /* time to free a pool block */
+static struct bench_stats time_to_burst_alloc; /* time per block to allocate a burst */
+static struct bench_stats time_to_burst_free;  /* time per block to free a burst */
+static struct bench_stats time_to_fragmented_malloc; /* time to malloc on a fragmented heap */
+static struct bench_stats time_to_fragmented_free;   /* time to free on a fragmented heap */
 
 /**
  * @brief Reset time statistics
@@ -22,6 +43,12 @@ static void reset_time_stats(void)
 {
 	bench_stats_reset(&time_to_malloc);
 	bench_stats_reset(&time_to_free);
+	bench_stats_reset(&time_to_pool_alloc);
+	bench_stats_reset(&time_to_pool_free);
+	bench_stats_reset(&time_to_burst_alloc);
+	bench_stats_reset(&time_to_burst_free);
+	bench_stats_reset(&time_to_fragmented_malloc);
+	bench_stats_reset(&time_to_fragmented_free);
 }
 
 /**
@@ -48,6 +75,108 @@ static void gather_set1_stats(uint32_t iteration)
 				iteration);
 }
 
+/**
+ * @brief Measure time to allocate and free a single pool block.
+ */
+static void gather_set2_stats(uint32_t iteration)
+{
+	bench_time_t start;
+	bench_time_t mid;
+	bench_time_t end;
+	void *p;
+
+	start = bench_timing_counter_get();
+	p = bench_pool_alloc(POOL_ID);
+	mid = bench_timing_counter_get();
+	bench_pool_free(POOL_ID, p);
+	end = bench_timing_counter_get();
+
+	bench_stats_update(&time_to_pool_alloc,
+				bench_timing_cycles_get(&start, &mid),
+				iteration);
+	bench_stats_update(&time_to_pool_free,
+				bench_timing_cycles_get(&mid,&end),
+				iteration);
+}
+
+/**
+ * @brief Measure time per block to allocate and free a burst of pool blocks.
+ */
+static void gather_set3_stats(uint32_t iteration)
+{
+	bench_time_t start;
+	bench_time_t mid;
+	bench_time_t end;
+	void *p[POOL_BURST];
+	uint32_t i;
+
+	start = bench_timing_counter_get();
+	for (i = 0; i < POOL_BURST; i++)
+		p[i] = bench_pool_alloc(POOL_ID);
+	mid = bench_timing_counter_get();
+	for (i = 0; i < POOL_BURST; i++)
+		bench_pool_free(POOL_ID, p[i]);
+	end = bench_timing_counter_get();
+
+	bench_stats_update(&time_to_burst_alloc,
+				bench_timing_cycles_get(&start, &mid) / POOL_BURST,
+				iteration);
+	bench_stats_update(&time_to_burst_free,
+				bench_timing_cycles_get(&mid,&end) / POOL_BURST,
+				iteration);
+}
+
+/**
+ * @brief Fragment the heap by allocating mixed sizes and releasing every other one
+ */
+static void fragment_heap(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < FRAGMENT_BLOCKS; i++)
+		fragments[i] = bench_malloc(fragment_sizes[i % FRAGMENT_SIZES]);
+	for (i = 0; i < FRAGMENT_BLOCKS; i += 2) {
+		bench_free(fragments[i]);
+		fragments[i] = NULL;
+	}
+}
+
+/**
+ * @brief Release the blocks still held by @ref fragment_heap
+ */
+static void defragment_heap(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < FRAGMENT_BLOCKS; i++)
+		if (fragments[i])
+			bench_free(fragments[i]);
+}
+
+/**
+ * @brief Measure time to malloc and free a mixed size block on a fragmented heap.
+ */
+static void gather_set4_stats(uint32_t iteration)
+{
+	bench_time_t start;
+	bench_time_t mid;
+	bench_time_t end;
+	void *p;
+
+	start = bench_timing_counter_get();
+	p = bench_malloc(fragment_sizes[iteration % FRAGMENT_SIZES] + iteration % 64);
+	mid = bench_timing_counter_get();
+	bench_free(p);
+	end = bench_timing_counter_get();
+
+	bench_stats_update(&time_to_fragmented_malloc,
+				bench_timing_cycles_get(&start, &mid),
+				iteration);
+	bench_stats_update(&time_to_fragmented_free,
+				bench_timing_cycles_get(&mid,&end),
+				iteration);
+}
+
 /**
  * @brief Test setup function
  */
@@ -68,6 +197,31 @@ void bench_malloc_free(void *arg)
 	bench_stats_report_line("Malloc", &time_to_malloc);
 	bench_stats_report_line("Free", &time_to_free);
 
+	fragment_heap();
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		gather_set4_stats(i);
+	}
+
+	defragment_heap();
+
+	bench_stats_report_line("Malloc (fragmented heap)", &time_to_fragmented_malloc);
+	bench_stats_report_line("Free (fragmented heap)", &time_to_fragmented_free);
+
+	bench_pool_create(POOL_ID, POOL_BLOCKS, TEST_SIZE);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		gather_set2_stats(i);
+		gather_set3_stats(i);
+	}
+
+	bench_pool_delete(POOL_ID);
+
+	bench_stats_report_line("Pool alloc", &time_to_pool_alloc);
+	bench_stats_report_line("Pool free", &time_to_pool_free);
+	bench_stats_report_line("Pool alloc (burst, per block)", &time_to_burst_alloc);
+	bench_stats_report_line("Pool free (burst, per block)", &time_to_burst_free);
+
 	bench_timing_stop();
 }
 
@@ -8,11 +8,14 @@
  * @file Measure time for message queue create/send/receive.
  *
  * This file contains the test that measures message queue create,
- * and send/receive time between threads.
+ * and send/receive time between threads. It also compares copying
+ * 128 to 512 byte frames through the queue with passing them by
+ * reference.
  */
 
 #include "bench_api.h"
 #include "bench_utils.h"
+#include <stdio.h>
 
 #if RTOS_HAS_MESSAGE_QUEUE
 
@@ -24,8 +27,15 @@
 
 #define THREAD_HIGH   1
 
+#define FRAME_MQ_ID   1
+#define FRAME_NUM     4
+#define FRAME_MIN     128
+#define FRAME_MAX     512
+
 static char msg_send_buf [MSG_LEN + 1] = "1";
 static char msg_rcv_buf [MSG_LEN + 1] = "0";
+static char frame_send_buf [FRAME_MAX];
+static char frame_rcv_buf [FRAME_MAX];
 
 static bench_time_t timestamp_start_mq_r_c;
 static bench_time_t timestamp_end_mq_r_c;
@@ -35,6 +45,8 @@ static bench_time_t timestamp_end_mq_s_c;
 static struct bench_stats create_times;
 static struct bench_stats receive_times;
 static struct bench_stats send_times;
+static struct bench_stats copy_times;
+static struct bench_stats ref_times;
 
 /**
  * @brief Gather stats for creating message queue
@@ -81,6 +93,39 @@ static void gather_send_receive_stats(uint32_t iteration)
 
 }
 
+/**
+ * @brief Gather stats for a frame round trip, copied in and out and then by reference.
+ */
+static void gather_frame_stats(uint32_t iteration, size_t frame_len)
+{
+	bench_time_t  start;
+	bench_time_t  mid;
+	bench_time_t  end;
+	char *frame;
+
+	start = bench_timing_counter_get();
+	bench_message_queue_send(FRAME_MQ_ID, frame_send_buf, frame_len);
+	bench_message_queue_receive(FRAME_MQ_ID, frame_rcv_buf, frame_len);
+	mid = bench_timing_counter_get();
+
+	/* The producer fills the frame in place, the consumer reads it where it is */
+	frame = bench_message_queue_alloc(FRAME_MQ_ID);
+	frame[0] = frame_send_buf[0];
+	bench_message_queue_commit(FRAME_MQ_ID, frame);
+	frame = bench_message_queue_receive_ref(FRAME_MQ_ID);
+	frame_rcv_buf[0] = frame[0];
+	bench_message_queue_release(FRAME_MQ_ID, frame);
+	end = bench_timing_counter_get();
+
+	bench_stats_update(&copy_times,
+		   bench_timing_cycles_get(&start, &mid),
+		   iteration);
+
+	bench_stats_update(&ref_times,
+		   bench_timing_cycles_get(&mid, &end),
+		   iteration);
+}
+
 /**
  * @brief Test main function.
  *
@@ -214,6 +259,26 @@ void bench_message_queue_init(void *arg)
 
 	bench_message_queue_delete(MQ_ID, MQ_NAME);
 
+	for (size_t frame_len = FRAME_MIN; frame_len <= FRAME_MAX; frame_len <<= 1) {
+		char description[60];
+
+		bench_stats_reset(&copy_times);
+		bench_stats_reset(&ref_times);
+
+		bench_message_queue_create(FRAME_MQ_ID, MQ_NAME, FRAME_NUM, frame_len);
+
+		for (i = 1; i <= ITERATIONS; i++) {
+			gather_frame_stats(i, frame_len);
+		}
+
+		bench_message_queue_delete(FRAME_MQ_ID, MQ_NAME);
+
+		snprintf(description, sizeof(description), "Send + receive, copied (%lu bytes)", (unsigned long)frame_len);
+		bench_stats_report_line(description, &copy_times);
+		snprintf(description, sizeof(description), "Send + receive, by reference (%lu bytes)", (unsigned long)frame_len);
+		bench_stats_report_line(description, &ref_times);
+	}
+
 	bench_timing_stop();
 #else
 	bench_stats_report_title("Message queue stats");
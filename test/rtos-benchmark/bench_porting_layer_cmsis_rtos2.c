@@ -14,6 +14,7 @@
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <threads.h>
 #include <compiler.h>
 
 #include <sys/systick.h>
@@ -30,10 +31,16 @@ void *_rtos2_alloc(size_t size);
 void _rtos2_release(void *ptr);
 void bench_test_task(void *context);
 
-static osThreadId_t thread_ids[10] = { 0 };
+static osThreadId_t thread_ids[BENCH_MAX_THREADS] = { 0 };
 static osMessageQueueId_t queue_ids[5] = { 0 };
 static osSemaphoreId_t semaphore_ids[5] = { 0 };
+static osEventFlagsId_t event_ids[5] = { 0 };
+static osMemoryPoolId_t pool_ids[5] = { 0 };
 static osMutexId_t mutex_ids[5] = { 0 };
+static osDequeId_t deque_ids[5] = { 0 };
+static osExecutorId_t executor_ids[5] = { 0 };
+static cnd_t condvars[5];
+static mtx_t condvar_mutexes[5];
 
 void *_rtos2_alloc(size_t size)
 {
@@ -133,6 +140,27 @@ void bench_thread_abort(int thread_id)
 	}
 }
 
+int bench_thread_spawn_joinable(int thread_id, const char *thread_name, int priority, uint32_t stack_size, void (*entry_function)(void *), void *args)
+{
+	osThreadAttr_t thread_attr = { .name = thread_name, .attr_bits = osThreadJoinable, .stack_size = stack_size, .priority = osKernelPriority(priority) };
+	thread_ids[thread_id] = osThreadNew(entry_function, args, &thread_attr);
+	if (!thread_ids[thread_id]) {
+		fprintf(stderr, "failed to create thread %d: %d\n", thread_id, errno);
+		return BENCH_ERROR;
+	}
+	return BENCH_SUCCESS;
+}
+
+void bench_thread_join(int thread_id)
+{
+	osStatus_t os_status = osThreadJoin(thread_ids[thread_id]);
+	if (os_status != osOK) {
+		fprintf(stderr, "failed to join thread %d: %d\n", thread_id, os_status);
+		abort();
+	}
+	thread_ids[thread_id] = 0;
+}
+
 void bench_thread_exit(void)
 {
 	osThreadExit();
@@ -206,6 +234,15 @@ void bench_sem_give(int sem_id)
 	}
 }
 
+void bench_sem_give_forced_wake(int sem_id)
+{
+	bench_sem_give(sem_id);
+
+	/* Nobody is waiting, this is the SVC the waiter bit now skips */
+	struct rtos_semaphore *semaphore = semaphore_ids[sem_id];
+	scheduler_futex_wake(&semaphore->futex, false);
+}
+
 void bench_sem_give_from_isr(int sem_id)
 {
 	bench_sem_give(sem_id);
@@ -221,6 +258,43 @@ int bench_sem_take(int sem_id)
 	return BENCH_SUCCESS;
 }
 
+int bench_event_create(int event_id)
+{
+	event_ids[event_id] = osEventFlagsNew(0);
+	if (!event_ids[event_id]) {
+		fprintf(stderr, "failed to create event flags %d: %d\n", event_id, errno);
+		return BENCH_ERROR;
+	}
+	return BENCH_SUCCESS;
+}
+
+void bench_event_set(int event_id, uint32_t flags)
+{
+	uint32_t status = osEventFlagsSet(event_ids[event_id], flags);
+	if (status & osFlagsError) {
+		fprintf(stderr, "failed to set event flags %d: %d\n", event_id, (int)status);
+		abort();
+	}
+}
+
+void bench_event_set_forced_wake(int event_id, uint32_t flags)
+{
+	bench_event_set(event_id, flags);
+
+	/* Nobody is waiting, this is the SVC the waiter bit now skips */
+	struct rtos_eventflags *eventflags = event_ids[event_id];
+	scheduler_futex_wake(&eventflags->futex, true);
+}
+
+void bench_event_clear(int event_id, uint32_t flags)
+{
+	uint32_t status = osEventFlagsClear(event_ids[event_id], flags);
+	if (status & osFlagsError) {
+		fprintf(stderr, "failed to clear event flags %d: %d\n", event_id, (int)status);
+		abort();
+	}
+}
+
 int bench_mutex_create(int mutex_id)
 {
 	osMutexAttr_t mutex_attr = { .attr_bits = osMutexRecursive | osMutexPrioInherit };
@@ -252,6 +326,51 @@ int bench_mutex_unlock(int mutex_id)
 	return BENCH_SUCCESS;
 }
 
+int bench_condvar_create(int condvar_id)
+{
+	if (mtx_init(&condvar_mutexes[condvar_id], mtx_plain) != thrd_success || cnd_init(&condvars[condvar_id]) != thrd_success) {
+		fprintf(stderr, "failed to create condition variable %d: %d\n", condvar_id, errno);
+		return BENCH_ERROR;
+	}
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_lock(int condvar_id)
+{
+	if (mtx_lock(&condvar_mutexes[condvar_id]) != thrd_success) {
+		fprintf(stderr, "failed to lock condition variable %d: %d\n", condvar_id, errno);
+		return BENCH_ERROR;
+	}
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_unlock(int condvar_id)
+{
+	if (mtx_unlock(&condvar_mutexes[condvar_id]) != thrd_success) {
+		fprintf(stderr, "failed to unlock condition variable %d: %d\n", condvar_id, errno);
+		return BENCH_ERROR;
+	}
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_wait(int condvar_id)
+{
+	if (cnd_wait(&condvars[condvar_id], &condvar_mutexes[condvar_id]) != thrd_success) {
+		fprintf(stderr, "failed to wait on condition variable %d: %d\n", condvar_id, errno);
+		return BENCH_ERROR;
+	}
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_broadcast(int condvar_id)
+{
+	if (cnd_broadcast(&condvars[condvar_id]) != thrd_success) {
+		fprintf(stderr, "failed to broadcast condition variable %d: %d\n", condvar_id, errno);
+		return BENCH_ERROR;
+	}
+	return BENCH_SUCCESS;
+}
+
 void *bench_malloc(size_t size)
 {
 	return malloc(size);
@@ -262,6 +381,36 @@ void bench_free(void *ptr)
 	free(ptr);
 }
 
+int bench_pool_create(int pool_id, uint32_t block_count, uint32_t block_size)
+{
+	pool_ids[pool_id] = osMemoryPoolNew(block_count, block_size, 0);
+	if (!pool_ids[pool_id]) {
+		fprintf(stderr, "failed to create pool %d: %d\n", pool_id, errno);
+		return BENCH_ERROR;
+	}
+	return BENCH_SUCCESS;
+}
+
+void *bench_pool_alloc(int pool_id)
+{
+	return osMemoryPoolAlloc(pool_ids[pool_id], 0);
+}
+
+void bench_pool_free(int pool_id, void *block)
+{
+	osStatus_t os_status = osMemoryPoolFree(pool_ids[pool_id], block);
+	if (os_status != osOK) {
+		fprintf(stderr, "failed to free pool %d block: %d\n", pool_id, os_status);
+		abort();
+	}
+}
+
+void bench_pool_delete(int pool_id)
+{
+	osMemoryPoolDelete(pool_ids[pool_id]);
+	pool_ids[pool_id] = 0;
+}
+
 int bench_message_queue_create(int mq_id, const char *mq_name, size_t msg_max_num, size_t msg_max_len)
 {
 	osMessageQueueAttr_t queue_attr = { .name = mq_name };
@@ -293,6 +442,72 @@ int bench_message_queue_receive(int mq_id, char *msg_ptr, size_t msg_len)
 	return BENCH_SUCCESS;
 }
 
+char *bench_message_queue_alloc(int mq_id)
+{
+	char *msg_ptr = osMessageQueueAlloc(queue_ids[mq_id], osWaitForever);
+	if (!msg_ptr)
+		fprintf(stderr, "failed to allocate a message from queue %d\n", mq_id);
+	return msg_ptr;
+}
+
+int bench_message_queue_commit(int mq_id, char *msg_ptr)
+{
+	osStatus_t os_status = osMessageQueueCommit(queue_ids[mq_id], msg_ptr, 0);
+	if (os_status != osOK) {
+		fprintf(stderr, "failed to commit a message to queue %d: %d\n", mq_id, os_status);
+		return BENCH_ERROR;
+	}
+	return BENCH_SUCCESS;
+}
+
+char *bench_message_queue_receive_ref(int mq_id)
+{
+	char *msg_ptr = osMessageQueueReceive(queue_ids[mq_id], 0, osWaitForever);
+	if (!msg_ptr)
+		fprintf(stderr, "failed to receive a message from queue %d\n", mq_id);
+	return msg_ptr;
+}
+
+int bench_message_queue_release(int mq_id, char *msg_ptr)
+{
+	osStatus_t os_status = osMessageQueueRelease(queue_ids[mq_id], msg_ptr);
+	if (os_status != osOK) {
+		fprintf(stderr, "failed to release a message to queue %d: %d\n", mq_id, os_status);
+		return BENCH_ERROR;
+	}
+	return BENCH_SUCCESS;
+}
+
+int bench_message_queue_send_many(int mq_id, char *msg_ptrs, size_t msg_len, size_t count)
+{
+	/* A batch may be split when the queue fills up */
+	while (count > 0) {
+		int32_t sent = osMessageQueuePutMany(queue_ids[mq_id], msg_ptrs, count, 0, osWaitForever);
+		if (sent < 0) {
+			fprintf(stderr, "failed to put messages to queue %d: %ld\n", mq_id, (long)sent);
+			return BENCH_ERROR;
+		}
+		msg_ptrs += sent * msg_len;
+		count -= sent;
+	}
+	return BENCH_SUCCESS;
+}
+
+int bench_message_queue_receive_many(int mq_id, char *msg_ptrs, size_t msg_len, size_t count)
+{
+	/* A batch may be split when the queue runs dry */
+	while (count > 0) {
+		int32_t received = osMessageQueueGetMany(queue_ids[mq_id], msg_ptrs, 0, count, osWaitForever);
+		if (received < 0) {
+			fprintf(stderr, "failed to get messages from queue %d: %ld\n", mq_id, (long)received);
+			return BENCH_ERROR;
+		}
+		msg_ptrs += received * msg_len;
+		count -= received;
+	}
+	return BENCH_SUCCESS;
+}
+
 int bench_message_queue_delete(int mq_id, const char *mq_name)
 {
 	osStatus_t os_status = osMessageQueueDelete(queue_ids[mq_id]);
@@ -303,6 +518,112 @@ int bench_message_queue_delete(int mq_id, const char *mq_name)
 	return BENCH_SUCCESS;
 }
 
+int bench_deque_create(int dq_id, size_t element_count, size_t element_size)
+{
+	osDequeAttr_t deque_attr = { .name = "bench_deque" };
+	deque_ids[dq_id] = osDequeNew(element_count, element_size, &deque_attr);
+	if (!deque_ids[dq_id]) {
+		fprintf(stderr, "failed to create deque %d: %d\n", dq_id, errno);
+		return BENCH_ERROR;
+	}
+	return BENCH_SUCCESS;
+}
+
+int bench_deque_put_back(int dq_id, const void *element)
+{
+	osStatus_t os_status = osDequePutBack(deque_ids[dq_id], element, osWaitForever);
+	if (os_status != osOK) {
+		fprintf(stderr, "failed to put to the back of deque %d: %d\n", dq_id, os_status);
+		return BENCH_ERROR;
+	}
+	return BENCH_SUCCESS;
+}
+
+int bench_deque_get_front(int dq_id, void *element)
+{
+	osStatus_t os_status = osDequeGetFront(deque_ids[dq_id], element, osWaitForever);
+	if (os_status != osOK) {
+		fprintf(stderr, "failed to get from the front of deque %d: %d\n", dq_id, os_status);
+		return BENCH_ERROR;
+	}
+	return BENCH_SUCCESS;
+}
+
+int bench_deque_put_back_many(int dq_id, const void *elements, size_t element_size, size_t count)
+{
+	/* A batch may be split when the deque fills up */
+	const char *next = elements;
+	while (count > 0) {
+		int32_t put = osDequePutBackMany(deque_ids[dq_id], next, count, osWaitForever);
+		if (put < 0) {
+			fprintf(stderr, "failed to put to the back of deque %d: %ld\n", dq_id, (long)put);
+			return BENCH_ERROR;
+		}
+		next += put * element_size;
+		count -= put;
+	}
+	return BENCH_SUCCESS;
+}
+
+int bench_deque_get_front_many(int dq_id, void *elements, size_t element_size, size_t count)
+{
+	/* A batch may be split when the deque runs dry */
+	char *next = elements;
+	while (count > 0) {
+		int32_t got = osDequeGetFrontMany(deque_ids[dq_id], next, count, osWaitForever);
+		if (got < 0) {
+			fprintf(stderr, "failed to get from the front of deque %d: %ld\n", dq_id, (long)got);
+			return BENCH_ERROR;
+		}
+		next += got * element_size;
+		count -= got;
+	}
+	return BENCH_SUCCESS;
+}
+
+void bench_deque_delete(int dq_id)
+{
+	osDequeDelete(deque_ids[dq_id]);
+	deque_ids[dq_id] = 0;
+}
+
+int bench_executor_create(int executor_id, uint32_t workers, int priority)
+{
+	osExecutorAttr_t executor_attr = { .name = "bench_executor", .priority = osKernelPriority(priority) };
+	executor_ids[executor_id] = osExecutorNew(workers, 16, &executor_attr);
+	if (!executor_ids[executor_id]) {
+		fprintf(stderr, "failed to create executor %d: %d\n", executor_id, errno);
+		return BENCH_ERROR;
+	}
+	return BENCH_SUCCESS;
+}
+
+int bench_executor_submit(int executor_id, void (*work_function)(void *), void *args)
+{
+	osStatus_t os_status = osExecutorSubmit(executor_ids[executor_id], work_function, args, osWaitForever);
+	if (os_status != osOK) {
+		fprintf(stderr, "failed to submit to executor %d: %d\n", executor_id, os_status);
+		return BENCH_ERROR;
+	}
+	return BENCH_SUCCESS;
+}
+
+int bench_executor_wait(int executor_id)
+{
+	osStatus_t os_status = osExecutorWait(executor_ids[executor_id], osWaitForever);
+	if (os_status != osOK) {
+		fprintf(stderr, "failed to wait for executor %d: %d\n", executor_id, os_status);
+		return BENCH_ERROR;
+	}
+	return BENCH_SUCCESS;
+}
+
+void bench_executor_delete(int executor_id)
+{
+	osExecutorDelete(executor_ids[executor_id]);
+	executor_ids[executor_id] = 0;
+}
+
 bench_isr_handler_t bench_timer_isr_get(void)
 {
 	bench_isr_handler_t *table = (bench_isr_handler_t *)SCB->VTOR;
@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file
+ *
+ * @brief Measure context switch latency against the ready queue depth
+ *
+ * This module measures the time to yield to a thread of equal priority
+ * while 2 to 64 threads are ready to run. Every yield pushes the yielding
+ * thread back onto the ready queue behind all other ready threads of the
+ * same priority, so the cost of a switch should stay flat as the number of
+ * ready threads grows.
+ *
+ * This test assumes a uniprocessor system.
+ */
+
+#include "bench_api.h"
+#include "bench_utils.h"
+#include <stdio.h>
+
+#define MAIN_PRIORITY   (BENCH_LAST_PRIORITY - 2)
+#define MAX_READY       64
+
+static volatile bool helpers_running;
+
+static struct bench_stats time_to_switch;
+
+/**
+ * @brief Entry point of the helper threads, yield until the test aborts us
+ */
+static void bench_ready_queue_helper(void *args)
+{
+	ARG_UNUSED(args);
+
+	while (helpers_running)
+		bench_yield();
+
+	bench_thread_exit();
+}
+
+/**
+ * @brief Measure the switch latency with @a num_ready threads ready to run
+ */
+static void gather_stats(int priority, uint32_t num_ready)
+{
+	bench_time_t  start;
+	bench_time_t  end;
+	uint32_t  i;
+
+	/* Start the equal priority helpers, the main thread is the last ready thread */
+	helpers_running = true;
+	for (i = 0; i < num_ready - 1; i++) {
+		bench_thread_create(i, "ready_queue_helper", priority, bench_ready_queue_helper, NULL);
+		bench_thread_start(i);
+	}
+
+	/* Let every helper run up to its first yield so startup is not measured */
+	bench_yield();
+
+	for (i = 1; i <= ITERATIONS; i++) {
+
+		/* A full round robin pass is one switch per ready thread */
+		start = bench_timing_counter_get();
+		bench_yield();
+		end = bench_timing_counter_get();
+
+		bench_stats_update(&time_to_switch,
+				   bench_timing_cycles_get(&start, &end) / num_ready,
+				   i);
+	}
+
+	/* Done, abort the helpers, they're all on the ready queue */
+	helpers_running = false;
+	for (i = 0; i < num_ready - 1; i++)
+		bench_thread_abort(i);
+}
+
+/**
+ * @brief Test for the ready queue benchmarking
+ */
+void bench_ready_queue(void *arg)
+{
+	char  description[60];
+	uint32_t  num_ready;
+
+	bench_timing_init();
+
+	/* Lower main test thread priority */
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	bench_stats_report_title("Ready queue stats");
+
+	bench_timing_start();
+
+	for (num_ready = 2; num_ready <= MAX_READY; num_ready <<= 1) {
+
+		bench_stats_reset(&time_to_switch);
+
+		gather_stats(MAIN_PRIORITY, num_ready);
+		bench_collect_resources();
+
+		snprintf(description, sizeof(description), "Yield (context switch, %lu ready)", (unsigned long)num_ready);
+		bench_stats_report_line(description, &time_to_switch);
+	}
+
+	bench_timing_stop();
+}
+
+#ifdef RUN_READY_QUEUE
+int main(void)
+{
+	PRINTF("\n\r *** Starting! ***\n\n\r");
+
+	bench_test_init(bench_ready_queue);
+
+	PRINTF("\n\r *** Done! ***\n\r");
+
+	return 0;
+}
+#endif
@@ -4,7 +4,10 @@
  * @file Measure time for semaphore give and take
  *
  * This file contains the test that measures semaphore give and
- * take time in one thread.
+ * take time in one thread. It also measures a give on an empty semaphore
+ * and an event flags set with nobody waiting, both of which must stay out
+ * of the kernel. Each is measured again with the futex wake forced, which
+ * is what they cost before the waiter bit, so one run shows both paths.
  */
 
 #include "bench_api.h"
@@ -12,6 +15,10 @@
 
 static struct bench_stats take_times;
 static struct bench_stats give_times;
+static struct bench_stats give_empty_times;
+static struct bench_stats give_forced_times;
+static struct bench_stats set_times;
+static struct bench_stats set_forced_times;
 
 /**
  * @brief Test main function
@@ -57,6 +64,74 @@ void bench_sem_signal_release()
 	bench_timing_stop();
 
 	bench_stats_report_line("Take (no context switch)", &take_times);
+
+	/* Measure average give on an empty semaphore with no waiters */
+	bench_timing_start();
+	bench_stats_reset(&give_empty_times);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		timestamp_start = bench_timing_counter_get();
+		bench_sem_give(0);
+		timestamp_end = bench_timing_counter_get();
+		bench_sem_take(0);
+		diff = bench_timing_cycles_get(&timestamp_start, &timestamp_end);
+		bench_stats_update(&give_empty_times, diff, i);
+	}
+
+	bench_timing_stop();
+
+	bench_stats_report_line("Give from empty (no waiters)", &give_empty_times);
+
+	/* Same again but always entering the kernel */
+	bench_timing_start();
+	bench_stats_reset(&give_forced_times);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		timestamp_start = bench_timing_counter_get();
+		bench_sem_give_forced_wake(0);
+		timestamp_end = bench_timing_counter_get();
+		bench_sem_take(0);
+		diff = bench_timing_cycles_get(&timestamp_start, &timestamp_end);
+		bench_stats_update(&give_forced_times, diff, i);
+	}
+
+	bench_timing_stop();
+
+	bench_stats_report_line("Give from empty (forced wake)", &give_forced_times);
+
+	/* Measure average event flags set with no waiters */
+	bench_timing_start();
+	bench_stats_reset(&set_times);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		timestamp_start = bench_timing_counter_get();
+		bench_event_set(0, 1);
+		timestamp_end = bench_timing_counter_get();
+		bench_event_clear(0, 1);
+		diff = bench_timing_cycles_get(&timestamp_start, &timestamp_end);
+		bench_stats_update(&set_times, diff, i);
+	}
+
+	bench_timing_stop();
+
+	bench_stats_report_line("Event flags set (no waiters)", &set_times);
+
+	/* Same again but always entering the kernel */
+	bench_timing_start();
+	bench_stats_reset(&set_forced_times);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		timestamp_start = bench_timing_counter_get();
+		bench_event_set_forced_wake(0, 1);
+		timestamp_end = bench_timing_counter_get();
+		bench_event_clear(0, 1);
+		diff = bench_timing_cycles_get(&timestamp_start, &timestamp_end);
+		bench_stats_update(&set_forced_times, diff, i);
+	}
+
+	bench_timing_stop();
+
+	bench_stats_report_line("Event flags set (forced wake)", &set_forced_times);
 }
 
 /**
@@ -67,6 +142,7 @@ void bench_sem_signal_release_init(void *param)
 	bench_timing_init();
 
 	bench_sem_create(0, 0, ITERATIONS);
+	bench_event_create(0);
 
 	bench_sem_signal_release();
 }
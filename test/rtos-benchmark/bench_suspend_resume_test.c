@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file
+ *
+ * @brief Measure suspend/resume ping-pong latency against the number of tasks
+ *
+ * This module measures the time for the main thread to resume a higher
+ * priority thread which immediately suspends itself again, with 8, 32 and
+ * 128 threads in the system. Both the resume and the suspend validate the
+ * target thread handle, so the round trip should not grow with the number
+ * of threads.
+ *
+ * The ping-pong thread is the most recently created thread, the other
+ * threads stay suspended for the duration of the test.
+ *
+ * This test assumes a uniprocessor system.
+ */
+
+#include "bench_api.h"
+#include "bench_utils.h"
+#include <stdio.h>
+
+#define MAIN_PRIORITY   (BENCH_LAST_PRIORITY - 2)
+#define MIN_TASKS       8
+#define MAX_TASKS       128
+
+static volatile int ping_pong_id;
+
+static struct bench_stats time_to_ping_pong;
+
+/**
+ * @brief Entry point of the helper threads, suspend ourselves every time we are resumed
+ */
+static void bench_suspend_resume_helper(void *args)
+{
+	ARG_UNUSED(args);
+
+	while (true)
+		bench_thread_suspend(ping_pong_id);
+}
+
+/**
+ * @brief Measure the resume/suspend round trip with @a num_tasks threads
+ */
+static void gather_stats(int priority, uint32_t num_tasks)
+{
+	bench_time_t  start;
+	bench_time_t  end;
+	uint32_t  i;
+
+	/* Create the helpers suspended, the main thread counts as one of the tasks */
+	for (i = 0; i < num_tasks - 1; i++)
+		bench_thread_create(i, "suspend_resume_helper", priority - 1, bench_suspend_resume_helper, NULL);
+	ping_pong_id = num_tasks - 2;
+
+	/* Run the helper up to its first suspend so startup is not measured */
+	bench_thread_start(ping_pong_id);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+
+		/* Resume the higher priority helper, it runs and suspends itself */
+		start = bench_timing_counter_get();
+		bench_thread_resume(ping_pong_id);
+		end = bench_timing_counter_get();
+
+		bench_stats_update(&time_to_ping_pong,
+				   bench_timing_cycles_get(&start, &end),
+				   i);
+	}
+
+	/* Done, abort the helpers, they're all suspended */
+	for (i = 0; i < num_tasks - 1; i++)
+		bench_thread_abort(i);
+}
+
+/**
+ * @brief Test for the suspend/resume benchmarking
+ */
+void bench_suspend_resume(void *arg)
+{
+	char  description[60];
+	uint32_t  num_tasks;
+
+	bench_timing_init();
+
+	/* Lower main test thread priority */
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	bench_stats_report_title("Suspend/resume stats");
+
+	bench_timing_start();
+
+	for (num_tasks = MIN_TASKS; num_tasks <= MAX_TASKS; num_tasks <<= 2) {
+
+		bench_stats_reset(&time_to_ping_pong);
+
+		gather_stats(MAIN_PRIORITY, num_tasks);
+		bench_collect_resources();
+
+		snprintf(description, sizeof(description), "Resume/suspend ping-pong (%lu tasks)", (unsigned long)num_tasks);
+		bench_stats_report_line(description, &time_to_ping_pong);
+	}
+
+	bench_timing_stop();
+}
+
+#ifdef RUN_SUSPEND_RESUME
+int main(void)
+{
+	PRINTF("\n\r *** Starting! ***\n\n\r");
+
+	bench_test_init(bench_suspend_resume);
+
+	PRINTF("\n\r *** Done! ***\n\r");
+
+	return 0;
+}
+#endif
@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file
+ *
+ * @brief Measure the cost of running short lived work
+ *
+ * This module measures spawning and joining a short lived thread whose stack
+ * comes from the thread pools against one whose stack is too large for any
+ * pool class and so goes through the heap, and compares both with handing
+ * the same work to an executor running on pooled worker threads.
+ *
+ * The threads run at a lower priority than the main thread so the spawn cost
+ * does not include running the thread, the join does.
+ *
+ * This test assumes a uniprocessor system.
+ */
+
+#include "bench_api.h"
+#include "bench_utils.h"
+#include <stdio.h>
+
+#define MAIN_PRIORITY   (BENCH_LAST_PRIORITY - 2)
+#define WORKER_PRIORITY (MAIN_PRIORITY + 1)
+
+#define THREAD_ID       0
+#define EXECUTOR_ID     0
+
+/* The default stack fits the small pool class, the large one does not fit any class */
+#define POOLED_STACK_SIZE    0
+#define UNPOOLED_STACK_SIZE  4096
+
+static volatile uint32_t work_done;
+
+static struct bench_stats time_to_spawn;
+static struct bench_stats time_to_join;
+
+/**
+ * @brief The short lived work
+ */
+static void bench_spawn_work(void *args)
+{
+	ARG_UNUSED(args);
+
+	++work_done;
+}
+
+/**
+ * @brief Spawn and join a thread with the given stack size
+ */
+static void gather_thread_stats(uint32_t iteration, uint32_t stack_size)
+{
+	bench_time_t  start;
+	bench_time_t  spawned;
+	bench_time_t  end;
+
+	start = bench_timing_counter_get();
+	bench_thread_spawn_joinable(THREAD_ID, "spawn_work", WORKER_PRIORITY, stack_size, bench_spawn_work, NULL);
+	spawned = bench_timing_counter_get();
+	bench_thread_join(THREAD_ID);
+	end = bench_timing_counter_get();
+
+	bench_stats_update(&time_to_spawn, bench_timing_cycles_get(&start, &spawned), iteration);
+	bench_stats_update(&time_to_join, bench_timing_cycles_get(&start, &end), iteration);
+}
+
+/**
+ * @brief Submit the work to the executor and wait for it to complete
+ */
+static void gather_executor_stats(uint32_t iteration)
+{
+	bench_time_t  start;
+	bench_time_t  submitted;
+	bench_time_t  end;
+
+	start = bench_timing_counter_get();
+	bench_executor_submit(EXECUTOR_ID, bench_spawn_work, NULL);
+	submitted = bench_timing_counter_get();
+	bench_executor_wait(EXECUTOR_ID);
+	end = bench_timing_counter_get();
+
+	bench_stats_update(&time_to_spawn, bench_timing_cycles_get(&start, &submitted), iteration);
+	bench_stats_update(&time_to_join, bench_timing_cycles_get(&start, &end), iteration);
+}
+
+/**
+ * @brief Test for the thread spawn benchmarking
+ */
+void bench_thread_spawn_test(void *arg)
+{
+	uint32_t  i;
+
+	bench_timing_init();
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	bench_executor_create(EXECUTOR_ID, 1, WORKER_PRIORITY);
+
+	bench_stats_report_title("Thread spawn stats");
+
+	bench_timing_start();
+
+	/* Pooled stacks */
+	bench_stats_reset(&time_to_spawn);
+	bench_stats_reset(&time_to_join);
+	for (i = 1; i <= ITERATIONS; i++)
+		gather_thread_stats(i, POOLED_STACK_SIZE);
+	bench_stats_report_line("Spawn thread (pooled)", &time_to_spawn);
+	bench_stats_report_line("Spawn and join thread (pooled)", &time_to_join);
+
+	/* Heap allocated stacks */
+	bench_stats_reset(&time_to_spawn);
+	bench_stats_reset(&time_to_join);
+	for (i = 1; i <= ITERATIONS; i++)
+		gather_thread_stats(i, UNPOOLED_STACK_SIZE);
+	bench_stats_report_line("Spawn thread (heap)", &time_to_spawn);
+	bench_stats_report_line("Spawn and join thread (heap)", &time_to_join);
+
+	/* Executor work items */
+	bench_stats_reset(&time_to_spawn);
+	bench_stats_reset(&time_to_join);
+	for (i = 1; i <= ITERATIONS; i++)
+		gather_executor_stats(i);
+	bench_stats_report_line("Executor submit", &time_to_spawn);
+	bench_stats_report_line("Executor submit and wait", &time_to_join);
+
+	bench_timing_stop();
+
+	if (work_done != ITERATIONS * 3)
+		PRINTF(" ** only %u of %u work items ran\n", (unsigned int)work_done, (unsigned int)(ITERATIONS * 3));
+
+	bench_executor_delete(EXECUTOR_ID);
+}
+
+#ifdef RUN_THREAD_SPAWN
+int main(void)
+{
+	PRINTF("\n\r *** Starting! ***\n\n\r");
+
+	bench_test_init(bench_thread_spawn_test);
+
+	PRINTF("\n\r *** Done! ***\n\r");
+
+	return 0;
+}
+#endif
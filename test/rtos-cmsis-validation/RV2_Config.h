@@ -177,6 +177,7 @@
 //     <q37>TC_ThreadSuspendResume
 //     <q38>TC_ThreadReturn
 //     <q39>TC_ThreadAllocation
+//     <q40>TC_ThreadPool
 #define TC_OSTHREAD_EN                    1
 #define TC_OSTHREADNEW_1_EN               1
 #define TC_OSTHREADNEW_2_EN               1
@@ -217,6 +218,7 @@
 #define TC_THREADSUSPENDRESUME_EN         1
 #define TC_THREADRETURN_EN                1
 #define TC_THREADALLOCATION_EN            1
+#define TC_THREADPOOL_EN                  1
 //   </e>
 
 //   <e0>Thread Flags
@@ -242,9 +244,11 @@
 //   <e0>Generic Wait Functions
 //     <q01>TC_GenWaitBasic
 //     <q02>TC_GenWaitInterrupts
+//     <q03>TC_GenWaitMultiple
 #define TC_OSDELAY_EN                     1
 #define TC_GENWAITBASIC_EN                1
 #define TC_GENWAITINTERRUPTS_EN           1
+#define TC_GENWAITMULTIPLE_EN             1
 //   </e>
 
 //   <e0>Timer Management
@@ -261,6 +265,7 @@
 //     <q11>TC_TimerAllocation
 //     <q12>TC_TimerOneShot
 //     <q13>TC_TimerPeriodic
+//     <q14>TC_TimerSwi
 #define TC_OSTIMER_EN                     1
 #define TC_OSTIMERNEW_1_EN                1
 #define TC_OSTIMERNEW_2_EN                1
@@ -275,6 +280,7 @@
 #define TC_TIMERONESHOT_EN                1
 #define TC_TIMERPERIODIC_EN               1
 #define TC_TIMERALLOCATION_EN             1
+#define TC_TIMERSWI_EN                    1
 //   </e>
 
 //   <e0>Event Flags
@@ -329,6 +335,7 @@
 //     <q17>TC_MutexNestedAcquire
 //     <q18>TC_MutexPriorityInversion
 //     <q19>TC_MutexOwnership
+//     <q20>TC_MutexPrioCeiling
 #define TC_OSMUTEX_EN                     1
 #define TC_OSMUTEXNEW_1_EN                1
 #define TC_OSMUTEXNEW_2_EN                1
@@ -349,6 +356,7 @@
 #define TC_MUTEXNESTEDACQUIRE_EN          1
 #define TC_MUTEXPRIORITYINVERSION_EN      1
 #define TC_MUTEXOWNERSHIP_EN              1
+#define TC_MUTEXPRIOCEILING_EN            1
 //   </e>
 
 //   <e0>Semaphores
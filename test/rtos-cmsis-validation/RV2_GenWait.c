@@ -16,6 +16,7 @@
  * limitations under the License.
  */
 
+#include <string.h>
 #include "cmsis_rv2.h"
 
 /*-----------------------------------------------------------------------------
@@ -23,6 +24,15 @@
  *----------------------------------------------------------------------------*/
 void Irq_GenWaitInterrupts (void);
 
+#if (TC_GENWAITMULTIPLE_EN)
+/*-----------------------------------------------------------------------------
+ * Set the event flags passed as argument to wake a multi object waiter
+ *----------------------------------------------------------------------------*/
+static void Th_GenWaitMultipleSet (void *arg) {
+  osEventFlagsSet ((osEventFlagsId_t)arg, 0x2U);
+}
+#endif
+
 /*-----------------------------------------------------------------------------
  *      Test cases
  *----------------------------------------------------------------------------*/
@@ -97,6 +107,81 @@ void TC_GenWaitInterrupts (void) {
 }
 #endif
 
+/*=======0=========1=========2=========3=========4=========5=========6=========7=========8=========9=========0=========1====*/
+/**
+\brief Test case: TC_GenWaitMultiple
+\details
+- Call osWaitMultiple on an unsignalled semaphore and event flags without timeout
+- Call osWaitMultiple with timeout and wait until the timeout expires
+- Release the semaphore and check only it is reported as ready and no token is consumed
+- Block in osWaitMultiple and wake it by setting the event flags from another thread
+- Call osWaitMultiple with invalid parameters
+*/
+void TC_GenWaitMultiple (void) {
+#if (TC_GENWAITMULTIPLE_EN)
+  osSemaphoreId_t sem;
+  osEventFlagsId_t ef;
+  osThreadId_t id;
+  osWaitObject_t objects[2];
+  uint32_t cnt[2];
+
+  sem = osSemaphoreNew (1U, 0U, NULL);
+  ASSERT_TRUE (sem != NULL);
+  ef = osEventFlagsNew (NULL);
+  ASSERT_TRUE (ef != NULL);
+
+  if ((sem != NULL) && (ef != NULL)) {
+    memset (objects, 0, sizeof(objects));
+    objects[0].type = osWaitSemaphore;
+    objects[0].object = sem;
+    objects[1].type = osWaitEventFlags;
+    objects[1].object = ef;
+    objects[1].flags = 0x3U;
+    objects[1].options = osFlagsWaitAny;
+
+    /* Nothing ready, try semantics */
+    ASSERT_TRUE (osWaitMultiple (objects, 2U, 0U) == osErrorResource);
+
+    /* Nothing ready, wait for the timeout */
+    osDelay(1);
+    cnt[0] = osKernelGetTickCount();
+    ASSERT_TRUE (osWaitMultiple (objects, 2U, 10U) == osErrorTimeout);
+    cnt[1] = osKernelGetTickCount();
+    ASSERT_TRUE ((cnt[1]-cnt[0]) >= 10U);
+
+    /* Only the semaphore is ready and the token is left in place */
+    ASSERT_TRUE (osSemaphoreRelease (sem) == osOK);
+    ASSERT_TRUE (osWaitMultiple (objects, 2U, osWaitForever) == 1);
+    ASSERT_TRUE (objects[0].ready == 1U);
+    ASSERT_TRUE (objects[1].ready == 0U);
+    ASSERT_TRUE (osSemaphoreGetCount (sem) == 1U);
+    ASSERT_TRUE (osSemaphoreAcquire (sem, 0U) == osOK);
+
+    /* Block until another thread sets the event flags */
+    id = osThreadNew (Th_GenWaitMultipleSet, ef, NULL);
+    ASSERT_TRUE (id != NULL);
+    ASSERT_TRUE (osWaitMultiple (objects, 2U, 100U) == 1);
+    ASSERT_TRUE (objects[0].ready == 0U);
+    ASSERT_TRUE (objects[1].ready == 0x2U);
+    ASSERT_TRUE (osEventFlagsClear (ef, 0x2U) == 0x2U);
+    osDelay(10);
+
+    /* Bad parameters */
+    ASSERT_TRUE (osWaitMultiple (NULL, 2U, 0U) == osErrorParameter);
+    ASSERT_TRUE (osWaitMultiple (objects, 0U, 0U) == osErrorParameter);
+    objects[0].object = NULL;
+    ASSERT_TRUE (osWaitMultiple (objects, 2U, 0U) == osErrorParameter);
+  }
+
+  if (sem != NULL) {
+    ASSERT_TRUE (osSemaphoreDelete (sem) == osOK);
+  }
+  if (ef != NULL) {
+    ASSERT_TRUE (osEventFlagsDelete (ef) == osOK);
+  }
+#endif
+}
+
 /*-----------------------------------------------------------------------------
  * TC_GenWaitInterrupts: ISR handler
  *----------------------------------------------------------------------------*/
@@ -48,7 +48,7 @@ static void RecursiveMutexAcquire (uint32_t depth, uint32_t ctrl);
 /*-----------------------------------------------------------------------------
  * Mutex high prio acquiring thread
  *----------------------------------------------------------------------------*/
-#if (TC_MUTEXROBUST_EN) || (TC_MUTEXPRIOINHERIT_EN)
+#if (TC_MUTEXROBUST_EN) || (TC_MUTEXPRIOINHERIT_EN) || (TC_MUTEXPRIOCEILING_EN)
 void Th_MutexHighPrioAcq (void *arg) {
   uint32_t *cnt = (uint32_t *)arg;
   ASSERT_TRUE (osMutexAcquire (MutexId, osWaitForever) == osOK);
@@ -212,7 +212,7 @@ void Th_HighPrioJob (void *arg) {
 /*-----------------------------------------------------------------------------
  * Low priority thread which acquires a mutex object
  *----------------------------------------------------------------------------*/
-#if (TC_MUTEXOWNERSHIP_EN)
+#if (TC_MUTEXOWNERSHIP_EN) || (TC_MUTEXPRIOCEILING_EN)
 void Th_MutexAcqLow  (void __attribute__((unused)) *arg) {
   ASSERT_TRUE (osMutexAcquire (MutexId, 0) == osOK);
   osThreadFlagsWait (1, 0, 100);
@@ -830,6 +830,145 @@ void TC_MutexPrioInherit (void) {
 #endif
 }
 
+/*=======0=========1=========2=========3=========4=========5=========6=========7=========8=========9=========0=========1====*/
+/**
+\brief Test case: TC_MutexPrioCeiling
+\details
+- Check that ceiling and inheritance can not be combined
+- Acquire a ceiling mutex and check that the priority is raised to the ceiling
+- Create a thread above the owner but below the ceiling and check it does not run until release
+- Check that the priority is restored on release
+- Check that a failed acquire leaves the priority unchanged
+- Check that a thread above the ceiling can not acquire the mutex
+*/
+void TC_MutexPrioCeiling (void) {
+#if (TC_MUTEXPRIOCEILING_EN)
+  osThreadAttr_t th_attr = { NULL, osThreadDetached, NULL, 0U, NULL, 0U, osPriorityAboveNormal, 0U, 0U};
+  osThreadId_t id[2];
+  uint32_t cnt = 0;
+  osMutexAttr_t attr = {NULL, osMutexPrioInherit | osMutexCeiling(osPriorityHigh), NULL, 0U};
+
+  /* Get thread id */
+  id[0] = osThreadGetId();
+  ASSERT_TRUE (osThreadSetPriority (id[0], osPriorityNormal) == osOK);
+
+  /* Ceiling and inheritance are exclusive */
+  ASSERT_TRUE (osMutexNew (&attr) == NULL);
+
+  /* Create and initialize a mutex object */
+  attr.attr_bits = osMutexCeiling(osPriorityHigh);
+  MutexId = osMutexNew (&attr);
+  ASSERT_TRUE (MutexId != NULL);
+
+  if (MutexId != NULL) {
+    /* Acquire mutex */
+    ASSERT_TRUE (osMutexAcquire (MutexId, 0) == osOK);
+
+    /* Check that the priority has been raised to the ceiling */
+    ASSERT_TRUE (osThreadGetPriority (id[0]) == osPriorityHigh);
+
+    /* Create a higher priority thread that tries to acquire the mutex, it must not run yet */
+    id[1] = osThreadNew (Th_MutexHighPrioAcq, &cnt, &th_attr);
+    ASSERT_TRUE (id[1] != NULL);
+    ASSERT_TRUE (cnt == 0);
+
+    /* Release mutex */
+    ASSERT_TRUE (osMutexRelease (MutexId) == osOK);
+
+    /* Check that priority has been restored and the child thread ran */
+    ASSERT_TRUE (osThreadGetPriority (id[0]) == osPriorityNormal);
+    ASSERT_TRUE (cnt == 1);
+
+    /* Terminate child thread, it still owns the mutex */
+    ASSERT_TRUE (osThreadTerminate (id[1]) == osOK);
+    ASSERT_TRUE (osMutexDelete (MutexId) == osOK);
+  }
+
+  /* Create a mutex and let a child at the ceiling hold it */
+  MutexId = osMutexNew (&attr);
+  ASSERT_TRUE (MutexId != NULL);
+
+  if (MutexId != NULL) {
+    th_attr.priority = osPriorityHigh;
+    id[1] = osThreadNew (Th_MutexAcqLow, NULL, &th_attr);
+    ASSERT_TRUE (id[1] != NULL);
+
+    if (id[1] != NULL) {
+      /* A failed try must not leave us at the ceiling */
+      ASSERT_TRUE (osMutexAcquire (MutexId, 0) == osErrorResource);
+      ASSERT_TRUE (osThreadGetPriority (id[0]) == osPriorityNormal);
+
+      /* Let the child release the mutex */
+      ASSERT_TRUE ((int32_t)osThreadFlagsSet(id[1], 1) >= 0);
+      ASSERT_TRUE (osMutexGetOwner (MutexId) == NULL);
+      ASSERT_TRUE (osThreadTerminate (id[1]) == osOK);
+    }
+
+    /* A thread above the ceiling breaks the protocol */
+    ASSERT_TRUE (osThreadSetPriority (id[0], osPriorityRealtime) == osOK);
+    ASSERT_TRUE (osMutexAcquire (MutexId, 0) == osErrorParameter);
+    ASSERT_TRUE (osThreadSetPriority (id[0], osPriorityNormal) == osOK);
+    ASSERT_TRUE (osMutexGetOwner (MutexId) == NULL);
+
+    ASSERT_TRUE (osMutexDelete (MutexId) == osOK);
+  }
+#endif
+}
+
+/*=======0=========1=========2=========3=========4=========5=========6=========7=========8=========9=========0=========1====*/
+/**
+\brief Test case: TC_MutexPrioCeilingNested
+\details
+- Acquire two ceiling mutexes in turn and check the priority steps up to each ceiling
+- Release them in reverse order and check the priority steps back down
+- Check that a recursive ceiling mutex only restores on the last release
+*/
+void TC_MutexPrioCeilingNested (void) {
+#if (TC_MUTEXPRIOCEILING_EN)
+  osMutexAttr_t attr = {NULL, osMutexCeiling(osPriorityAboveNormal), NULL, 0U};
+  osMutexId_t id[2];
+  osThreadId_t ctrl_id;
+
+  /* Ensure that priority of the control thread is set to normal */
+  ctrl_id = osThreadGetId();
+  ASSERT_TRUE (osThreadSetPriority (ctrl_id, osPriorityNormal) == osOK);
+
+  /* Create the mutexes */
+  id[0] = osMutexNew (&attr);
+  ASSERT_TRUE (id[0] != NULL);
+  attr.attr_bits = osMutexRecursive | osMutexCeiling(osPriorityHigh);
+  id[1] = osMutexNew (&attr);
+  ASSERT_TRUE (id[1] != NULL);
+
+  if ((id[0] != NULL) && (id[1] != NULL)) {
+    /* Step up */
+    ASSERT_TRUE (osMutexAcquire (id[0], 0) == osOK);
+    ASSERT_TRUE (osThreadGetPriority (ctrl_id) == osPriorityAboveNormal);
+    ASSERT_TRUE (osMutexAcquire (id[1], 0) == osOK);
+    ASSERT_TRUE (osThreadGetPriority (ctrl_id) == osPriorityHigh);
+
+    /* Recursive acquire and release keeps the ceiling */
+    ASSERT_TRUE (osMutexAcquire (id[1], 0) == osOK);
+    ASSERT_TRUE (osMutexRelease (id[1]) == osOK);
+    ASSERT_TRUE (osThreadGetPriority (ctrl_id) == osPriorityHigh);
+
+    /* Step down */
+    ASSERT_TRUE (osMutexRelease (id[1]) == osOK);
+    ASSERT_TRUE (osThreadGetPriority (ctrl_id) == osPriorityAboveNormal);
+    ASSERT_TRUE (osMutexRelease (id[0]) == osOK);
+    ASSERT_TRUE (osThreadGetPriority (ctrl_id) == osPriorityNormal);
+  }
+
+  /* Delete the mutexes */
+  if (id[0] != NULL) {
+    ASSERT_TRUE (osMutexDelete (id[0]) == osOK);
+  }
+  if (id[1] != NULL) {
+    ASSERT_TRUE (osMutexDelete (id[1]) == osOK);
+  }
+#endif
+}
+
 /*=======0=========1=========2=========3=========4=========5=========6=========7=========8=========9=========0=========1====*/
 /**
 \brief Test case: TC_MutexCheckTimeout
@@ -2355,6 +2355,98 @@ void TC_ThreadAllocation (void) {
 #endif
 }
 
+/*-----------------------------------------------------------------------------
+ * TC_ThreadPool: Helpers
+ *----------------------------------------------------------------------------*/
+#if (TC_THREADPOOL_EN)
+static volatile uint32_t Var_PoolWork;
+
+void Th_PoolStack (void *arg);
+void Wk_PoolWork  (void *arg);
+
+void Th_PoolStack (void *arg) {
+  volatile uint8_t buf[256];
+  uint32_t i;
+
+  /* Dirty part of the stack so the next user of the slot has something to re-mark */
+  for (i = 0U; i < sizeof(buf); i++) {
+    buf[i] = (uint8_t)i;
+  }
+  (void)arg;
+}
+
+void Wk_PoolWork (void *arg) {
+  Var_PoolWork += (uint32_t)arg;
+}
+#endif
+
+/*=======0=========1=========2=========3=========4=========5=========6=========7=========8=========9=========0=========1====*/
+/**
+\brief Test case: TC_ThreadPool
+\details
+- Create a joinable thread with the default stack size and check it takes a pooled slot
+- Join the thread and check the slot is returned
+- Reuse the slot and check the stack space is still fully accounted for
+- Create an executor and run work items on it
+- Delete the executor
+*/
+void TC_ThreadPool (void) {
+#if (TC_THREADPOOL_EN)
+  osThreadAttr_t attr = { NULL, osThreadJoinable, NULL, 0U, NULL, 0U, osPriorityBelowNormal, 0U, 0U };
+  osThreadPoolInfo_t before, during, after;
+  osExecutorId_t executor;
+  osThreadId_t id;
+  uint32_t i;
+
+  /* Let the reaper return any slots held by earlier detached threads */
+  osDelay(10U);
+
+  ASSERT_TRUE (osThreadPoolGetInfo (0U, &before) == osOK);
+  ASSERT_TRUE (osThreadPoolGetInfo (0U, NULL) == osErrorParameter);
+  ASSERT_TRUE (osThreadPoolGetInfo (UINT32_MAX, &before) == osErrorParameter);
+
+  if (before.available > 0U) {
+    /* - Create a joinable thread with the default stack size and check it takes a pooled slot */
+    id = osThreadNew (Th_PoolStack, NULL, &attr);
+    ASSERT_TRUE (id != NULL);
+    ASSERT_TRUE (osThreadPoolGetInfo (0U, &during) == osOK);
+    ASSERT_TRUE (during.available == before.available - 1U);
+    ASSERT_TRUE (osThreadGetStackSize (id) == before.stack_size);
+
+    /* - Join the thread and check the slot is returned */
+    ASSERT_TRUE (osThreadJoin (id) == osOK);
+    ASSERT_TRUE (osThreadPoolGetInfo (0U, &after) == osOK);
+    ASSERT_TRUE (after.available == before.available);
+
+    /* - Reuse the slot and check the stack space is still fully accounted for */
+    attr.priority = osPriorityLow;
+    id = osThreadNew (Th_PoolStack, NULL, &attr);
+    ASSERT_TRUE (id != NULL);
+    if (id != NULL) {
+      ASSERT_TRUE (osThreadGetStackSpace (id) > 256U);
+      ASSERT_TRUE (osThreadJoin (id) == osOK);
+    }
+  }
+
+  /* - Create an executor and run work items on it */
+  Var_PoolWork = 0U;
+  executor = osExecutorNew (2U, 8U, NULL);
+  ASSERT_TRUE (executor != NULL);
+
+  if (executor != NULL) {
+    for (i = 1U; i <= 16U; i++) {
+      ASSERT_TRUE (osExecutorSubmit (executor, Wk_PoolWork, (void *)i, osWaitForever) == osOK);
+    }
+    ASSERT_TRUE (osExecutorSubmit (executor, NULL, NULL, 0U) == osErrorParameter);
+    ASSERT_TRUE (osExecutorWait (executor, osWaitForever) == osOK);
+    ASSERT_TRUE (Var_PoolWork == (16U * 17U) / 2U);
+
+    /* - Delete the executor */
+    ASSERT_TRUE (osExecutorDelete (executor) == osOK);
+  }
+#endif
+}
+
 /**
 @}
 */
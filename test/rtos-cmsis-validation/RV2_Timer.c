@@ -30,12 +30,15 @@ void TimCb_Periodic       (void *arg);
 void TimCb_Running        (void *arg);
 void TimCb_Dummy          (void *arg);
 void TimCb_osTimerStart_2 (void *arg);
+void TimCb_Swi            (void *arg);
 
 static volatile osStatus_t Cb_osStatus;
 
 static volatile uint32_t Tim_Var;
 static volatile uint32_t Tim_Var_Os;
 static volatile uint32_t Tim_Var_Per;
+static volatile uint32_t Tim_Var_Swi;
+static volatile uint32_t Tim_Var_Ipsr;
 
 void Irq_osTimerNew_1       (void);
 void Irq_osTimerGetName_1   (void);
@@ -814,6 +817,66 @@ void TC_TimerAllocation (void) {
 #endif
 }
 
+/*-----------------------------------------------------------------------------
+ *      Software interrupt timer
+ *----------------------------------------------------------------------------*/
+void TimCb_Swi (void *arg) {
+  Tim_Var_Ipsr = __get_IPSR();
+  Tim_Var_Swi += 1U;
+}
+
+/*=======0=========1=========2=========3=========4=========5=========6=========7=========8=========9=========0=========1====*/
+/**
+\brief Test case: TC_TimerSwi
+\details
+- Create a periodic timer with the osTimerSwi attribute
+- Start timer and check the callback runs more than once from interrupt context
+- Stop the timer
+- Check the jitter statistics account for every callback
+- Delete the timer
+*/
+void TC_TimerSwi (void) {
+#if (TC_TIMERSWI_EN)
+  osTimerAttr_t attr = { .name = "swi", .attr_bits = osTimerSwi };
+  osTimerStats_t stats;
+  osTimerId_t id;
+  uint32_t i;
+
+  Tim_Var_Swi  = 0U;
+  Tim_Var_Ipsr = 0U;
+
+  /* - Create a periodic timer with the osTimerSwi attribute */
+  id = osTimerNew ((osTimerFunc_t)&TimCb_Swi, osTimerPeriodic, NULL, &attr);
+  ASSERT_TRUE (id != NULL);
+
+  if (id) {
+    /* - Start timer and check the callback runs more than once from interrupt context */
+    ASSERT_TRUE (osTimerStart (id, 5) == osOK);
+    for (i = 40; i; i--) {
+      if (Tim_Var_Swi > 2) {
+        break;
+      }
+      osDelay(1);
+    }
+    ASSERT_TRUE (i != 0);
+    ASSERT_TRUE (Tim_Var_Ipsr != 0U);
+
+    /* - Stop the timer */
+    ASSERT_TRUE (osTimerStop (id) == osOK);
+    osDelay(10);
+
+    /* - Check the jitter statistics account for every callback */
+    ASSERT_TRUE (osTimerGetStats (id, &stats) == osOK);
+    ASSERT_TRUE (stats.expirations == Tim_Var_Swi + stats.overruns);
+    ASSERT_TRUE (stats.latency_max >= stats.latency_min);
+    ASSERT_TRUE (osTimerGetStats (id, NULL) == osErrorParameter);
+
+    /* - Delete the timer */
+    ASSERT_TRUE (osTimerDelete (id) == osOK);
+  }
+#endif
+}
+
 /**
 @}
 */ 
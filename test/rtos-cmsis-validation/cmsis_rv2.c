@@ -125,6 +125,7 @@ static const TEST_CASE TC_List[] = {
   TCD ( TC_ThreadSuspendResume,           TC_THREADSUSPENDRESUME_EN           ),
   TCD ( TC_ThreadReturn,                  TC_THREADRETURN_EN                  ),
   TCD ( TC_ThreadAllocation,              TC_THREADALLOCATION_EN              ),
+  TCD ( TC_ThreadPool,                    TC_THREADPOOL_EN                    ),
 #endif
 #if (TC_OSTHREADFLAGS_EN)
   TCD ( TC_ThreadFlagsMainThread,         TC_THREADFLAGSMAINTHREAD_EN         ),
@@ -139,6 +140,7 @@ static const TEST_CASE TC_List[] = {
 #if (TC_OSDELAY_EN)
   TCD ( TC_GenWaitBasic,                  TC_GENWAITBASIC_EN                  ),
   TCD ( TC_GenWaitInterrupts,             TC_GENWAITINTERRUPTS_EN             ),
+  TCD ( TC_GenWaitMultiple,               TC_GENWAITMULTIPLE_EN               ),
 #endif
 #if (TC_OSTIMER_EN)
   TCD ( TC_osTimerNew_1,                  TC_OSTIMERNEW_1_EN                  ),
@@ -154,6 +156,7 @@ static const TEST_CASE TC_List[] = {
   TCD ( TC_TimerAllocation,               TC_TIMERALLOCATION_EN               ),
   TCD ( TC_TimerOneShot,                  TC_TIMERONESHOT_EN                  ),
   TCD ( TC_TimerPeriodic,                 TC_TIMERPERIODIC_EN                 ),
+  TCD ( TC_TimerSwi,                      TC_TIMERSWI_EN                      ),
 #endif
 #if (TC_OSEVENTFLAGS_EN)
   TCD ( TC_osEventFlagsNew_1,             TC_OSEVENTFLAGSNEW_1_EN             ),
@@ -191,6 +194,8 @@ static const TEST_CASE TC_List[] = {
   TCD ( TC_MutexNestedAcquire,            TC_MUTEXNESTEDACQUIRE_EN            ),
   TCD ( TC_MutexPriorityInversion,        TC_MUTEXPRIORITYINVERSION_EN        ),
   TCD ( TC_MutexOwnership,                TC_MUTEXOWNERSHIP_EN                ),
+  TCD ( TC_MutexPrioCeiling,              TC_MUTEXPRIOCEILING_EN              ),
+  TCD ( TC_MutexPrioCeilingNested,        TC_MUTEXPRIOCEILING_EN              ),
 #endif
 #if (TC_OSSEMAPHORE_EN)
   TCD ( TC_osSemaphoreNew_1,              TC_OSSEMAPHORENEW_1_EN              ),
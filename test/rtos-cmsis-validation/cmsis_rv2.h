@@ -95,6 +95,7 @@ extern void TC_osThreadGetStackSpace_1    (void);
 extern void TC_osThreadGetCount_1         (void);
 extern void TC_osThreadEnumerate_1        (void);
 extern void TC_ThreadAllocation           (void);
+extern void TC_ThreadPool                 (void);
 extern void TC_ThreadNew                  (void);
 extern void TC_ThreadMultiInstance        (void);
 extern void TC_ThreadTerminate            (void);
@@ -116,6 +117,7 @@ extern void TC_ThreadFlagsInterrupts      (void);
 
 extern void TC_GenWaitBasic               (void);
 extern void TC_GenWaitInterrupts          (void);
+extern void TC_GenWaitMultiple            (void);
 
 extern void TC_osTimerNew_1               (void);
 extern void TC_osTimerNew_2               (void);
@@ -130,6 +132,7 @@ extern void TC_osTimerDelete_1            (void);
 extern void TC_TimerAllocation            (void);
 extern void TC_TimerOneShot               (void);
 extern void TC_TimerPeriodic              (void);
+extern void TC_TimerSwi                   (void);
 
 extern void TC_osEventFlagsNew_1          (void);
 extern void TC_osEventFlagsNew_2          (void);
@@ -165,6 +168,8 @@ extern void TC_MutexPrioInherit           (void);
 extern void TC_MutexNestedAcquire         (void);
 extern void TC_MutexPriorityInversion     (void);
 extern void TC_MutexOwnership             (void);
+extern void TC_MutexPrioCeiling           (void);
+extern void TC_MutexPrioCeilingNested     (void);
 
 extern void TC_osSemaphoreNew_1           (void);
 extern void TC_osSemaphoreNew_2           (void);
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * rtos-edf-demo.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ *
+ * Runs a schedulable periodic task set (U = 0.75) under the earliest deadline first
+ * class next to a background hog and reports deadline misses and budget overruns every
+ * second. After DEMO_OVERLOAD_SECONDS an extra task, which overruns its budget, is
+ * added and only it should accumulate misses and overruns.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sys/tls.h>
+#include <sys/timestamp.h>
+#include <cmsis/cmsis.h>
+
+#include <rtos/rtos-toolkit/scheduler.h>
+
+#define NUM_PERIODIC 4
+#define DEMO_OVERLOAD_SECONDS 10
+
+struct periodic
+{
+	struct task *id;
+	unsigned long period;
+	unsigned long budget;
+	unsigned long cost;
+	unsigned long jobs;
+};
+
+int picolibc_putc(char c, FILE *file);
+int picolibc_getc(FILE *file);
+
+/* The last one asks for more than its budget */
+struct periodic periodics[NUM_PERIODIC] =
+{
+	{ .period = 10, .budget = 3, .cost = 3 },
+	{ .period = 20, .budget = 5, .cost = 5 },
+	{ .period = 50, .budget = 10, .cost = 10 },
+	{ .period = 25, .budget = 2, .cost = 6 },
+};
+unsigned long hog_loops = 0;
+unsigned long reported_overruns = 0;
+unsigned long reported_misses = 0;
+
+void scheduler_edf_overrun_hook(struct task *task, bool missed)
+{
+	if (missed)
+		++reported_misses;
+	else
+		++reported_overruns;
+}
+
+static void burn(unsigned long ticks)
+{
+	struct task_stats stats;
+
+	/* Consume cpu time rather than wall time, we may be preempted */
+	scheduler_get_task_stats(scheduler_task(), &stats);
+	unsigned long long target = stats.run_time + (unsigned long long)ticks * timestamp_frequency() / SCHEDULER_TICK_FREQ;
+	do {
+		scheduler_get_task_stats(scheduler_task(), &stats);
+	} while (stats.run_time < target);
+}
+
+static void periodic_task(void *context)
+{
+	struct periodic *periodic = context;
+
+	while (true) {
+		burn(periodic->cost);
+		++periodic->jobs;
+		int status = scheduler_edf_wait();
+		if (status < 0) {
+			printf("failed to wait for the next job: %d\n", status);
+			abort();
+		}
+	}
+}
+
+static void hog_task(void *context)
+{
+	while (true)
+		++hog_loops;
+}
+
+static struct task *create_periodic(struct periodic *periodic)
+{
+	struct task_descriptor desc = { .entry_point = periodic_task, .context = periodic, .priority = SCHEDULER_MIN_TASK_PRIORITY / 2, .period = periodic->period, .budget = periodic->budget, .flags = SCHEDULER_CORE_AFFINITY, .affinity = 0 };
+	return scheduler_create(sbrk(1024), 1024, &desc);
+}
+
+static void dump_task(void *context)
+{
+	int counter = 0;
+
+	while (true) {
+
+		/* Add the overloading task */
+		if (counter == DEMO_OVERLOAD_SECONDS) {
+			printf("adding the overrunning task\n");
+			periodics[NUM_PERIODIC - 1].id = create_periodic(&periodics[NUM_PERIODIC - 1]);
+			if (!periodics[NUM_PERIODIC - 1].id) {
+				printf("failed to start the overrunning task\n");
+				abort();
+			}
+		}
+
+		/* Dump the periodic task state */
+		printf("--- %d hog = %lu hook = [%lu, %lu]\n", counter++, hog_loops, reported_misses, reported_overruns);
+		for (int i = 0; i < NUM_PERIODIC; ++i)
+			if (periodics[i].id)
+				printf("\tperiodic[%d] C=%lu T=%lu jobs = %lu misses = %lu overruns = %lu\n", i, periodics[i].cost, periodics[i].period, periodics[i].jobs, periodics[i].id->edf.misses, periodics[i].id->edf.overruns);
+		scheduler_sleep(SCHEDULER_TICK_FREQ);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	struct scheduler scheduler;
+
+	int status = scheduler_init(&scheduler, _tls_size());
+	if (status < 0) {
+		printf("failed to initialize the scheduler\n");
+		abort();
+	}
+
+	struct task_descriptor dump_task_desc = { .entry_point = dump_task, .context = 0, .priority = SCHEDULER_MAX_TASK_PRIORITY + 1, .flags = SCHEDULER_CORE_AFFINITY, .affinity = 1 };
+	if (!scheduler_create(sbrk(1024), 1024, &dump_task_desc)) {
+		printf("failed to start dump_task\n");
+		abort();
+	}
+
+	struct task_descriptor hog_task_desc = { .entry_point = hog_task, .context = 0, .priority = SCHEDULER_MIN_TASK_PRIORITY / 2, .flags = SCHEDULER_CORE_AFFINITY, .affinity = 0 };
+	if (!scheduler_create(sbrk(1024), 1024, &hog_task_desc)) {
+		printf("failed to start hog_task\n");
+		abort();
+	}
+
+	/* Utilization 3/10 + 5/20 + 10/50 = 0.75 on core 0 */
+	for (int i = 0; i < NUM_PERIODIC - 1; ++i) {
+		periodics[i].id = create_periodic(&periodics[i]);
+		if (!periodics[i].id) {
+			printf("failed to start periodic %d\n", i);
+			abort();
+		}
+	}
+
+	/* Run the scheduler */
+	scheduler_run();
+
+	/* We will never reach here */
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,57 @@
+#
+# Copyright (C) 2017 Red Rocket Computing, LLC
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+#
+# template-project.mk
+#
+# Created on: Mar 16, 2017
+#     Author: Stephen Street (stephen@redrocketcomputing.com)
+#
+
+ifeq ($(findstring ${BUILD_ROOT},${CURDIR}),)
+include ${PROJECT_ROOT}/tools/makefiles/target.mk
+else
+
+EXTRA_DEPS := ${SOURCE_DIR}/rtos-edf-demo.mk ${PROJECT_ROOT}/ldscripts/sections.ld ${PROJECT_ROOT}/ldscripts/memory.ld ${PROJECT_ROOT}/ldscripts/regions-sram.ld ${PROJECT_ROOT}/ldscripts/regions-flash.ld
+EXTRA_CLEAN := ${INSTALL_ROOT}/rtos-edf-demo.bin ${INSTALL_ROOT}/rtos-edf-demo.elf ${INSTALL_ROOT}/rtos-edf-demo.uf2
+
+TARGET_OBJ_LIBS := bootstrap
+TARGET_OBJ_LIBS += board board/${BOARD_TYPE}
+TARGET_OBJ_LIBS += diag diag/board
+TARGET_OBJ_LIBS += sys
+TARGET_OBJ_LIBS += cmsis/device/${CHIP_TYPE}
+TARGET_OBJ_LIBS += init
+TARGET_OBJ_LIBS += hardware hardware/${CHIP_TYPE}
+TARGET_OBJ_LIBS += rtos/rtos-toolkit rtos/rtos-toolkit/multicore
+EXTRA_OBJS := ${CURDIR}/scheduler-edf.o
+
+include ${PROJECT_ROOT}/tools/makefiles/project.mk
+
+# EDF and the runtime statistics the jobs burn against are off by default, link a private scheduler built with them in place of the shared one
+SCHEDULER_FLAGS := -DSCHEDULER_EDF=1 -DSCHEDULER_RUNTIME_STATS=1
+TARGET_OBJ := $(filter-out ${BUILD_ROOT}/rtos/rtos-toolkit/scheduler.o,${TARGET_OBJ})
+
+LDSCRIPTS := -L${PROJECT_ROOT}/ldscripts -T memory.ld -T regions-flash.ld -T sections.ld
+
+all: ${INSTALL_ROOT}/rtos-edf-demo.elf ${INSTALL_ROOT}/rtos-edf-demo.bin ${INSTALL_ROOT}/rtos-edf-demo.uf2
+
+${CURDIR}/scheduler-edf.o: ${PROJECT_ROOT}/rtos/rtos-toolkit/scheduler.c ${SOURCE_DIR}/rtos-edf-demo.mk
+	@echo "COMPILING $<"
+	$(CC) ${CPPFLAGS} ${SCHEDULER_FLAGS} ${CFLAGS} -Wa,-adhlns="$@.lst" -MMD -MP -c -o $@ $<
+
+${INSTALL_ROOT}/rtos-edf-demo.uf2: ${CURDIR}/rtos-edf-demo.uf2
+	@echo "INSTALLING ${@}"
+	$(INSTALL) -m 660 -D ${<} ${@}
+
+${INSTALL_ROOT}/rtos-edf-demo.elf: ${CURDIR}/rtos-edf-demo.elf
+	@echo "INSTALLING ${@}"
+	$(INSTALL) -m 660 -D ${<} ${@}
+
+${INSTALL_ROOT}/rtos-edf-demo.bin: ${CURDIR}/rtos-edf-demo.bin
+	@echo "INSTALLING ${@}"
+	$(INSTALL) -m 660 -D ${<} ${@}
+
+endif
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * rtos-smp-benchmark.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <smp-benchmark.h>
+
+extern void smp_bench_run_queue(void);
+extern void smp_bench_fairness(void);
+extern void smp_bench_mutex(void);
+extern void smp_bench_malloc(void);
+extern void smp_bench_spinlock(void);
+
+volatile bool smp_bench_running = false;
+
+static struct smp_bench_worker workers[SMP_BENCH_MAX_WORKERS];
+static smp_bench_func_t worker_func = 0;
+
+static void smp_bench_worker_task(void *context)
+{
+	struct smp_bench_worker *worker = context;
+
+	/* Wait for the starting gun */
+	while (!smp_bench_running)
+		osThreadYield();
+
+	/* Forward */
+	worker_func(worker);
+}
+
+void smp_bench_report_lock_stats(void)
+{
+	struct scheduler_lock_stats stats;
+
+	/* Report the kernel lock stats for each core */
+	for (unsigned long core = 0; core < SystemNumCores; ++core) {
+		scheduler_get_lock_stats(core, &stats);
+		printf("\tcore %lu kernel lock: acquired %lu contended %lu wait cycles %llu (max %lu) hold cycles %llu (max %lu) kicks %lu\n", core, stats.acquired, stats.contended, stats.wait_cycles, stats.max_wait_cycles, stats.hold_cycles, stats.max_hold_cycles, stats.kicks);
+	}
+
+	/* Let the user know how to get more data */
+	if (SCHEDULER_LOCK_STATS == 0)
+		printf("\tbuild with SCHEDULER_LOCK_STATS=1 for kernel lock contention data\n");
+}
+
+struct smp_bench_worker *smp_bench_get_worker(unsigned int index)
+{
+	assert(index < SMP_BENCH_MAX_WORKERS);
+
+	return &workers[index];
+}
+
+void smp_bench_run(const char *title, smp_bench_func_t func, void *context, unsigned int num_workers, osPriority_t priority, uint32_t attr_bits)
+{
+	assert(func != 0 && num_workers <= SMP_BENCH_MAX_WORKERS);
+
+	/* Setup the workers */
+	smp_bench_running = false;
+	worker_func = func;
+	memset(workers, 0, sizeof(workers));
+	for (unsigned int i = 0; i < num_workers; ++i) {
+		workers[i].index = i;
+		workers[i].context = context;
+		osThreadAttr_t attr = { .name = title, .attr_bits = osThreadJoinable | attr_bits, .stack_size = SMP_BENCH_STACK_SIZE, .priority = priority };
+		workers[i].id = osThreadNew(smp_bench_worker_task, &workers[i], &attr);
+		if (!workers[i].id) {
+			fprintf(stderr, "failed to create worker %u: %d\n", i, errno);
+			abort();
+		}
+	}
+
+	/* Run the workers for the benchmark duration */
+	scheduler_reset_lock_stats();
+	uint32_t start = osKernelGetTickCount();
+	smp_bench_running = true;
+	osDelay(SMP_BENCH_DURATION);
+	smp_bench_running = false;
+	uint32_t elapsed = osKernelGetTickCount() - start;
+
+	/* Wait for everyone to finish */
+	for (unsigned int i = 0; i < num_workers; ++i)
+		osThreadJoin(workers[i].id);
+
+	/* Report */
+	unsigned long total = 0;
+	printf("** %s (%u workers, %lu msec) **\n", title, num_workers, (unsigned long)elapsed);
+	for (unsigned int i = 0; i < num_workers; ++i)
+		total += workers[i].operations;
+	for (unsigned int i = 0; i < num_workers; ++i) {
+		unsigned long share = total > 0 ? (unsigned long)((workers[i].operations * 1000ULL) / total) : 0;
+		printf("\tworker %u: %lu ops (%lu.%lu%%) [%lu, %lu]\n", i, workers[i].operations, share / 10, share % 10, workers[i].cores[0], workers[i].cores[1]);
+	}
+	printf("\ttotal: %lu ops, %lu ops/sec\n", total, elapsed > 0 ? (unsigned long)((total * 1000ULL) / elapsed) : 0);
+	smp_bench_report_lock_stats();
+}
+
+static void smp_bench_all(void *context)
+{
+	printf("\n *** Starting! ***\n\n");
+
+	smp_bench_run_queue();
+	smp_bench_fairness();
+	smp_bench_mutex();
+	smp_bench_malloc();
+	smp_bench_spinlock();
+
+	printf("\n *** Done! ***\n");
+}
+
+int main(int argc, char **argv)
+{
+	/* First initialize the kernel so we can add the first task */
+	osStatus_t os_status = osKernelInitialize();
+	if (os_status != osOK) {
+		fprintf(stderr, "failed to initialize the kernel: %d\n", os_status);
+		return EXIT_FAILURE;
+	}
+
+	/* The benchmark driver runs above the workers */
+	osThreadAttr_t attr = { .name = "smp-bench-all", .attr_bits = osThreadDetached, .stack_size = 2048, .priority = osPriorityHigh };
+	if (!osThreadNew(smp_bench_all, 0, &attr)) {
+		fprintf(stderr, "failed to create the benchmark task: %d\n", errno);
+		return EXIT_FAILURE;
+	}
+
+	/* Start the kernel */
+	os_status = osKernelStart();
+	if (os_status != osOK) {
+		fprintf(stderr, "kernel failed to start or there was a fatal error: %d\n", os_status);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * smp-bench-fairness.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ */
+
+#include <smp-benchmark.h>
+
+#define NUM_HOGS 8
+
+void smp_bench_fairness(void);
+
+static void hog_worker(struct smp_bench_worker *worker)
+{
+	/* Never block or yield, only time slicing lets the other hogs run */
+	while (smp_bench_running) {
+		++worker->operations;
+		++worker->cores[SystemCurrentCore];
+	}
+}
+
+void smp_bench_fairness(void)
+{
+	/* Equal priority hogs using the default quantum, each should get an equal share */
+	smp_bench_run("fairness default quantum", hog_worker, 0, NUM_HOGS, osPriorityNormal, 0);
+
+	/* Same again with the shortest quantum */
+	smp_bench_run("fairness 1 tick quantum", hog_worker, 0, NUM_HOGS, osPriorityNormal, osThreadQuantum(1));
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * smp-bench-malloc.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <sys/heap.h>
+
+#include <smp-benchmark.h>
+
+#define LIVE_BLOCKS 16
+#define EXCHANGE_SLOTS 8
+#define NUM_SIZES 5
+
+void smp_bench_malloc(void);
+
+static const size_t sizes[NUM_SIZES] = { 16, 48, 120, 256, 600 };
+static atomic_uintptr_t exchange[EXCHANGE_SLOTS];
+
+static void *checked_malloc(unsigned long operation)
+{
+	void *ptr = malloc(sizes[operation % NUM_SIZES]);
+	if (!ptr) {
+		fprintf(stderr, "malloc failed\n");
+		abort();
+	}
+	return ptr;
+}
+
+static void local_worker(struct smp_bench_worker *worker)
+{
+	void *live[LIVE_BLOCKS] = { 0 };
+
+	/* Blocks are allocated and released on the same core, the common case */
+	while (smp_bench_running) {
+		unsigned int slot = worker->operations % LIVE_BLOCKS;
+		free(live[slot]);
+		live[slot] = checked_malloc(worker->operations);
+
+		++worker->operations;
+		++worker->cores[SystemCurrentCore];
+	}
+
+	for (unsigned int i = 0; i < LIVE_BLOCKS; ++i)
+		free(live[i]);
+}
+
+static void remote_worker(struct smp_bench_worker *worker)
+{
+	/* Swap our new block for whatever the other side left, which is usually released on the other core */
+	while (smp_bench_running) {
+		void *ptr = checked_malloc(worker->operations);
+		uintptr_t old = atomic_exchange(&exchange[(worker->operations + worker->index) % EXCHANGE_SLOTS], (uintptr_t)ptr);
+		free((void *)old);
+
+		++worker->operations;
+		++worker->cores[SystemCurrentCore];
+	}
+}
+
+static void smp_bench_report_heap(void)
+{
+	static const char *const names[HEAP_ARENA_COUNT] = { "core0", "core1", "shared" };
+	struct tlsf_stats stats;
+
+	/* Show which arenas carried the load */
+	for (unsigned int i = 0; i < HEAP_ARENA_COUNT; ++i)
+		if (heap_get_arena_stats(i, &stats) == 0)
+			printf("\t%s arena: peak used %lu, used %lu, fragmentation %u%%\n", names[i], (unsigned long)stats.peak_used, (unsigned long)stats.used, stats.fragmentation);
+}
+
+void smp_bench_malloc(void)
+{
+	/* One worker per core, with both cores allocating all the time any shared lock convoys */
+	smp_bench_run("malloc local", local_worker, 0, 2, osPriorityNormal, 0);
+	smp_bench_report_heap();
+
+	/* Every free is likely a remote free */
+	smp_bench_run("malloc remote", remote_worker, 0, 2, osPriorityNormal, 0);
+	for (unsigned int i = 0; i < EXCHANGE_SLOTS; ++i)
+		free((void *)atomic_exchange(&exchange[i], 0));
+	smp_bench_report_heap();
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * smp-bench-mutex.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <smp-benchmark.h>
+
+#define CRITICAL_SECTION_LOOPS 50
+#define OUTSIDE_LOOPS 20
+
+void smp_bench_mutex(void);
+
+static volatile unsigned long shared_counter = 0;
+static atomic_ulong worker_futex_waits = 0;
+
+static void contention_worker(struct smp_bench_worker *worker)
+{
+	osMutexId_t mutex = worker->context;
+
+	/* Short critical sections, the kind that are usually held by a thread on the other core */
+	while (smp_bench_running) {
+
+		if (osMutexAcquire(mutex, osWaitForever) != osOK) {
+			fprintf(stderr, "failed to acquire the mutex\n");
+			abort();
+		}
+		for (volatile int i = 0; i < CRITICAL_SECTION_LOOPS; ++i)
+			++shared_counter;
+		osMutexRelease(mutex);
+
+		++worker->operations;
+		++worker->cores[SystemCurrentCore];
+
+		for (volatile int i = 0; i < OUTSIDE_LOOPS; ++i);
+	}
+
+	/* Count how often we really blocked */
+	osThreadStats_t stats;
+	if (osThreadGetStats(osThreadGetId(), &stats) == osOK)
+		atomic_fetch_add(&worker_futex_waits, stats.futex_waits);
+}
+
+static void smp_bench_mutex_contention(const char *title, uint32_t attr_bits, unsigned int num_workers)
+{
+	osMutexAttr_t attr = { .name = title, .attr_bits = attr_bits };
+	osMutexId_t mutex = osMutexNew(&attr);
+	if (!mutex) {
+		fprintf(stderr, "failed to create the %s mutex\n", title);
+		abort();
+	}
+
+	/* The futex waits show how often the workers really blocked */
+	worker_futex_waits = 0;
+	smp_bench_run(title, contention_worker, mutex, num_workers, osPriorityNormal, 0);
+	printf("\tworker futex waits: %lu\n", (unsigned long)worker_futex_waits);
+
+	osMutexDelete(mutex);
+}
+
+void smp_bench_mutex(void)
+{
+	/* Blocking versus adaptive with one worker per core and then oversubscribed */
+	smp_bench_mutex_contention("mutex blocking", 0, 2);
+	smp_bench_mutex_contention("mutex adaptive", osMutexAdaptive, 2);
+	smp_bench_mutex_contention("mutex blocking", 0, 4);
+	smp_bench_mutex_contention("mutex adaptive", osMutexAdaptive, 4);
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * smp-bench-run-queue.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <smp-benchmark.h>
+
+#define NUM_YIELDERS 8
+#define NUM_PAIRS 4
+
+void smp_bench_run_queue(void);
+
+static osSemaphoreId_t pings[NUM_PAIRS];
+static osSemaphoreId_t pongs[NUM_PAIRS];
+
+static void yield_worker(struct smp_bench_worker *worker)
+{
+	/* Every yield is a trip through the ready queues */
+	while (smp_bench_running) {
+		++worker->operations;
+		++worker->cores[SystemCurrentCore];
+		osThreadYield();
+	}
+}
+
+static void ping_pong_worker(struct smp_bench_worker *worker)
+{
+	unsigned int pair = worker->index >> 1;
+	osSemaphoreId_t give = worker->index & 1 ? pongs[pair] : pings[pair];
+	osSemaphoreId_t take = worker->index & 1 ? pings[pair] : pongs[pair];
+
+	/* The ping side starts the volley */
+	if ((worker->index & 1) == 0)
+		osSemaphoreRelease(give);
+
+	/* Every exchange blocks one side and wakes the other, often on the other core */
+	while (smp_bench_running) {
+		if (osSemaphoreAcquire(take, 10) == osOK) {
+			++worker->operations;
+			++worker->cores[SystemCurrentCore];
+			osSemaphoreRelease(give);
+		}
+	}
+
+	/* Unblock our partner */
+	osSemaphoreRelease(give);
+}
+
+void smp_bench_run_queue(void)
+{
+	/* Pure run queue traffic */
+	smp_bench_run("run queue yield", yield_worker, 0, NUM_YIELDERS, osPriorityNormal, 0);
+
+	/* Cross core wake ups */
+	for (int i = 0; i < NUM_PAIRS; ++i) {
+		pings[i] = osSemaphoreNew(1, 0, 0);
+		pongs[i] = osSemaphoreNew(1, 0, 0);
+		if (!pings[i] || !pongs[i]) {
+			fprintf(stderr, "failed to create ping pong semaphores\n");
+			abort();
+		}
+	}
+	smp_bench_run("run queue ping pong", ping_pong_worker, 0, NUM_PAIRS * 2, osPriorityNormal, 0);
+	for (int i = 0; i < NUM_PAIRS; ++i) {
+		osSemaphoreDelete(pings[i]);
+		osSemaphoreDelete(pongs[i]);
+	}
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * smp-bench-spinlock.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/spinlock.h>
+
+#include <smp-benchmark.h>
+
+#define HOLD_LOOPS 10
+#define OUTSIDE_LOOPS 10
+
+enum spinlock_variant
+{
+	SPINLOCK_TICKET,
+	SPINLOCK_HW,
+	SPINLOCK_MCS,
+};
+
+void smp_bench_spinlock(void);
+
+static spinlock_t ticket_lock = 0;
+static hw_spinlock_t hw_lock;
+static mcs_lock_t queued_lock = 0;
+
+static volatile unsigned long protected_counter = 0;
+static unsigned long long acquire_cycles[SMP_BENCH_MAX_WORKERS];
+static unsigned long max_acquire_cycles[SMP_BENCH_MAX_WORKERS];
+
+static unsigned long systick_cycles(uint32_t start, uint32_t end)
+{
+	/* The SysTick counts core clocks down */
+	return start >= end ? start - end : start + SysTick->LOAD + 1 - end;
+}
+
+static void spinlock_worker(struct smp_bench_worker *worker)
+{
+	enum spinlock_variant variant = (uintptr_t)worker->context;
+	struct mcs_node node;
+
+	while (smp_bench_running) {
+
+		/* Keep the interrupts out of both the measurement and the hold */
+		unsigned int state = disable_interrupts();
+		uint32_t start = SysTick->VAL;
+		switch (variant) {
+			case SPINLOCK_TICKET:
+				spin_lock(&ticket_lock);
+				break;
+			case SPINLOCK_HW:
+				hw_spin_lock(&hw_lock);
+				break;
+			case SPINLOCK_MCS:
+				mcs_lock(&queued_lock, &node);
+				break;
+		}
+		uint32_t end = SysTick->VAL;
+
+		for (volatile int i = 0; i < HOLD_LOOPS; ++i)
+			++protected_counter;
+
+		switch (variant) {
+			case SPINLOCK_TICKET:
+				spin_unlock(&ticket_lock);
+				break;
+			case SPINLOCK_HW:
+				hw_spin_unlock(&hw_lock);
+				break;
+			case SPINLOCK_MCS:
+				mcs_unlock(&queued_lock, &node);
+				break;
+		}
+		enable_interrupts(state);
+
+		/* Account for the acquire */
+		unsigned long cycles = systick_cycles(start, end);
+		acquire_cycles[worker->index] += cycles;
+		if (cycles > max_acquire_cycles[worker->index])
+			max_acquire_cycles[worker->index] = cycles;
+		++worker->operations;
+		++worker->cores[SystemCurrentCore];
+
+		for (volatile int i = 0; i < OUTSIDE_LOOPS; ++i);
+	}
+}
+
+static void smp_bench_spinlock_variant(const char *title, enum spinlock_variant variant)
+{
+	memset(acquire_cycles, 0, sizeof(acquire_cycles));
+	memset(max_acquire_cycles, 0, sizeof(max_acquire_cycles));
+
+	/* One worker per core, both hammering the same lock */
+	smp_bench_run(title, spinlock_worker, (void *)variant, 2, osPriorityNormal, 0);
+
+	for (unsigned int i = 0; i < 2; ++i) {
+		struct smp_bench_worker *worker = smp_bench_get_worker(i);
+		printf("\tworker %u acquire: avg %lu max %lu cycles\n", i, worker->operations > 0 ? (unsigned long)(acquire_cycles[i] / worker->operations) : 0, max_acquire_cycles[i]);
+	}
+}
+
+void smp_bench_spinlock(void)
+{
+	/* Stay clear of the kernel lock in case it is the hardware variant */
+	hw_spin_lock_init(&hw_lock, HW_SPINLOCK_KERNEL + 1);
+
+	smp_bench_spinlock_variant("spinlock ticket", SPINLOCK_TICKET);
+	smp_bench_spinlock_variant("spinlock hardware", SPINLOCK_HW);
+	smp_bench_spinlock_variant("spinlock queued", SPINLOCK_MCS);
+}
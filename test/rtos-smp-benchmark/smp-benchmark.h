@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * smp-benchmark.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ */
+
+#ifndef _SMP_BENCHMARK_H_
+#define _SMP_BENCHMARK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <rtos/rtos.h>
+
+#define SMP_BENCH_DURATION 1000UL
+#define SMP_BENCH_MAX_WORKERS 16
+#define SMP_BENCH_STACK_SIZE 1024UL
+
+struct smp_bench_worker
+{
+	osThreadId_t id;
+	unsigned int index;
+	void *context;
+	unsigned long operations;
+	unsigned long cores[SystemNumCores];
+};
+
+typedef void (*smp_bench_func_t)(struct smp_bench_worker *worker);
+
+extern volatile bool smp_bench_running;
+
+void smp_bench_run(const char *title, smp_bench_func_t func, void *context, unsigned int num_workers, osPriority_t priority, uint32_t attr_bits);
+void smp_bench_report_lock_stats(void);
+struct smp_bench_worker *smp_bench_get_worker(unsigned int index);
+
+#endif
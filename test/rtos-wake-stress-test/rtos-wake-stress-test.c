@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * rtos-wake-stress-test.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ *
+ * Hammers the deferred wake ring from a periodic channel. Every tick the interrupt
+ * bumps and wakes a burst of futexes, waking some of them twice to exercise the
+ * coalescing, while the waiters count what they see. Reports the interrupt and wake
+ * rates with the ring statistics every second and aborts if the ring overflows or an
+ * event is lost.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sys/tls.h>
+#include <sys/swi.h>
+#include <sys/periodic.h>
+#include <cmsis/cmsis.h>
+
+#include <rtos/rtos-toolkit/scheduler.h>
+
+#define NUM_WAITERS 16
+#define WAKE_BURST 6
+#define STRESS_CHANNEL 1
+#define STRESS_SWI 5
+#define STRESS_FREQUENCY 4000
+
+struct waiter
+{
+	struct task *id;
+	struct futex futex;
+	long events;
+	unsigned long seen;
+	unsigned long wakeups;
+};
+
+int picolibc_putc(char c, FILE *file);
+int picolibc_getc(FILE *file);
+
+struct waiter waiters[NUM_WAITERS] = { 0 };
+volatile unsigned long fires = 0;
+volatile unsigned long wakes = 0;
+volatile unsigned long failures = 0;
+
+static void stress_tick(unsigned int swi, void *context)
+{
+	unsigned long fire = fires++;
+
+	/* Wake a burst of waiters, the first one twice so it is coalesced */
+	for (unsigned int i = 0; i < WAKE_BURST; ++i) {
+		struct waiter *waiter = &waiters[(fire * WAKE_BURST + i) % NUM_WAITERS];
+		atomic_fetch_add(&waiter->events, 1);
+		if (scheduler_futex_wake(&waiter->futex, false) < 0)
+			++failures;
+		if (i == 0 && scheduler_futex_wake(&waiter->futex, true) < 0)
+			++failures;
+		++wakes;
+	}
+}
+
+static void waiter_task(void *context)
+{
+	struct waiter *waiter = context;
+
+	while (true) {
+
+		/* Wait for more events */
+		long events = atomic_load(&waiter->events);
+		if ((unsigned long)events == waiter->seen) {
+			int status = scheduler_futex_wait(&waiter->futex, events, SCHEDULER_WAIT_FOREVER);
+			if (status < 0) {
+				printf("failed to wait for futex: %d\n", status);
+				abort();
+			}
+			++waiter->wakeups;
+			continue;
+		}
+
+		/* Consume them */
+		waiter->seen = events;
+	}
+}
+
+static void dump_task(void *context)
+{
+	struct scheduler_wake_stats stats;
+	unsigned long last_fires = 0;
+	unsigned long last_wakes = 0;
+	int counter = 0;
+
+	while (true) {
+		scheduler_sleep(1000);
+
+		/* Sum up what the waiters have seen, they may be behind by the events in flight */
+		unsigned long seen = 0;
+		for (int i = 0; i < NUM_WAITERS; ++i)
+			seen += waiters[i].seen;
+
+		unsigned long current_fires = fires;
+		unsigned long current_wakes = wakes;
+		printf("--- %d irq/s = %lu wakes/s = %lu wakes = %lu seen = %lu failures = %lu\n", counter++, current_fires - last_fires, current_wakes - last_wakes, current_wakes, seen, failures);
+		last_fires = current_fires;
+		last_wakes = current_wakes;
+
+		for (unsigned long core = 0; core < SystemNumCores; ++core) {
+			scheduler_get_wake_stats(core, &stats);
+			printf("\tcore %lu: capacity = %lu high water = %lu deferred = %lu coalesced = %lu overflows = %lu\n", core, stats.capacity, stats.high_water, stats.deferred, stats.coalesced, stats.overflows);
+			if (stats.overflows != 0) {
+				printf("deferred wake ring overflowed\n");
+				abort();
+			}
+		}
+
+		/* Every event must eventually be seen */
+		if (failures != 0 || current_wakes - seen > NUM_WAITERS * WAKE_BURST * (STRESS_FREQUENCY / 10)) {
+			printf("lost deferred wakes\n");
+			abort();
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	struct scheduler scheduler;
+
+	int status = scheduler_init(&scheduler, _tls_size());
+	if (status < 0) {
+		printf("failed to initialize the scheduler\n");
+		abort();
+	}
+
+	for (int i = 0; i < NUM_WAITERS; ++i) {
+		scheduler_futex_init(&waiters[i].futex, &waiters[i].events, 0);
+		struct task_descriptor waiter_task_desc = { .entry_point = waiter_task, .context = &waiters[i], .priority = SCHEDULER_MIN_TASK_PRIORITY / 2 };
+		waiters[i].id = scheduler_create(sbrk(1024), 1024, &waiter_task_desc);
+		if (!waiters[i].id) {
+			printf("failed to start waiter %d\n", i);
+			abort();
+		}
+	}
+
+	struct task_descriptor dump_task_desc = { .entry_point = dump_task, .context = 0, .priority = SCHEDULER_MAX_TASK_PRIORITY };
+	if (!scheduler_create(sbrk(1024), 1024, &dump_task_desc)) {
+		printf("failed to start dump_task\n");
+		abort();
+	}
+
+	/* Start the interrupt storm */
+	swi_register(STRESS_SWI, INTERRUPT_NORMAL, stress_tick, 0);
+	swi_enable(STRESS_SWI);
+	periodic_register(STRESS_CHANNEL, STRESS_SWI, STRESS_FREQUENCY);
+	periodic_enable(STRESS_CHANNEL);
+
+	/* Run the scheduler */
+	scheduler_run();
+
+	/* We will never reach here */
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2026 Stephen Street
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * tlsf-test.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Stephen Street (stephen@redrocketcomputing.com)
+ *
+ * Host randomized stress of the allocator in sys/tlsf.c, every live block carries
+ * a pattern which is verified before it is released and the heap structure is
+ * checked as the test runs. Exits with failure if any case fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <tlsf.h>
+
+#define HEAP_SIZE (128UL * 1024UL)
+#define MAX_LIVE 512
+#define OPERATIONS 200000UL
+#define CHECK_INTERVAL 997UL
+
+struct live_block
+{
+	unsigned char *ptr;
+	size_t size;
+	unsigned char pattern;
+};
+
+static unsigned long long heap_memory[HEAP_SIZE / sizeof(unsigned long long)];
+static struct live_block live[MAX_LIVE];
+static unsigned long random_state;
+
+static unsigned long next_random(void)
+{
+	/* xorshift, reproducible for a given seed */
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 7;
+	random_state ^= random_state << 17;
+	return random_state;
+}
+
+static size_t random_size(void)
+{
+	/* Mostly small objects with the occasional large buffer */
+	unsigned long choice = next_random() % 100;
+	if (choice < 70)
+		return 1 + next_random() % 128;
+	if (choice < 95)
+		return 1 + next_random() % 1024;
+	return 1 + next_random() % 8192;
+}
+
+static void fill(struct live_block *block)
+{
+	for (size_t i = 0; i < block->size; ++i)
+		block->ptr[i] = block->pattern + i;
+}
+
+static bool verify(const struct live_block *block, size_t size)
+{
+	for (size_t i = 0; i < size; ++i)
+		if (block->ptr[i] != (unsigned char)(block->pattern + i))
+			return false;
+	return true;
+}
+
+static int check(const char *name, bool condition)
+{
+	printf("%-50s %s\n", name, condition ? "PASS" : "FAIL");
+	return condition ? 0 : 1;
+}
+
+static bool stress(struct tlsf *tlsf, unsigned long operations)
+{
+	size_t misaligned = 0;
+
+	for (unsigned long op = 0; op < operations; ++op) {
+		struct live_block *block = &live[next_random() % MAX_LIVE];
+		unsigned long action = next_random() % 10;
+
+		if (!block->ptr) {
+
+			/* Allocate, sometimes with a large alignment */
+			size_t size = random_size();
+			size_t alignment = action == 0 ? 16UL << (next_random() % 5) : 0;
+			block->ptr = alignment ? tlsf_memalign(tlsf, alignment, size) : tlsf_malloc(tlsf, size);
+			if (!block->ptr)
+				continue;
+			if (((uintptr_t)block->ptr & ((alignment ? alignment : TLSF_ALIGN) - 1)) != 0)
+				++misaligned;
+			if (tlsf_usable_size(block->ptr) < size)
+				return false;
+			block->size = size;
+			block->pattern = next_random();
+			fill(block);
+
+		} else if (action < 3) {
+
+			/* Resize, the old contents must survive */
+			size_t size = random_size();
+			unsigned char *ptr = tlsf_realloc(tlsf, block->ptr, size);
+			if (!ptr) {
+				if (!verify(block, block->size))
+					return false;
+				continue;
+			}
+			block->ptr = ptr;
+			if (!verify(block, size < block->size ? size : block->size))
+				return false;
+			block->size = size;
+			fill(block);
+
+		} else {
+
+			/* Release */
+			if (!verify(block, block->size))
+				return false;
+			tlsf_free(tlsf, block->ptr);
+			block->ptr = 0;
+		}
+
+		if (op % CHECK_INTERVAL == 0 && tlsf_check(tlsf) != 0)
+			return false;
+	}
+
+	return misaligned == 0 && tlsf_check(tlsf) == 0;
+}
+
+int main(int argc, char **argv)
+{
+	struct tlsf tlsf;
+	struct tlsf_stats stats;
+	int failures = 0;
+
+	random_state = argc > 1 ? strtoul(argv[1], 0, 0) : 0x2545f491UL;
+	if (!random_state)
+		random_state = 1;
+
+	/* A fresh heap is a single free block */
+	failures += check("init", tlsf_init(&tlsf, heap_memory, sizeof(heap_memory)) == 0 && tlsf_check(&tlsf) == 0);
+	tlsf_get_stats(&tlsf, &stats);
+	size_t initial_free = stats.free;
+	failures += check("fresh heap is one block", stats.free_blocks == 1 && stats.largest_free == stats.free && stats.fragmentation == 0);
+
+	/* Back to back allocations are separated by at most the two word header */
+	unsigned char *first = tlsf_malloc(&tlsf, 24);
+	unsigned char *second = tlsf_malloc(&tlsf, 24);
+	failures += check("overhead is two words", second - first == (ptrdiff_t)(tlsf_usable_size(first) + 2 * sizeof(void *)) && tlsf_usable_size(first) == 24);
+	failures += check("zero sized allocation is unique", tlsf_malloc(&tlsf, 0) != 0);
+	failures += check("oversized allocation fails", tlsf_malloc(&tlsf, HEAP_SIZE) == 0);
+
+	/* Freeing the middle of three blocks fragments, freeing the rest coalesces everything, sizes on a list boundary so the hole is a fit */
+	tlsf_init(&tlsf, heap_memory, sizeof(heap_memory));
+	void *a = tlsf_malloc(&tlsf, 1024);
+	void *b = tlsf_malloc(&tlsf, 1024);
+	void *c = tlsf_malloc(&tlsf, 1024);
+	tlsf_free(&tlsf, b);
+	tlsf_get_stats(&tlsf, &stats);
+	failures += check("hole is reported as fragmentation", stats.free_blocks == 2 && stats.fragmentation > 0 && stats.used_blocks == 2);
+	failures += check("hole is reused", tlsf_malloc(&tlsf, 1024) == b);
+	tlsf_free(&tlsf, b);
+	tlsf_free(&tlsf, a);
+	tlsf_free(&tlsf, c);
+	tlsf_get_stats(&tlsf, &stats);
+	failures += check("free coalesces", stats.free_blocks == 1 && stats.free == initial_free && tlsf_check(&tlsf) == 0);
+
+	/* Realloc grows in place into a free neighbour */
+	a = tlsf_malloc(&tlsf, 64);
+	failures += check("realloc grows in place", tlsf_realloc(&tlsf, a, 4096) == a && tlsf_check(&tlsf) == 0);
+	tlsf_free(&tlsf, a);
+
+	/* Randomized churn */
+	failures += check("randomized stress", stress(&tlsf, OPERATIONS));
+
+	tlsf_get_stats(&tlsf, &stats);
+	printf("used %zu free %zu largest %zu peak %zu blocks %zu/%zu fragmentation %u%%\n", stats.used, stats.free, stats.largest_free, stats.peak_used, stats.used_blocks, stats.free_blocks, stats.fragmentation);
+
+	/* Releasing everything must leave a single block again */
+	for (size_t i = 0; i < MAX_LIVE; ++i) {
+		tlsf_free(&tlsf, live[i].ptr);
+		live[i].ptr = 0;
+	}
+	tlsf_get_stats(&tlsf, &stats);
+	failures += check("heap drains to one block", stats.free_blocks == 1 && stats.free == initial_free && stats.used == 0 && tlsf_check(&tlsf) == 0);
+
+	printf("%s\n", failures ? "FAILED" : "PASSED");
+
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,34 @@
+ARCH_CROSS := host
+BOARD_TYPE := host
+BUILD_ROOT := ${OUTPUT_ROOT}$(if ${BOARD_TYPE},/${BOARD_TYPE},)$(if ${BUILD_TYPE},/${BUILD_TYPE},)
+INSTALL_ROOT := ${PROJECT_ROOT}/local/bin
+BUILD_TYPE := debug
+
+ifeq ($(findstring ${BUILD_ROOT},${CURDIR}),)
+
+include ${PROJECT_ROOT}/tools/makefiles/target.mk
+
+else
+
+EXTRA_DEPS := ${SOURCE_DIR}/tlsf-test.mk ${PROJECT_ROOT}/include/tlsf.h
+EXTRA_CLEAN := ${INSTALL_ROOT}/tlsf-test
+EXTRA_OBJS := ${CURDIR}/tlsf.o
+
+include ${PROJECT_ROOT}/tools/makefiles/project.mk
+
+CPPFLAGS += -I${PROJECT_ROOT}/include
+CFLAGS := -pipe -O0 -g3 -fno-move-loop-invariants -feliminate-unused-debug-types -fmessage-length=0 -fsigned-char -ffunction-sections -fdata-sections -Wall -Wunused -Wuninitialized -Wmissing-declarations -Werror -std=gnu11 -funwind-tables
+
+all: ${INSTALL_ROOT}/tlsf-test
+
+${CURDIR}/tlsf.o: ${PROJECT_ROOT}/sys/tlsf.c
+	@echo "COMPILING $<"
+	$(CC) ${CPPFLAGS} ${CFLAGS} -MMD -MP -c -o $@ $<
+
+${INSTALL_ROOT}/tlsf-test: ${CURDIR}/tlsf-test.elf
+	@echo "INSTALLING ${@}"
+	$(INSTALL) -m 770 -D ${<} ${@}
+	@echo "RUNNING ${@}"
+	${@}
+
+endif